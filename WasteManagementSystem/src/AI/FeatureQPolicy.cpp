@@ -0,0 +1,353 @@
+// FeatureQPolicy.cpp
+// Implementation of the feature-based Q-function for routing
+#include "pch.h"
+#include "FeatureQPolicy.h"
+#include "../Core/WasteLocation.h"
+
+// Penalty distance for moves without a direct road, as in the tabular agent
+static const float UnreachableDistance = 1000.0f;
+
+float FeatureRoutingProblem::Distance(size_t from, size_t to) const
+{
+    if (!distanceMatrix.empty()) {
+        return distanceMatrix[from * Size() + to];
+    }
+
+    float dx = x[to] - x[from];
+    float dy = y[to] - y[from];
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+void FeatureQPolicy::CandidateSet::Remove(size_t slot)
+{
+    size_t last = index.size() - 1;
+    index[slot] = index[last];
+    waste[slot] = waste[last];
+    stationDistance[slot] = stationDistance[last];
+    cluster[slot] = cluster[last];
+    if (!x.empty()) {
+        x[slot] = x[last];
+        y[slot] = y[last];
+        x.pop_back();
+        y.pop_back();
+    }
+
+    index.pop_back();
+    waste.pop_back();
+    stationDistance.pop_back();
+    cluster.pop_back();
+}
+
+FeatureQPolicy::FeatureQPolicy(float learningRate, float discountFactor)
+    : m_learningRate(learningRate),
+    m_discountFactor(discountFactor)
+{
+    Reset();
+}
+
+void FeatureQPolicy::Reset()
+{
+    std::lock_guard<std::mutex> lock(m_weightsMutex);
+    std::fill(m_weights, m_weights + NumFeatures, 0.0f);
+}
+
+void FeatureQPolicy::CopyWeights(float* weights) const
+{
+    std::lock_guard<std::mutex> lock(m_weightsMutex);
+    std::copy(m_weights, m_weights + NumFeatures, weights);
+}
+
+std::vector<float> FeatureQPolicy::GetWeights() const
+{
+    std::vector<float> weights(NumFeatures);
+    CopyWeights(weights.data());
+    return weights;
+}
+
+void FeatureQPolicy::SetWeights(const std::vector<float>& weights)
+{
+    std::lock_guard<std::mutex> lock(m_weightsMutex);
+    std::copy(weights.begin(), weights.begin() + std::min<size_t>(weights.size(), NumFeatures), m_weights);
+}
+
+float FeatureQPolicy::CalculateReward(float distance, float wasteLevel, bool toStation)
+{
+    if (distance >= INF) {
+        distance = UnreachableDistance;
+    }
+
+    // Negative reward proportional to distance, plus the collected waste or a return bonus
+    return -distance + (toStation ? 5.0f : wasteLevel / 10.0f);
+}
+
+void FeatureQPolicy::BuildCandidates(const FeatureRoutingProblem& problem, float distanceScale,
+    CandidateSet& candidates) const
+{
+    bool straightLine = problem.distanceMatrix.empty();
+
+    for (size_t i = 1; i < problem.Size(); i++) {
+        if (problem.wasteLevel[i] < problem.collectionThreshold) {
+            continue;
+        }
+
+        float stationDistance = problem.Distance(i, 0);
+        if (stationDistance >= INF) {
+            stationDistance = UnreachableDistance;
+        }
+
+        candidates.index.push_back(static_cast<int>(i));
+        candidates.waste.push_back(problem.wasteLevel[i] / 100.0f);
+        candidates.stationDistance.push_back(stationDistance / distanceScale);
+        candidates.cluster.push_back(problem.clusterId.empty() ? -1 : problem.clusterId[i]);
+        if (straightLine) {
+            candidates.x.push_back(problem.x[i]);
+            candidates.y.push_back(problem.y[i]);
+        }
+    }
+
+    size_t count = candidates.Size();
+    candidates.distance.resize(count);
+    candidates.q.resize(count);
+    candidates.feasible.resize(count);
+}
+
+int FeatureQPolicy::EvaluateCandidates(const FeatureRoutingProblem& problem, const RouteState& state,
+    float distanceScale, const float* weights, CandidateSet& candidates) const
+{
+    const size_t count = candidates.Size();
+    if (count == 0) {
+        return -1;
+    }
+
+    float* distance = candidates.distance.data();
+    float* q = candidates.q.data();
+    unsigned char* feasible = candidates.feasible.data();
+    const float* waste = candidates.waste.data();
+    const float* stationDistance = candidates.stationDistance.data();
+    const int* cluster = candidates.cluster.data();
+
+    // Distances from the current point to every candidate
+    if (problem.distanceMatrix.empty()) {
+        const float* x = candidates.x.data();
+        const float* y = candidates.y.data();
+        float currentX = problem.x[state.current];
+        float currentY = problem.y[state.current];
+        for (size_t k = 0; k < count; k++) {
+            float dx = x[k] - currentX;
+            float dy = y[k] - currentY;
+            distance[k] = std::sqrt(dx * dx + dy * dy);
+        }
+    }
+    else {
+        const float* row = problem.distanceMatrix.data() + state.current * problem.Size();
+        const int* index = candidates.index.data();
+        for (size_t k = 0; k < count; k++) {
+            distance[k] = row[index[k]];
+        }
+    }
+
+    // Features that are the same for every candidate fold into one constant
+    int currentCluster = problem.clusterId.empty() ? -1 : problem.clusterId[state.current];
+    float inverseScale = 1.0f / distanceScale;
+    float inverseCapacity = 1.0f / problem.vehicleCapacity;
+    float remainingFraction = static_cast<float>(count) / static_cast<float>(state.totalStops);
+    float constant = weights[0] + weights[7] * remainingFraction + weights[4] * state.remainingCapacity * inverseCapacity;
+    float capacityWeight = weights[4] * 100.0f * inverseCapacity;
+
+    // Q-value of every candidate; this loop has no branches so it vectorizes
+    for (size_t k = 0; k < count; k++) {
+        bool reachable = distance[k] < INF;
+        bool fits = waste[k] * 100.0f <= state.remainingCapacity;
+        feasible[k] = reachable && fits;
+
+        float scaledDistance = reachable ? distance[k] * inverseScale : 0.0f;
+        float sameCluster = (currentCluster >= 0 && cluster[k] == currentCluster) ? 1.0f : 0.0f;
+        q[k] = constant
+            - weights[1] * scaledDistance
+            + weights[2] * waste[k]
+            + weights[3] * sameCluster
+            - capacityWeight * waste[k]
+            - weights[5] * stationDistance[k]
+            + weights[6] * waste[k] / (1.0f + scaledDistance);
+    }
+
+    // Best feasible candidate
+    int best = -1;
+    for (size_t k = 0; k < count; k++) {
+        if (feasible[k] && (best < 0 || q[k] > q[best])) {
+            best = static_cast<int>(k);
+        }
+    }
+    return best;
+}
+
+void FeatureQPolicy::GetFeatures(const FeatureRoutingProblem& problem, const RouteState& state,
+    const CandidateSet& candidates, size_t slot, float distanceScale, float* features) const
+{
+    // Same features that EvaluateCandidates scores, for a single candidate
+    int currentCluster = problem.clusterId.empty() ? -1 : problem.clusterId[state.current];
+    float scaledDistance = candidates.distance[slot] < INF ? candidates.distance[slot] / distanceScale : 0.0f;
+
+    features[0] = 1.0f;
+    features[1] = -scaledDistance;
+    features[2] = candidates.waste[slot];
+    features[3] = (currentCluster >= 0 && candidates.cluster[slot] == currentCluster) ? 1.0f : 0.0f;
+    features[4] = (state.remainingCapacity - candidates.waste[slot] * 100.0f) / problem.vehicleCapacity;
+    features[5] = -candidates.stationDistance[slot];
+    features[6] = candidates.waste[slot] / (1.0f + scaledDistance);
+    features[7] = static_cast<float>(candidates.Size()) / static_cast<float>(state.totalStops);
+}
+
+void FeatureQPolicy::UpdateWeights(const float* features, float tdError)
+{
+    // Normalizing by the feature norm keeps the step size stable for any reward scale
+    float norm = 1.0f;
+    for (int i = 0; i < NumFeatures; i++) {
+        norm += features[i] * features[i];
+    }
+
+    float step = m_learningRate * tdError / norm;
+
+    std::lock_guard<std::mutex> lock(m_weightsMutex);
+    for (int i = 0; i < NumFeatures; i++) {
+        m_weights[i] += step * features[i];
+    }
+}
+
+std::vector<int> FeatureQPolicy::RunEpisode(const FeatureRoutingProblem& problem, float explorationRate,
+    std::mt19937* rng, float& totalReward, double& squaredErrorSum, size_t& numUpdates)
+{
+    std::vector<int> route = { 0 };
+    totalReward = 0.0f;
+    if (problem.Size() == 0) {
+        return route;
+    }
+
+    // Typical station distance makes the distance features independent of the map size
+    float distanceScale = 0.0f;
+    int numScaled = 0;
+    for (size_t i = 1; i < problem.Size(); i++) {
+        float distance = problem.Distance(0, i);
+        if (distance < INF) {
+            distanceScale += distance;
+            numScaled++;
+        }
+    }
+    distanceScale = (numScaled > 0 && distanceScale > 0.0f) ? distanceScale / numScaled : 1.0f;
+
+    CandidateSet candidates;
+    BuildCandidates(problem, distanceScale, candidates);
+
+    RouteState state;
+    state.remainingCapacity = problem.vehicleCapacity;
+    state.totalStops = std::max<size_t>(1, candidates.Size());
+
+    float weights[NumFeatures];
+    CopyWeights(weights);
+
+    // The update of a move waits for the Q-values of the state it leads to
+    bool learn = rng != nullptr;
+    bool hasPending = false;
+    float pendingFeatures[NumFeatures];
+    float pendingQ = 0.0f;
+    float pendingReward = 0.0f;
+
+    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+
+    while (true) {
+        int best = EvaluateCandidates(problem, state, distanceScale, weights, candidates);
+
+        if (best < 0) {
+            // Nothing left that this trip can reach or carry: empty the truck at the station
+            if (candidates.Size() == 0 || state.current == 0) {
+                break;
+            }
+
+            float reward = CalculateReward(problem.Distance(state.current, 0), 0.0f, true);
+            totalReward += reward;
+            pendingReward += reward;
+
+            state.current = 0;
+            state.remainingCapacity = problem.vehicleCapacity;
+            route.push_back(0);
+            continue;
+        }
+
+        // Finish the previous move's update now that the next state's best value is known
+        if (learn && hasPending) {
+            float tdError = pendingReward + m_discountFactor * candidates.q[best] - pendingQ;
+            UpdateWeights(pendingFeatures, tdError);
+            CopyWeights(weights);
+            squaredErrorSum += tdError * tdError;
+            numUpdates++;
+        }
+
+        // Epsilon-greedy choice among the feasible candidates
+        size_t slot = static_cast<size_t>(best);
+        if (learn && dist(*rng) < explorationRate) {
+            size_t numFeasible = 0;
+            for (size_t k = 0; k < candidates.Size(); k++) {
+                numFeasible += candidates.feasible[k];
+            }
+
+            std::uniform_int_distribution<size_t> pick(0, numFeasible - 1);
+            size_t skip = pick(*rng);
+            for (size_t k = 0; k < candidates.Size(); k++) {
+                if (candidates.feasible[k] && skip-- == 0) {
+                    slot = k;
+                    break;
+                }
+            }
+        }
+
+        float reward = CalculateReward(candidates.distance[slot], candidates.waste[slot] * 100.0f, false);
+        totalReward += reward;
+
+        if (learn) {
+            GetFeatures(problem, state, candidates, slot, distanceScale, pendingFeatures);
+            pendingQ = candidates.q[slot];
+            pendingReward = reward;
+            hasPending = true;
+        }
+
+        // Move to the candidate
+        state.current = candidates.index[slot];
+        state.remainingCapacity -= candidates.waste[slot] * 100.0f;
+        route.push_back(state.current);
+        candidates.Remove(slot);
+    }
+
+    // Return to the station at the end of the last trip
+    if (state.current != 0) {
+        float reward = CalculateReward(problem.Distance(state.current, 0), 0.0f, true);
+        totalReward += reward;
+        pendingReward += reward;
+        route.push_back(0);
+    }
+
+    // The last move ends the episode, so it has no future value
+    if (learn && hasPending) {
+        float tdError = pendingReward - pendingQ;
+        UpdateWeights(pendingFeatures, tdError);
+        squaredErrorSum += tdError * tdError;
+        numUpdates++;
+    }
+
+    return route;
+}
+
+float FeatureQPolicy::TrainEpisode(const FeatureRoutingProblem& problem, float explorationRate, std::mt19937& rng,
+    double& squaredErrorSum, size_t& numUpdates)
+{
+    float totalReward;
+    RunEpisode(problem, explorationRate, &rng, totalReward, squaredErrorSum, numUpdates);
+    return totalReward;
+}
+
+std::vector<int> FeatureQPolicy::GetRoute(const FeatureRoutingProblem& problem)
+{
+    float totalReward;
+    double squaredErrorSum = 0.0;
+    size_t numUpdates = 0;
+    return RunEpisode(problem, 0.0f, nullptr, totalReward, squaredErrorSum, numUpdates);
+}
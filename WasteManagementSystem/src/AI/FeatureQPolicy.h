@@ -0,0 +1,152 @@
+// FeatureQPolicy.h
+// This file defines a feature-based Q-function for routing with many collection points
+#pragma once
+
+#include <vector>
+#include <random>
+#include <mutex>
+#include <cstddef>
+
+/**
+ * @brief Collection problem seen by the feature-based policy
+ *
+ * Index 0 is the station. Distances come from distanceMatrix when it is filled
+ * (N x N, INF where there is no direct road) and are straight lines between the
+ * coordinates otherwise, so large problems only need O(N) memory.
+ */
+struct FeatureRoutingProblem {
+    std::vector<float> x;                 // X coordinate per point in km (straight-line mode)
+    std::vector<float> y;                 // Y coordinate per point in km (straight-line mode)
+    std::vector<float> distanceMatrix;    // Optional row-major distances in km
+    std::vector<float> wasteLevel;        // Waste level per point (0-100%)
+    std::vector<int> clusterId;           // Cluster per point, -1 if unclustered
+    float vehicleCapacity = 1000.0f;      // Waste one trip can carry, in bin percent
+    float collectionThreshold = 40.0f;    // Points at or above this level need collection
+
+    // Number of points including the station
+    size_t Size() const { return wasteLevel.size(); }
+
+    // Distance between two points in km
+    float Distance(size_t from, size_t to) const;
+};
+
+/**
+ * @brief Linear Q-function over state-action features
+ *
+ * Q(s, a) = w . phi(s, a), where phi describes moving from the current point to a
+ * candidate: distance, the candidate's waste level, whether it is in the current
+ * cluster, the capacity left after collecting it, its distance back to the station
+ * and how much of the route is left. The weights do not depend on the number of
+ * points, and all candidates of a step are scored at once from structure-of-arrays
+ * buffers that the compiler can vectorize.
+ */
+class FeatureQPolicy {
+public:
+    static const int NumFeatures = 8;
+
+private:
+    /* Private members in FeatureQPolicy class */
+    float m_weights[NumFeatures];       // Linear Q-function weights
+    mutable std::mutex m_weightsMutex;  // Lets GetRoute run while another thread trains
+    float m_learningRate;
+    float m_discountFactor;
+
+    // Candidate points of the current step in structure-of-arrays form.
+    // Visiting a point swaps the last candidate into its slot.
+    struct CandidateSet {
+        std::vector<int> index;
+        std::vector<float> x, y;            // Coordinates (straight-line mode)
+        std::vector<float> waste;           // Waste level / 100
+        std::vector<float> stationDistance; // Distance back to the station / scale
+        std::vector<int> cluster;
+
+        // Per-step feature and Q-value buffers
+        std::vector<float> distance;
+        std::vector<float> q;
+        std::vector<unsigned char> feasible;
+
+        size_t Size() const { return index.size(); }
+        void Remove(size_t slot);
+    };
+
+    // State of one route while it is being built
+    struct RouteState {
+        int current = 0;
+        float remainingCapacity = 0.0f;
+        size_t totalStops = 0;
+    };
+
+    // Copy the weights so a step can be scored without holding the lock
+    void CopyWeights(float* weights) const;
+
+    // Fill the candidate set with the points that need collection
+    void BuildCandidates(const FeatureRoutingProblem& problem, float distanceScale, CandidateSet& candidates) const;
+
+    // Score every candidate from the current state; returns the best feasible slot or -1
+    int EvaluateCandidates(const FeatureRoutingProblem& problem, const RouteState& state, float distanceScale,
+        const float* weights, CandidateSet& candidates) const;
+
+    // Features of moving to one candidate (after EvaluateCandidates filled its distance)
+    void GetFeatures(const FeatureRoutingProblem& problem, const RouteState& state, const CandidateSet& candidates,
+        size_t slot, float distanceScale, float* features) const;
+
+    // Apply a normalized semi-gradient TD update for one taken action
+    void UpdateWeights(const float* features, float tdError);
+
+    // Build a route, exploring and learning from it when rng is given
+    std::vector<int> RunEpisode(const FeatureRoutingProblem& problem, float explorationRate, std::mt19937* rng,
+        float& totalReward, double& squaredErrorSum, size_t& numUpdates);
+
+public:
+    /**
+     * @brief Constructor for FeatureQPolicy
+     * @param learningRate Step size of the normalized TD update
+     * @param discountFactor Discount factor for future rewards
+     */
+    FeatureQPolicy(float learningRate = 0.05f, float discountFactor = 0.9f);
+
+    /**
+     * @brief Reset all weights to zero
+     */
+    void Reset();
+
+    /**
+     * @brief Run one exploring episode and update the weights along the way
+     * @param problem Collection problem
+     * @param explorationRate Probability of a random move
+     * @param rng Random number generator for exploration
+     * @param[out] squaredErrorSum Squared TD errors of the episode are added to this
+     * @param[out] numUpdates Number of weight updates is added to this
+     * @return Total reward of the episode
+     */
+    float TrainEpisode(const FeatureRoutingProblem& problem, float explorationRate, std::mt19937& rng,
+        double& squaredErrorSum, size_t& numUpdates);
+
+    /**
+     * @brief Build a route greedily with the learned Q-function
+     * @param problem Collection problem
+     * @return Point indices, starting and ending at the station; trips are separated by station visits
+     */
+    std::vector<int> GetRoute(const FeatureRoutingProblem& problem);
+
+    /**
+     * @brief Get the learned weights
+     * @return Copy of the weights
+     */
+    std::vector<float> GetWeights() const;
+
+    /**
+     * @brief Replace the weights, e.g. with ones loaded from a model file
+     * @param weights NumFeatures weights
+     */
+    void SetWeights(const std::vector<float>& weights);
+
+    /**
+     * @brief Calculate the reward of moving between two points, as used by the tabular agent
+     * @param distance Distance of the move in km
+     * @param wasteLevel Waste level collected at the destination
+     * @param toStation Whether the move returns to the station
+     * @return Reward
+     */
+    static float CalculateReward(float distance, float wasteLevel, bool toStation);
+};
@@ -2,14 +2,308 @@
 // Implementation of the location clustering AI component
 #include "pch.h"
 #include "LocationClustering.h"
+#include "../Utils/ThreadPool.h"
+#include <atomic>
+#include <cstdint>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// Points per parallel chunk. Partial sums are kept per chunk and merged in chunk
+// order, so results do not depend on how many threads ran the chunks.
+static const size_t PointsPerChunk = 8192;
+
+// Clusters with less total weight than this keep their old centroid
+static const double MinClusterWeight = 1e-9;
+
+// Number of nearest centroids a point bids for in the balanced assignment
+static const int BidCandidates = 16;
+
+// Squared distances from a point to the nearest and second nearest of k centroids;
+// returns the nearest centroid (the lowest index on ties)
+static int NearestTwoCentroids(float x, float y, const float* centroidX, const float* centroidY, int k,
+    float& nearestSquared, float& secondSquared)
+{
+    int nearest = 0;
+    nearestSquared = std::numeric_limits<float>::max();
+    secondSquared = std::numeric_limits<float>::max();
+    int c = 0;
+
+#if defined(__AVX2__)
+    // Each lane tracks its own two smallest distances over every eighth centroid
+    if (k >= 8) {
+        __m256 pointX = _mm256_set1_ps(x);
+        __m256 pointY = _mm256_set1_ps(y);
+        __m256 best = _mm256_set1_ps(std::numeric_limits<float>::max());
+        __m256 second = best;
+        __m256i bestIndex = _mm256_setzero_si256();
+        __m256i index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        const __m256i step = _mm256_set1_epi32(8);
+
+        for (; c + 8 <= k; c += 8) {
+            __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(centroidX + c), pointX);
+            __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(centroidY + c), pointY);
+            __m256 distance = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+
+            __m256 closer = _mm256_cmp_ps(distance, best, _CMP_LT_OQ);
+            second = _mm256_blendv_ps(_mm256_min_ps(second, distance), best, closer);
+            best = _mm256_blendv_ps(best, distance, closer);
+            bestIndex = _mm256_blendv_epi8(bestIndex, index, _mm256_castps_si256(closer));
+            index = _mm256_add_epi32(index, step);
+        }
+
+        float laneBest[8], laneSecond[8];
+        int laneIndex[8];
+        _mm256_storeu_ps(laneBest, best);
+        _mm256_storeu_ps(laneSecond, second);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(laneIndex), bestIndex);
+
+        // Combine the lanes the same way the scalar loop would have
+        int winner = 0;
+        for (int lane = 1; lane < 8; lane++) {
+            if (laneBest[lane] < laneBest[winner] ||
+                (laneBest[lane] == laneBest[winner] && laneIndex[lane] < laneIndex[winner])) {
+                winner = lane;
+            }
+        }
+
+        nearest = laneIndex[winner];
+        nearestSquared = laneBest[winner];
+        secondSquared = laneSecond[winner];
+        for (int lane = 0; lane < 8; lane++) {
+            if (lane != winner) {
+                secondSquared = std::min(secondSquared, laneBest[lane]);
+            }
+        }
+    }
+#endif
+
+    for (; c < k; c++) {
+        float dx = centroidX[c] - x;
+        float dy = centroidY[c] - y;
+        float distance = dx * dx + dy * dy;
+
+        if (distance < nearestSquared) {
+            secondSquared = nearestSquared;
+            nearestSquared = distance;
+            nearest = c;
+        }
+        else if (distance < secondSquared) {
+            secondSquared = distance;
+        }
+    }
+
+    return nearest;
+}
+
+// Sum of distances from (x, y) to count points
+static float SumOfDistances(float x, float y, const float* pointX, const float* pointY, size_t count)
+{
+    size_t i = 0;
+    float total = 0.0f;
+
+#if defined(__AVX2__)
+    __m256 px = _mm256_set1_ps(x);
+    __m256 py = _mm256_set1_ps(y);
+    __m256 sum = _mm256_setzero_ps();
+    for (; i + 8 <= count; i += 8) {
+        __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(pointX + i), px);
+        __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(pointY + i), py);
+        __m256 squared = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+        sum = _mm256_add_ps(sum, _mm256_sqrt_ps(squared));
+    }
+
+    float lanes[8];
+    _mm256_storeu_ps(lanes, sum);
+    for (int lane = 0; lane < 8; lane++) {
+        total += lanes[lane];
+    }
+#endif
+
+    for (; i < count; i++) {
+        float dx = pointX[i] - x;
+        float dy = pointY[i] - y;
+        total += std::sqrt(dx * dx + dy * dy);
+    }
+    return total;
+}
+
+// Mean silhouette of points given in cluster order; clusterStart holds the first
+// point of every cluster plus the end
+static double MeanSilhouette(const std::vector<float>& x, const std::vector<float>& y,
+    const std::vector<size_t>& clusterStart)
+{
+    const size_t count = x.size();
+    const size_t numClusters = clusterStart.size() - 1;
+    if (numClusters < 2 || count == 0) {
+        return 0.0;
+    }
+
+    double total = 0.0;
+    for (size_t c = 0; c < numClusters; c++) {
+        size_t ownSize = clusterStart[c + 1] - clusterStart[c];
+
+        for (size_t i = clusterStart[c]; i < clusterStart[c + 1]; i++) {
+            // A point alone in its cluster scores 0
+            if (ownSize < 2) {
+                continue;
+            }
+
+            // Mean distance to its own cluster (a) and to the closest other cluster (b)
+            float own = 0.0f;
+            float nearestOther = std::numeric_limits<float>::max();
+            for (size_t other = 0; other < numClusters; other++) {
+                size_t size = clusterStart[other + 1] - clusterStart[other];
+                if (size == 0) {
+                    continue;
+                }
+
+                float sum = SumOfDistances(x[i], y[i], &x[clusterStart[other]], &y[clusterStart[other]], size);
+                if (other == c) {
+                    own = sum / (size - 1);
+                }
+                else {
+                    nearestOther = std::min(nearestOther, sum / size);
+                }
+            }
+
+            // Without another non-empty cluster there is nothing to compare with
+            float larger = std::max(own, nearestOther);
+            if (nearestOther < std::numeric_limits<float>::max() && larger > 0.0f) {
+                total += (nearestOther - own) / larger;
+            }
+        }
+    }
+
+    return total / count;
+}
+
+namespace {
+    // Points bucketed into square cells as wide as the search radius, so all neighbours
+    // of a point lie in its own cell and the eight around it
+    struct PointGrid {
+        float minX = 0.0f;
+        float minY = 0.0f;
+        float cellSize = 1.0f;
+        std::vector<uint64_t> cellKeys;   // Key of every non-empty cell, sorted
+        std::vector<size_t> cellStart;    // Start of every cell in order, plus the end
+        std::vector<size_t> order;        // Point indices sorted by cell
+        std::vector<float> sortedX;       // Coordinates in cell order, so cells are contiguous
+        std::vector<float> sortedY;
+
+        static uint64_t Key(uint64_t cellX, uint64_t cellY) { return (cellX << 32) | cellY; }
+
+        void Build(const std::vector<float>& x, const std::vector<float>& y, float size)
+        {
+            const size_t count = x.size();
+            cellSize = size;
+            minX = *std::min_element(x.begin(), x.end());
+            minY = *std::min_element(y.begin(), y.end());
+
+            std::vector<uint64_t> keys(count);
+            for (size_t i = 0; i < count; i++) {
+                keys[i] = Key(static_cast<uint64_t>((x[i] - minX) / cellSize),
+                    static_cast<uint64_t>((y[i] - minY) / cellSize));
+            }
+
+            order.resize(count);
+            std::iota(order.begin(), order.end(), static_cast<size_t>(0));
+            std::stable_sort(order.begin(), order.end(), [&keys](size_t a, size_t b) { return keys[a] < keys[b]; });
+
+            sortedX.resize(count);
+            sortedY.resize(count);
+            for (size_t n = 0; n < count; n++) {
+                sortedX[n] = x[order[n]];
+                sortedY[n] = y[order[n]];
+            }
+
+            cellKeys.clear();
+            cellStart.clear();
+            for (size_t n = 0; n < count; n++) {
+                if (n == 0 || keys[order[n]] != cellKeys.back()) {
+                    cellKeys.push_back(keys[order[n]]);
+                    cellStart.push_back(n);
+                }
+            }
+            cellStart.push_back(count);
+        }
+
+        // Cells around a cell (itself included) that contain points
+        int GetNeighborCells(size_t cell, size_t* neighbors) const
+        {
+            int64_t cellX = static_cast<int64_t>(cellKeys[cell] >> 32);
+            int64_t cellY = static_cast<int64_t>(cellKeys[cell] & 0xFFFFFFFFu);
+            int numNeighbors = 0;
+
+            for (int64_t nx = cellX - 1; nx <= cellX + 1; nx++) {
+                for (int64_t ny = cellY - 1; ny <= cellY + 1; ny++) {
+                    if (nx < 0 || ny < 0) {
+                        continue;
+                    }
+
+                    uint64_t key = Key(static_cast<uint64_t>(nx), static_cast<uint64_t>(ny));
+                    auto it = std::lower_bound(cellKeys.begin(), cellKeys.end(), key);
+                    if (it != cellKeys.end() && *it == key) {
+                        neighbors[numNeighbors++] = static_cast<size_t>(it - cellKeys.begin());
+                    }
+                }
+            }
+            return numNeighbors;
+        }
+    };
+
+    // Lock-free union-find. Roots always link below smaller indices, so every
+    // component ends up rooted at its smallest element whatever order unions ran in.
+    int FindRoot(std::atomic<int>* parents, int i)
+    {
+        while (true) {
+            int parent = parents[i].load(std::memory_order_relaxed);
+            if (parent == i) {
+                return i;
+            }
+
+            // Path halving: point i at its grandparent
+            int grandparent = parents[parent].load(std::memory_order_relaxed);
+            if (grandparent != parent) {
+                parents[i].compare_exchange_weak(parent, grandparent, std::memory_order_relaxed);
+            }
+            i = grandparent;
+        }
+    }
+
+    void UnionRoots(std::atomic<int>* parents, int a, int b)
+    {
+        while (true) {
+            a = FindRoot(parents, a);
+            b = FindRoot(parents, b);
+            if (a == b) {
+                return;
+            }
+            if (a < b) {
+                std::swap(a, b);
+            }
+
+            // Another thread may have linked a in the meantime; then try again
+            int expected = a;
+            if (parents[a].compare_exchange_strong(expected, b, std::memory_order_relaxed)) {
+                return;
+            }
+        }
+    }
+}
 
 LocationClustering::LocationClustering(int numClusters)
     : m_numClusters(numClusters),
+    m_lastIterations(0),
+    m_inertia(0.0),
     m_distanceWeight(0.7f),
     m_wasteLevelWeight(0.3f),
-    m_maxIterations(100)
+    m_maxIterations(100),
+    m_tolerance(1e-4f)
 {
+    std::random_device rd;
+    m_rng.seed(rd());
 }
 
 LocationClustering::~LocationClustering()
@@ -21,148 +315,383 @@ void LocationClustering::Initialize()
     // Clear previous clustering data
     m_clusterAssignments.clear();
     m_centroids.clear();
+    m_centroidX.clear();
+    m_centroidY.clear();
+    m_pointX.clear();
+    m_pointY.clear();
+    m_pointNames.clear();
+    m_pointWeights.clear();
+    m_labels.clear();
+    m_clusterSumX.clear();
+    m_clusterSumY.clear();
+    m_clusterWeights.clear();
 }
 
-void LocationClustering::InitializeCentroids(const std::vector<WasteLocation>& locations, int k)
+void LocationClustering::InitializeCentroids(int k)
 {
-    m_centroids.clear();
+    const size_t count = m_pointX.size();
+    const float* pointX = m_pointX.data();
+    const float* pointY = m_pointY.data();
 
-    // Random number generator
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dist(0, locations.size() - 1);
+    ThreadPool& pool = ThreadPool::Shared();
+    const size_t numChunks = ThreadPool::GetChunkCount(count, PointsPerChunk);
+
+    m_centroidX.clear();
+    m_centroidY.clear();
+    m_centroidX.reserve(k);
+    m_centroidY.reserve(k);
 
     // Implement K-means++ initialization
 
     // Choose first centroid randomly
-    int firstIdx = dist(gen);
-    std::string firstName = locations[firstIdx].GetLocationName();
-    int firstId = WasteLocation::dict_Name_toId[firstName];
-    m_centroids.push_back({
-        WasteLocation::location_coordinates[firstId][0],
-        WasteLocation::location_coordinates[firstId][1]
-        });
-
-    // Choose remaining centroids using K-means++
-    for (int i = 1; i < k; i++) {
-        // Calculate squared distances from each point to nearest centroid
-        std::vector<float> distances(locations.size(), std::numeric_limits<float>::max());
-        float totalDistance = 0.0f;
-
-        for (size_t j = 0; j < locations.size(); j++) {
-            std::string name = locations[j].GetLocationName();
-            int id = WasteLocation::dict_Name_toId[name];
+    std::uniform_int_distribution<size_t> dist(0, count - 1);
+    size_t next = dist(m_rng);
+
+    // Squared distance from each point to its nearest chosen centroid, updated
+    // with each new centroid instead of recomputed against all of them
+    std::vector<float> distances(count, std::numeric_limits<float>::max());
+    std::vector<double> chunkTotals(numChunks);
+
+    for (int c = 0; c < k; c++) {
+        float centroidX = pointX[next];
+        float centroidY = pointY[next];
+        m_centroidX.push_back(centroidX);
+        m_centroidY.push_back(centroidY);
+
+        if (c + 1 == k) {
+            break;
+        }
 
-            // Skip station
-            if (id == 0) {
-                continue;
+        pool.ParallelFor(count, PointsPerChunk, [&](size_t chunk, size_t begin, size_t end) {
+            double total = 0.0;
+            for (size_t i = begin; i < end; i++) {
+                float dx = pointX[i] - centroidX;
+                float dy = pointY[i] - centroidY;
+                distances[i] = std::min(distances[i], dx * dx + dy * dy);
+                total += distances[i];
             }
+            chunkTotals[chunk] = total;
+            });
 
-            // Find distance to nearest centroid
-            for (const auto& centroid : m_centroids) {
-                float dx = WasteLocation::location_coordinates[id][0] - centroid.first;
-                float dy = WasteLocation::location_coordinates[id][1] - centroid.second;
-                float distance = dx * dx + dy * dy; // Squared distance
+        double totalDistance = 0.0;
+        for (size_t chunk = 0; chunk < numChunks; chunk++) {
+            totalDistance += chunkTotals[chunk];
+        }
 
-                distances[j] = std::min(distances[j], distance);
+        // Choose next centroid with probability proportional to squared distance:
+        // find the chunk holding the target, then the point inside it
+        next = dist(m_rng);
+        if (totalDistance > 0.0) {
+            double target = std::uniform_real_distribution<double>(0.0, totalDistance)(m_rng);
+            size_t chunk = 0;
+            while (chunk + 1 < numChunks && target > chunkTotals[chunk]) {
+                target -= chunkTotals[chunk];
+                chunk++;
             }
 
-            totalDistance += distances[j];
+            size_t begin = chunk * PointsPerChunk;
+            size_t end = std::min(count, begin + PointsPerChunk);
+            double cumulative = 0.0;
+            for (size_t i = begin; i < end; i++) {
+                if (distances[i] > 0.0f) {
+                    next = i;
+                    cumulative += distances[i];
+                    if (cumulative >= target) {
+                        break;
+                    }
+                }
+            }
         }
-
-        // Choose next centroid with probability proportional to squared distance
-        std::discrete_distribution<> weightedDist(distances.begin(), distances.end());
-        int nextIdx = weightedDist(gen);
-        std::string nextName = locations[nextIdx].GetLocationName();
-        int nextId = WasteLocation::dict_Name_toId[nextName];
-
-        m_centroids.push_back({
-            WasteLocation::location_coordinates[nextId][0],
-            WasteLocation::location_coordinates[nextId][1]
-            });
     }
 }
 
-bool LocationClustering::AssignClusters(const std::vector<WasteLocation>& locations)
+int LocationClustering::FindNearestTwo(float x, float y, float& nearestDistance, float& secondDistance) const
 {
-    bool changed = false;
+    const int k = static_cast<int>(m_centroidX.size());
+    float nearestSquared, secondSquared;
+    int nearest = NearestTwoCentroids(x, y, m_centroidX.data(), m_centroidY.data(), k, nearestSquared, secondSquared);
 
-    // For each location, assign to nearest centroid
-    for (const auto& location : locations) {
-        std::string name = location.GetLocationName();
-        int id = WasteLocation::dict_Name_toId[name];
+    nearestDistance = std::sqrt(nearestSquared);
+    secondDistance = k > 1 ? std::sqrt(secondSquared) : std::numeric_limits<float>::max();
+    return nearest;
+}
 
-        // Skip station
-        if (id == 0) {
-            continue;
+void LocationClustering::SortCentroidNeighbors()
+{
+    const int k = static_cast<int>(m_centroidX.size());
+    const size_t stride = k > 1 ? k - 1 : 0;
+    m_neighborDistances.resize(k * stride);
+    m_neighborIds.resize(k * stride);
+
+    std::vector<std::pair<float, int>> neighbors(stride);
+    for (int c = 0; c < k; c++) {
+        size_t j = 0;
+        for (int other = 0; other < k; other++) {
+            if (other != c) {
+                float dx = m_centroidX[c] - m_centroidX[other];
+                float dy = m_centroidY[c] - m_centroidY[other];
+                neighbors[j++] = { std::sqrt(dx * dx + dy * dy), other };
+            }
         }
+        std::sort(neighbors.begin(), neighbors.end());
 
-        // Find nearest centroid
-        int nearestCluster = 0;
-        float minDistance = std::numeric_limits<float>::max();
+        for (j = 0; j < stride; j++) {
+            m_neighborDistances[c * stride + j] = neighbors[j].first;
+            m_neighborIds[c * stride + j] = neighbors[j].second;
+        }
+    }
+}
 
-        for (int i = 0; i < m_numClusters; i++) {
-            float dx = WasteLocation::location_coordinates[id][0] - m_centroids[i].first;
-            float dy = WasteLocation::location_coordinates[id][1] - m_centroids[i].second;
-            float distance = std::sqrt(dx * dx + dy * dy);
+int LocationClustering::FindNearestTwoFrom(float x, float y, int label, float labelDistance,
+    float& nearestDistance, float& secondDistance) const
+{
+    const size_t stride = m_centroidX.size() - 1;
+    const float* distances = m_neighborDistances.data() + label * stride;
+    const int* ids = m_neighborIds.data() + label * stride;
+
+    int nearest = label;
+    nearestDistance = labelDistance;
+    secondDistance = std::numeric_limits<float>::max();
+
+    // By the triangle inequality d(x, c) >= d(label, c) - d(x, label), so once that
+    // reaches the second smallest distance found, no further neighbour can matter
+    for (size_t j = 0; j < stride; j++) {
+        if (distances[j] - labelDistance >= secondDistance) {
+            break;
+        }
 
-            // Apply waste level weight
-            float wasteLevel = location.GetWasteLevel();
-            float weightedDistance = m_distanceWeight * distance - m_wasteLevelWeight * wasteLevel;
+        int c = ids[j];
+        float dx = x - m_centroidX[c];
+        float dy = y - m_centroidY[c];
+        float distance = std::sqrt(dx * dx + dy * dy);
 
-            if (weightedDistance < minDistance) {
-                minDistance = weightedDistance;
-                nearestCluster = i;
-            }
+        if (distance < nearestDistance) {
+            secondDistance = nearestDistance;
+            nearestDistance = distance;
+            nearest = c;
         }
-
-        // Check if cluster assignment changed
-        if (m_clusterAssignments.find(name) == m_clusterAssignments.end() ||
-            m_clusterAssignments[name] != nearestCluster) {
-            m_clusterAssignments[name] = nearestCluster;
-            changed = true;
+        else if (distance < secondDistance) {
+            secondDistance = distance;
         }
     }
 
-    return changed;
+    return nearest;
 }
 
-void LocationClustering::UpdateCentroids(const std::vector<WasteLocation>& locations)
+int LocationClustering::RunHamerly(int maxIterations)
 {
-    // Reset centroids
-    std::vector<std::pair<float, float>> newCentroids(m_numClusters, { 0.0f, 0.0f });
-    std::vector<int> clusterSizes(m_numClusters, 0);
+    const size_t count = m_pointX.size();
+    const int k = static_cast<int>(m_centroidX.size());
+    const float* pointX = m_pointX.data();
+    const float* pointY = m_pointY.data();
+    const float* weights = m_pointWeights.data();
+
+    m_labels.resize(count);
+    m_upperBounds.resize(count);
+    m_lowerBounds.resize(count);
+    int* labels = m_labels.data();
+    float* upper = m_upperBounds.data();
+    float* lower = m_lowerBounds.data();
+
+    ThreadPool& pool = ThreadPool::Shared();
+    const size_t numChunks = ThreadPool::GetChunkCount(count, PointsPerChunk);
+
+    // Running weighted coordinate sums per cluster, adjusted only when a point changes cluster
+    std::vector<double>& sumX = m_clusterSumX;
+    std::vector<double>& sumY = m_clusterSumY;
+    std::vector<double>& sizes = m_clusterWeights;
+    sumX.assign(k, 0.0);
+    sumY.assign(k, 0.0);
+    sizes.assign(k, 0.0);
+    std::vector<float> movement(k, 0.0f);
+    std::vector<float> halfGap(k, 0.0f);
+
+    // Per-chunk partial sums (or changes to the sums), k entries per chunk
+    std::vector<double> chunkSumX(numChunks * k), chunkSumY(numChunks * k);
+    std::vector<double> chunkSizes(numChunks * k);
+    std::vector<size_t> chunkChanged(numChunks);
+    std::vector<double> chunkStats(numChunks * 4);
+
+    // Add the chunk partials to the running sums in chunk order
+    auto mergeChunks = [&]() {
+        for (size_t chunk = 0; chunk < numChunks; chunk++) {
+            for (int c = 0; c < k; c++) {
+                sumX[c] += chunkSumX[chunk * k + c];
+                sumY[c] += chunkSumY[chunk * k + c];
+                sizes[c] += chunkSizes[chunk * k + c];
+            }
+        }
+    };
+
+    // Convergence threshold scaled by the spread of the points
+    pool.ParallelFor(count, PointsPerChunk, [&](size_t chunk, size_t begin, size_t end) {
+        double stats[4] = { 0.0, 0.0, 0.0, 0.0 };
+        for (size_t i = begin; i < end; i++) {
+            stats[0] += pointX[i];
+            stats[1] += pointY[i];
+            stats[2] += static_cast<double>(pointX[i]) * pointX[i];
+            stats[3] += static_cast<double>(pointY[i]) * pointY[i];
+        }
+        std::copy(stats, stats + 4, chunkStats.begin() + chunk * 4);
+        });
 
-    // Sum up coordinates for each cluster
-    for (const auto& location : locations) {
-        std::string name = location.GetLocationName();
+    double meanX = 0.0, meanY = 0.0, squareX = 0.0, squareY = 0.0;
+    for (size_t chunk = 0; chunk < numChunks; chunk++) {
+        meanX += chunkStats[chunk * 4];
+        meanY += chunkStats[chunk * 4 + 1];
+        squareX += chunkStats[chunk * 4 + 2];
+        squareY += chunkStats[chunk * 4 + 3];
+    }
+    meanX /= count;
+    meanY /= count;
+    double meanVariance = 0.5 * (squareX / count - meanX * meanX + squareY / count - meanY * meanY);
+    double shiftThreshold = m_tolerance * std::max(0.0, meanVariance);
+
+    // Assign every point to its nearest centroid once
+    pool.ParallelFor(count, PointsPerChunk, [&](size_t chunk, size_t begin, size_t end) {
+        double* partialX = chunkSumX.data() + chunk * k;
+        double* partialY = chunkSumY.data() + chunk * k;
+        double* partialSizes = chunkSizes.data() + chunk * k;
+        std::fill(partialX, partialX + k, 0.0);
+        std::fill(partialY, partialY + k, 0.0);
+        std::fill(partialSizes, partialSizes + k, 0.0);
+
+        for (size_t i = begin; i < end; i++) {
+            int label = FindNearestTwo(pointX[i], pointY[i], upper[i], lower[i]);
+            labels[i] = label;
+            partialX[label] += static_cast<double>(weights[i]) * pointX[i];
+            partialY[label] += static_cast<double>(weights[i]) * pointY[i];
+            partialSizes[label] += weights[i];
+        }
+        });
+    mergeChunks();
+
+    int iteration = 0;
+    while (iteration < maxIterations) {
+        iteration++;
+
+        // Update centroid positions; if a cluster has no weight, keep its old centroid
+        int fastest = 0;
+        for (int c = 0; c < k; c++) {
+            movement[c] = 0.0f;
+            if (sizes[c] > MinClusterWeight) {
+                float newX = static_cast<float>(sumX[c] / sizes[c]);
+                float newY = static_cast<float>(sumY[c] / sizes[c]);
+                float dx = newX - m_centroidX[c];
+                float dy = newY - m_centroidY[c];
+                movement[c] = std::sqrt(dx * dx + dy * dy);
+                m_centroidX[c] = newX;
+                m_centroidY[c] = newY;
+            }
+            if (movement[c] > movement[fastest]) {
+                fastest = c;
+            }
+        }
 
-        // Skip station and locations without cluster assignment
-        if (name == "Station" || m_clusterAssignments.find(name) == m_clusterAssignments.end()) {
-            continue;
+        float maxMovement = movement[fastest];
+        double squaredShift = 0.0;
+        for (int c = 0; c < k; c++) {
+            squaredShift += static_cast<double>(movement[c]) * movement[c];
+        }
+        if (maxMovement == 0.0f || squaredShift <= shiftThreshold) {
+            break;
         }
 
-        int clusterId = m_clusterAssignments[name];
-        int locId = WasteLocation::dict_Name_toId[name];
+        float secondMovement = 0.0f;
+        for (int c = 0; c < k; c++) {
+            if (c != fastest) {
+                secondMovement = std::max(secondMovement, movement[c]);
+            }
+        }
 
-        newCentroids[clusterId].first += WasteLocation::location_coordinates[locId][0];
-        newCentroids[clusterId].second += WasteLocation::location_coordinates[locId][1];
-        clusterSizes[clusterId]++;
-    }
+        // Half the distance from each centroid to its nearest other centroid: a point
+        // closer to its own centroid than that cannot be closer to any other one
+        SortCentroidNeighbors();
+        for (int c = 0; c < k; c++) {
+            halfGap[c] = k > 1 ? 0.5f * m_neighborDistances[c * (k - 1)] : std::numeric_limits<float>::max();
+        }
+
+        // Assign clusters, skipping points whose bounds rule out a change.
+        // Each chunk records how its points moved between clusters.
+        pool.ParallelFor(count, PointsPerChunk, [&](size_t chunk, size_t begin, size_t end) {
+            double* deltaX = chunkSumX.data() + chunk * k;
+            double* deltaY = chunkSumY.data() + chunk * k;
+            double* deltaSizes = chunkSizes.data() + chunk * k;
+            std::fill(deltaX, deltaX + k, 0.0);
+            std::fill(deltaY, deltaY + k, 0.0);
+            std::fill(deltaSizes, deltaSizes + k, 0.0);
+            size_t changed = 0;
+
+            for (size_t i = begin; i < end; i++) {
+                int label = labels[i];
+
+                // Centroids moved, so loosen the bounds by how far they went
+                upper[i] += movement[label];
+                lower[i] -= (label == fastest) ? secondMovement : maxMovement;
+
+                float bound = std::max(halfGap[label], lower[i]);
+                if (upper[i] <= bound) {
+                    continue;
+                }
 
-    // Calculate average coordinates (centroid)
-    for (int i = 0; i < m_numClusters; i++) {
-        if (clusterSizes[i] > 0) {
-            newCentroids[i].first /= clusterSizes[i];
-            newCentroids[i].second /= clusterSizes[i];
+                // Tighten the upper bound and test again before a full scan
+                float dx = pointX[i] - m_centroidX[label];
+                float dy = pointY[i] - m_centroidY[label];
+                upper[i] = std::sqrt(dx * dx + dy * dy);
+                if (upper[i] <= bound) {
+                    continue;
+                }
+
+                int nearest = FindNearestTwoFrom(pointX[i], pointY[i], label, upper[i], upper[i], lower[i]);
+                if (nearest != label) {
+                    double weightedX = static_cast<double>(weights[i]) * pointX[i];
+                    double weightedY = static_cast<double>(weights[i]) * pointY[i];
+                    deltaX[label] -= weightedX;
+                    deltaY[label] -= weightedY;
+                    deltaSizes[label] -= weights[i];
+                    deltaX[nearest] += weightedX;
+                    deltaY[nearest] += weightedY;
+                    deltaSizes[nearest] += weights[i];
+                    labels[i] = nearest;
+                    changed++;
+                }
+            }
+
+            chunkChanged[chunk] = changed;
+            });
+        mergeChunks();
+
+        size_t changed = std::accumulate(chunkChanged.begin(), chunkChanged.end(), static_cast<size_t>(0));
+        if (changed == 0) {
+            break;
         }
-        else {
-            // If cluster is empty, keep old centroid
-            newCentroids[i] = m_centroids[i];
+    }
+
+    // Sum of squared distances to the final centroids
+    pool.ParallelFor(count, PointsPerChunk, [&](size_t chunk, size_t begin, size_t end) {
+        double inertia = 0.0;
+        for (size_t i = begin; i < end; i++) {
+            float dx = pointX[i] - m_centroidX[labels[i]];
+            float dy = pointY[i] - m_centroidY[labels[i]];
+            inertia += weights[i] * (dx * dx + dy * dy);
         }
+        chunkStats[chunk * 4] = inertia;
+        });
+
+    m_inertia = 0.0;
+    for (size_t chunk = 0; chunk < numChunks; chunk++) {
+        m_inertia += chunkStats[chunk * 4];
     }
 
-    m_centroids = newCentroids;
+    return iteration;
+}
+
+void LocationClustering::PublishCentroids()
+{
+    m_centroids.resize(m_centroidX.size());
+    for (size_t c = 0; c < m_centroidX.size(); c++) {
+        m_centroids[c] = { m_centroidX[c], m_centroidY[c] };
+    }
 }
 
 float LocationClustering::CalculateDistance(const WasteLocation& loc1, const WasteLocation& loc2)
@@ -199,41 +728,909 @@ int LocationClustering::GetLocationIndex(const std::vector<WasteLocation>& locat
     return -1;
 }
 
+void LocationClustering::GatherLocationPoints(const std::vector<WasteLocation>& locations,
+    std::vector<float>& x, std::vector<float>& y, std::vector<float>& wasteLevels, std::vector<std::string>& names) const
+{
+    // The station is not clustered
+    for (const auto& location : locations) {
+        std::string name = location.GetLocationName();
+        auto it = WasteLocation::dict_Name_toId.find(name);
+        if (it == WasteLocation::dict_Name_toId.end() || it->second == 0) {
+            continue;
+        }
+
+        x.push_back(WasteLocation::location_coordinates[it->second][0]);
+        y.push_back(WasteLocation::location_coordinates[it->second][1]);
+        wasteLevels.push_back(location.GetWasteLevel());
+        names.push_back(name);
+    }
+}
+
 bool LocationClustering::RunClustering(const std::vector<WasteLocation>& locations, int iterations)
 {
+    std::vector<float> x, y, wasteLevels;
+    std::vector<std::string> names;
+    GatherLocationPoints(locations, x, y, wasteLevels, names);
+
+    // The waste level term of the weighted distance is the same for every centroid,
+    // so it never changes which centroid is nearest: cluster on coordinates alone
+    if (!RunClustering(x, y, iterations)) {
+        return false;
+    }
+
+    PublishLocationAssignments(names);
+    return true;
+}
+
+void LocationClustering::PublishLocationAssignments(const std::vector<std::string>& names)
+{
+    // Name-keyed assignments for the lookup API
+    m_pointNames = names;
+    m_clusterAssignments.clear();
+    for (size_t i = 0; i < m_pointNames.size(); i++) {
+        m_clusterAssignments[m_pointNames[i]] = m_labels[i];
+    }
+
+    // Print cluster assignments
+    for (int i = 0; i < static_cast<int>(m_centroids.size()); i++) {
+        std::cout << "Cluster " << i << ": ";
+        for (size_t j = 0; j < m_pointNames.size(); j++) {
+            if (m_labels[j] == i) {
+                std::cout << m_pointNames[j] << " ";
+            }
+        }
+        std::cout << std::endl;
+    }
+}
+
+bool LocationClustering::RunClustering(const std::vector<float>& x, const std::vector<float>& y, int iterations)
+{
+    if (x.empty() || x.size() != y.size() || m_numClusters <= 0) {
+        std::cerr << "Cannot cluster " << x.size() << " points into " << m_numClusters << " clusters" << std::endl;
+        return false;
+    }
+
+    m_pointX = x;
+    m_pointY = y;
+    m_pointWeights.assign(x.size(), 1.0f);
+    m_pointNames.clear();
+    m_clusterAssignments.clear();
+    m_clusterLoads.clear();
+
     // Initialize centroids
-    InitializeCentroids(locations, m_numClusters);
+    int k = static_cast<int>(std::min<size_t>(m_numClusters, x.size()));
+    InitializeCentroids(k);
 
     // Run K-means algorithm
-    bool changed = true;
-    int iter = 0;
+    m_lastIterations = RunHamerly(iterations);
+    PublishCentroids();
+
+    std::cout << "K-means clustering completed after " << m_lastIterations << " iterations" << std::endl;
+
+    return true;
+}
+
+std::vector<size_t> LocationClustering::AssignWithCapacity(const std::vector<float>& demands, float capacity)
+{
+    const size_t count = m_pointX.size();
+    const int k = static_cast<int>(m_centroidX.size());
+
+    std::fill(m_labels.begin(), m_labels.end(), -1);
+    m_clusterLoads.assign(k, 0.0f);
+
+    auto squaredDistance = [&](size_t i, int c) {
+        float dx = m_pointX[i] - m_centroidX[c];
+        float dy = m_pointY[i] - m_centroidY[c];
+        return dx * dx + dy * dy;
+    };
+
+    // Points only bid for centroids near them: their nearest centroid and the ones
+    // closest to it, which is where a cheap alternative for the point can be
+    const int numCandidates = std::min(k, BidCandidates);
+    const int numNeighbors = std::min(k - 1, 2 * BidCandidates);
+    std::vector<int> candidates(count * numCandidates);
+    std::vector<double> chunkNearest(ThreadPool::GetChunkCount(count, PointsPerChunk));
+
+    // Closest other centroids of every centroid, numNeighbors per centroid
+    std::vector<int> nearbyCentroids(k * numNeighbors);
+    ThreadPool::Shared().ParallelFor(k, 64, [&](size_t, size_t begin, size_t end) {
+        std::vector<std::pair<float, int>> order;
+        for (size_t c = begin; c < end; c++) {
+            order.clear();
+            for (int other = 0; other < k; other++) {
+                if (other != static_cast<int>(c)) {
+                    float dx = m_centroidX[c] - m_centroidX[other];
+                    float dy = m_centroidY[c] - m_centroidY[other];
+                    order.push_back(std::make_pair(dx * dx + dy * dy, other));
+                }
+            }
+            std::partial_sort(order.begin(), order.begin() + numNeighbors, order.end());
+            for (int n = 0; n < numNeighbors; n++) {
+                nearbyCentroids[c * numNeighbors + n] = order[n].second;
+            }
+        }
+        });
+
+    ThreadPool::Shared().ParallelFor(count, PointsPerChunk, [&](size_t chunk, size_t begin, size_t end) {
+        std::vector<std::pair<float, int>> order(numNeighbors + 1);
+        double nearestSum = 0.0;
+        for (size_t i = begin; i < end; i++) {
+            float nearestSquared, secondSquared;
+            int nearest = NearestTwoCentroids(m_pointX[i], m_pointY[i], m_centroidX.data(), m_centroidY.data(), k,
+                nearestSquared, secondSquared);
+            nearestSum += nearestSquared;
+
+            const int* neighbors = nearbyCentroids.data() + nearest * numNeighbors;
+            order[0] = std::make_pair(nearestSquared, nearest);
+            for (int n = 0; n < numNeighbors; n++) {
+                order[n + 1] = std::make_pair(squaredDistance(i, neighbors[n]), neighbors[n]);
+            }
+            std::partial_sort(order.begin(), order.begin() + numCandidates, order.end());
+            for (int n = 0; n < numCandidates; n++) {
+                candidates[i * numCandidates + n] = order[n].second;
+            }
+        }
+        chunkNearest[chunk] = nearestSum;
+        });
+
+    // Empty bins never use capacity and simply join their nearest centroid
+    std::queue<size_t> unassigned;
+    for (size_t i = 0; i < count; i++) {
+        if (demands[i] <= 0.0f) {
+            m_labels[i] = candidates[i * numCandidates];
+        }
+        else {
+            unassigned.push(i);
+        }
+    }
+    double meanNearest = std::accumulate(chunkNearest.begin(), chunkNearest.end(), 0.0);
+
+    // Minimum bid increment; larger values finish sooner but further from the optimum
+    const double epsilon = 1e-3 * meanNearest / std::max<size_t>(1, count) + 1e-6;
+
+    // Auction: every cluster has a price per unit of waste. A point bids for the cluster
+    // with the best value (-distance^2 - price * demand), raising its price by the margin
+    // over the second best. An overfull cluster evicts its lowest bidders, who bid again.
+    typedef std::pair<double, size_t> Bid;
+    std::vector<std::priority_queue<Bid, std::vector<Bid>, std::greater<Bid>>> members(k);
+    std::vector<double> prices(k, 0.0);
+    size_t bidsLeft = 10 * count + 1000;
+
+    while (!unassigned.empty() && bidsLeft > 0) {
+        bidsLeft--;
+        size_t i = unassigned.front();
+        unassigned.pop();
+
+        int best = 0;
+        double bestValue = -std::numeric_limits<double>::max();
+        double secondValue = -std::numeric_limits<double>::max();
+        for (int n = 0; n < numCandidates; n++) {
+            int c = candidates[i * numCandidates + n];
+            double value = -static_cast<double>(squaredDistance(i, c)) - prices[c] * demands[i];
+            if (value > bestValue) {
+                secondValue = bestValue;
+                bestValue = value;
+                best = c;
+            }
+            else if (value > secondValue) {
+                secondValue = value;
+            }
+        }
+
+        double margin = numCandidates > 1 ? bestValue - secondValue : 0.0;
+        double bid = prices[best] + (margin + epsilon) / demands[i];
+
+        members[best].push(Bid(bid, i));
+        m_labels[i] = best;
+        m_clusterLoads[best] += demands[i];
+
+        // Evict the lowest bids until the cluster fits; its price becomes the lowest kept bid
+        bool evicted = false;
+        while (m_clusterLoads[best] > capacity && !members[best].empty()) {
+            size_t loser = members[best].top().second;
+            members[best].pop();
+            m_clusterLoads[best] -= demands[loser];
+            m_labels[loser] = -1;
+            unassigned.push(loser);
+            evicted = true;
+        }
+        if (evicted && !members[best].empty()) {
+            prices[best] = std::max(prices[best], members[best].top().first);
+        }
+    }
 
-    while (changed && iter < iterations) {
-        // Assign clusters
-        changed = AssignClusters(locations);
+    std::vector<size_t> leftover;
+    while (!unassigned.empty()) {
+        leftover.push_back(unassigned.front());
+        unassigned.pop();
+    }
+    return leftover;
+}
 
-        // Update centroids
-        UpdateCentroids(locations);
+bool LocationClustering::RunBalancedClustering(const std::vector<float>& x, const std::vector<float>& y,
+    const std::vector<float>& demands, float capacity, int iterations)
+{
+    if (x.empty() || x.size() != y.size() || x.size() != demands.size() || m_numClusters <= 0 || capacity <= 0.0f) {
+        std::cerr << "Cannot run balanced clustering of " << x.size() << " points with capacity " << capacity << std::endl;
+        return false;
+    }
 
-        iter++;
+    float largest = *std::max_element(demands.begin(), demands.end());
+    if (largest > capacity) {
+        std::cerr << "A point's demand of " << largest << " exceeds the capacity of " << capacity << std::endl;
+        return false;
     }
 
-    std::cout << "K-means clustering completed after " << iter << " iterations" << std::endl;
+    const size_t count = x.size();
+    m_pointX = x;
+    m_pointY = y;
+    m_pointWeights.assign(count, 1.0f);
+    m_labels.assign(count, -1);
+    m_pointNames.clear();
+    m_clusterAssignments.clear();
 
-    // Print cluster assignments
-    for (int i = 0; i < m_numClusters; i++) {
-        std::cout << "Cluster " << i << ": ";
-        for (const auto& pair : m_clusterAssignments) {
-            if (pair.second == i) {
-                std::cout << pair.first << " ";
+    // Enough clusters for the total demand to fit, if the demands pack well
+    double totalDemand = std::accumulate(demands.begin(), demands.end(), 0.0);
+    int k = std::max(m_numClusters, static_cast<int>(std::ceil(totalDemand / capacity)));
+    InitializeCentroids(static_cast<int>(std::min<size_t>(k, count)));
+
+    std::vector<int> previousLabels;
+    int iteration = 0;
+    while (iteration < iterations) {
+        iteration++;
+
+        std::vector<size_t> leftover = AssignWithCapacity(demands, capacity);
+
+        // Repair: points the auction could not place go to the nearest cluster with
+        // room, or open a new cluster of their own
+        for (size_t i : leftover) {
+            int best = -1;
+            float bestDistance = std::numeric_limits<float>::max();
+            for (int c = 0; c < static_cast<int>(m_centroidX.size()); c++) {
+                float dx = m_pointX[i] - m_centroidX[c];
+                float dy = m_pointY[i] - m_centroidY[c];
+                float distance = dx * dx + dy * dy;
+                if (m_clusterLoads[c] + demands[i] <= capacity && distance < bestDistance) {
+                    bestDistance = distance;
+                    best = c;
+                }
+            }
+
+            if (best < 0) {
+                best = static_cast<int>(m_centroidX.size());
+                m_centroidX.push_back(m_pointX[i]);
+                m_centroidY.push_back(m_pointY[i]);
+                m_clusterLoads.push_back(0.0f);
             }
+
+            m_labels[i] = best;
+            m_clusterLoads[best] += demands[i];
+        }
+
+        // Move the centroids to the means of their members
+        const int numClusters = static_cast<int>(m_centroidX.size());
+        m_clusterSumX.assign(numClusters, 0.0);
+        m_clusterSumY.assign(numClusters, 0.0);
+        m_clusterWeights.assign(numClusters, 0.0);
+        for (size_t i = 0; i < count; i++) {
+            AccumulatePoint(i, m_labels[i], 1.0);
+        }
+        UpdateCentroidsFromSums();
+
+        if (m_labels == previousLabels) {
+            break;
+        }
+        previousLabels = m_labels;
+    }
+
+    m_inertia = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        float dx = m_pointX[i] - m_centroidX[m_labels[i]];
+        float dy = m_pointY[i] - m_centroidY[m_labels[i]];
+        m_inertia += dx * dx + dy * dy;
+    }
+    m_lastIterations = iteration;
+
+    std::cout << "Balanced clustering completed after " << iteration << " iterations with "
+        << m_centroidX.size() << " clusters" << std::endl;
+
+    return true;
+}
+
+bool LocationClustering::RunBalancedClustering(const std::vector<WasteLocation>& locations, float capacity, int iterations)
+{
+    std::vector<float> x, y, wasteLevels;
+    std::vector<std::string> names;
+    GatherLocationPoints(locations, x, y, wasteLevels, names);
+
+    if (!RunBalancedClustering(x, y, wasteLevels, capacity, iterations)) {
+        return false;
+    }
+
+    PublishLocationAssignments(names);
+    return true;
+}
+
+bool LocationClustering::RunDensityClustering(const std::vector<float>& x, const std::vector<float>& y,
+    float radius, int minPoints)
+{
+    if (x.empty() || x.size() != y.size() || radius <= 0.0f || minPoints <= 0) {
+        std::cerr << "Cannot run density clustering of " << x.size() << " points with radius " << radius
+            << " and " << minPoints << " minimum points" << std::endl;
+        return false;
+    }
+
+    const size_t count = x.size();
+    const float radiusSquared = radius * radius;
+    m_pointX = x;
+    m_pointY = y;
+    m_pointWeights.assign(count, 1.0f);
+    m_labels.assign(count, -1);
+    m_pointNames.clear();
+    m_clusterAssignments.clear();
+    m_clusterLoads.clear();
+
+    PointGrid grid;
+    grid.Build(x, y, radius);
+    const size_t numCells = grid.cellKeys.size();
+    const size_t CellsPerChunk = 64;
+    ThreadPool& pool = ThreadPool::Shared();
+
+    // Non-empty cells around every cell, looked up once
+    std::vector<size_t> neighborCells(numCells * 9);
+    std::vector<int> numNeighborCells(numCells);
+    pool.ParallelFor(numCells, CellsPerChunk, [&](size_t, size_t begin, size_t end) {
+        for (size_t cell = begin; cell < end; cell++) {
+            numNeighborCells[cell] = grid.GetNeighborCells(cell, &neighborCells[cell * 9]);
+        }
+        });
+
+    // The phases below work on positions in cell order rather than point indices.
+    // Calls visit(q, distanceSquared) for every position q within the radius of position p
+    // (including p itself), which lies in cell; stops early when visit returns false
+    const float* sortedX = grid.sortedX.data();
+    const float* sortedY = grid.sortedY.data();
+    auto forEachNearby = [&](size_t cell, size_t p, auto&& visit) {
+        const size_t* neighbors = &neighborCells[cell * 9];
+        for (int n = 0; n < numNeighborCells[cell]; n++) {
+            for (size_t q = grid.cellStart[neighbors[n]]; q < grid.cellStart[neighbors[n] + 1]; q++) {
+                float dx = sortedX[q] - sortedX[p];
+                float dy = sortedY[q] - sortedY[p];
+                float distanceSquared = dx * dx + dy * dy;
+                if (distanceSquared <= radiusSquared && !visit(q, distanceSquared)) {
+                    return;
+                }
+            }
+        }
+    };
+
+    // Core points have at least minPoints points (themselves included) within the radius
+    std::vector<unsigned char> core(count, 0);
+    pool.ParallelFor(numCells, CellsPerChunk, [&](size_t, size_t begin, size_t end) {
+        for (size_t cell = begin; cell < end; cell++) {
+            for (size_t p = grid.cellStart[cell]; p < grid.cellStart[cell + 1]; p++) {
+                int found = 0;
+                forEachNearby(cell, p, [&](size_t, float) { return ++found < minPoints; });
+                core[p] = found >= minPoints;
+            }
+        }
+        });
+
+    // Join core points within the radius of each other
+    std::unique_ptr<std::atomic<int>[]> parents(new std::atomic<int>[count]);
+    for (size_t p = 0; p < count; p++) {
+        parents[p].store(static_cast<int>(p), std::memory_order_relaxed);
+    }
+
+    pool.ParallelFor(numCells, CellsPerChunk, [&](size_t, size_t begin, size_t end) {
+        for (size_t cell = begin; cell < end; cell++) {
+            for (size_t p = grid.cellStart[cell]; p < grid.cellStart[cell + 1]; p++) {
+                if (!core[p]) {
+                    continue;
+                }
+
+                // Each pair is joined from its lower position only
+                forEachNearby(cell, p, [&](size_t q, float) {
+                    if (q > p && core[q]) {
+                        UnionRoots(parents.get(), static_cast<int>(p), static_cast<int>(q));
+                    }
+                    return true;
+                    });
+            }
+        }
+        });
+
+    // Border points join the cluster of their nearest core point; the rest is noise
+    std::vector<int> roots(count, -1);
+    pool.ParallelFor(numCells, CellsPerChunk, [&](size_t, size_t begin, size_t end) {
+        for (size_t cell = begin; cell < end; cell++) {
+            for (size_t p = grid.cellStart[cell]; p < grid.cellStart[cell + 1]; p++) {
+                size_t i = grid.order[p];
+                if (core[p]) {
+                    roots[i] = FindRoot(parents.get(), static_cast<int>(p));
+                    continue;
+                }
+
+                size_t nearest = count;
+                float nearestDistance = std::numeric_limits<float>::max();
+                forEachNearby(cell, p, [&](size_t q, float distanceSquared) {
+                    if (core[q] && distanceSquared < nearestDistance) {
+                        nearestDistance = distanceSquared;
+                        nearest = q;
+                    }
+                    return true;
+                    });
+
+                if (nearest < count) {
+                    roots[i] = FindRoot(parents.get(), static_cast<int>(nearest));
+                }
+            }
+        }
+        });
+
+    // Number the clusters in order of their first point
+    std::vector<int> clusterOfRoot(count, -1);
+    int numClusters = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (roots[i] < 0) {
+            continue;
+        }
+        if (clusterOfRoot[roots[i]] < 0) {
+            clusterOfRoot[roots[i]] = numClusters++;
+        }
+        m_labels[i] = clusterOfRoot[roots[i]];
+    }
+
+    // Centroids and inertia of the clusters; noise points belong to none
+    m_centroidX.assign(numClusters, 0.0f);
+    m_centroidY.assign(numClusters, 0.0f);
+    m_clusterSumX.assign(numClusters, 0.0);
+    m_clusterSumY.assign(numClusters, 0.0);
+    m_clusterWeights.assign(numClusters, 0.0);
+    size_t noise = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (m_labels[i] >= 0) {
+            AccumulatePoint(i, m_labels[i], 1.0);
+        }
+        else {
+            noise++;
+        }
+    }
+    UpdateCentroidsFromSums();
+
+    m_inertia = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        if (m_labels[i] >= 0) {
+            float dx = x[i] - m_centroidX[m_labels[i]];
+            float dy = y[i] - m_centroidY[m_labels[i]];
+            m_inertia += dx * dx + dy * dy;
+        }
+    }
+    m_lastIterations = 1;
+
+    std::cout << "Density clustering found " << numClusters << " clusters and " << noise
+        << " noise points" << std::endl;
+
+    return true;
+}
+
+bool LocationClustering::RunDensityClustering(const std::vector<WasteLocation>& locations, float radius, int minPoints)
+{
+    std::vector<float> x, y, wasteLevels;
+    std::vector<std::string> names;
+    GatherLocationPoints(locations, x, y, wasteLevels, names);
+
+    if (!RunDensityClustering(x, y, radius, minPoints)) {
+        return false;
+    }
+
+    PublishLocationAssignments(names);
+    return true;
+}
+
+ClusterCountSweep LocationClustering::SweepClusterCounts(int minClusters, int maxClusters, size_t silhouetteSamples)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+
+    ClusterCountSweep sweep;
+    const size_t count = m_pointX.size();
+    minClusters = std::max(minClusters, 1);
+    maxClusters = static_cast<int>(std::min<size_t>(std::max(maxClusters, minClusters), count));
+    if (count == 0 || minClusters > maxClusters) {
+        std::cerr << "Cannot sweep cluster counts without points to cluster" << std::endl;
+        m_lastSweep = sweep;
+        return sweep;
+    }
+
+    // Same silhouette sample for every count
+    std::vector<size_t> sample(count);
+    std::iota(sample.begin(), sample.end(), static_cast<size_t>(0));
+    size_t numSamples = std::min(count, std::max<size_t>(2, silhouetteSamples));
+    for (size_t n = 0; n < numSamples; n++) {
+        std::uniform_int_distribution<size_t> pick(n, count - 1);
+        std::swap(sample[n], sample[pick(m_rng)]);
+    }
+    sample.resize(numSamples);
+
+    // Seeds are drawn up front so the result does not depend on the order tasks run in
+    const int numCounts = maxClusters - minClusters + 1;
+    std::vector<unsigned int> seeds(numCounts);
+    for (auto& seed : seeds) {
+        seed = m_rng();
+    }
+
+    sweep.scores.resize(numCounts);
+    ThreadPool::Shared().ParallelFor(numCounts, 1, [&](size_t index, size_t, size_t) {
+        int k = minClusters + static_cast<int>(index);
+
+        LocationClustering clustering(k);
+        clustering.SetRandomSeed(seeds[index]);
+        clustering.SetTolerance(m_tolerance);
+        clustering.m_pointX = m_pointX;
+        clustering.m_pointY = m_pointY;
+        clustering.m_pointWeights.assign(count, 1.0f);
+        clustering.InitializeCentroids(k);
+        clustering.RunHamerly(m_maxIterations);
+
+        // Sampled points sorted by cluster, so each cluster is one contiguous run
+        std::vector<size_t> clusterStart(k + 1, 0);
+        for (size_t i : sample) {
+            clusterStart[clustering.m_labels[i] + 1]++;
+        }
+        for (int c = 0; c < k; c++) {
+            clusterStart[c + 1] += clusterStart[c];
+        }
+
+        std::vector<float> sampleX(numSamples), sampleY(numSamples);
+        std::vector<size_t> next(clusterStart.begin(), clusterStart.end() - 1);
+        for (size_t i : sample) {
+            size_t slot = next[clustering.m_labels[i]]++;
+            sampleX[slot] = m_pointX[i];
+            sampleY[slot] = m_pointY[i];
+        }
+
+        ClusterCountScore& score = sweep.scores[index];
+        score.numClusters = k;
+        score.inertia = clustering.m_inertia;
+        score.silhouette = MeanSilhouette(sampleX, sampleY, clusterStart);
+        });
+
+    // Elbow (Kneedle): with both axes scaled to [0, 1], the knee is the count whose
+    // inertia has dropped the most beyond a straight line between the ends
+    double firstInertia = sweep.scores.front().inertia;
+    double lastInertia = sweep.scores.back().inertia;
+    double bestGap = -std::numeric_limits<double>::max();
+    double bestSilhouette = -std::numeric_limits<double>::max();
+
+    for (int n = 0; n < numCounts; n++) {
+        const ClusterCountScore& score = sweep.scores[n];
+        double scaledCount = numCounts > 1 ? static_cast<double>(n) / (numCounts - 1) : 0.0;
+        double scaledDrop = firstInertia > lastInertia ? (firstInertia - score.inertia) / (firstInertia - lastInertia) : 0.0;
+
+        if (scaledDrop - scaledCount > bestGap) {
+            bestGap = scaledDrop - scaledCount;
+            sweep.elbowClusters = score.numClusters;
+        }
+        if (score.numClusters > 1 && score.silhouette > bestSilhouette) {
+            bestSilhouette = score.silhouette;
+            sweep.bestSilhouetteClusters = score.numClusters;
+        }
+    }
+
+    sweep.milliseconds = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - start).count();
+    m_lastSweep = sweep;
+    return sweep;
+}
+
+bool LocationClustering::RunAutoClustering(int minClusters, int maxClusters)
+{
+    const ClusterCountSweep& sweep = SweepClusterCounts(minClusters, maxClusters);
+    if (sweep.scores.empty()) {
+        return false;
+    }
+
+    std::cout << "Cluster count sweep took " << sweep.milliseconds << " ms, elbow at "
+        << sweep.elbowClusters << " clusters" << std::endl;
+
+    // Recluster the same points with the chosen count, keeping their location names
+    std::vector<float> x = m_pointX;
+    std::vector<float> y = m_pointY;
+    std::vector<std::string> names = m_pointNames;
+
+    SetNumClusters(sweep.elbowClusters);
+    if (!RunClustering(x, y)) {
+        return false;
+    }
+
+    if (!names.empty()) {
+        PublishLocationAssignments(names);
+    }
+    return true;
+}
+
+const ClusterCountSweep& LocationClustering::GetLastSweep() const
+{
+    return m_lastSweep;
+}
+
+const std::vector<float>& LocationClustering::GetClusterLoads() const
+{
+    return m_clusterLoads;
+}
+
+void LocationClustering::AccumulatePoint(size_t index, int label, double sign)
+{
+    double weight = sign * m_pointWeights[index];
+    m_clusterSumX[label] += weight * m_pointX[index];
+    m_clusterSumY[label] += weight * m_pointY[index];
+    m_clusterWeights[label] += weight;
+}
+
+void LocationClustering::SetPointLabel(size_t index, int label)
+{
+    m_labels[index] = label;
+    if (index < m_pointNames.size()) {
+        m_clusterAssignments[m_pointNames[index]] = label;
+    }
+}
+
+void LocationClustering::UpdateCentroidsFromSums()
+{
+    for (size_t c = 0; c < m_centroidX.size(); c++) {
+        if (m_clusterWeights[c] > MinClusterWeight) {
+            m_centroidX[c] = static_cast<float>(m_clusterSumX[c] / m_clusterWeights[c]);
+            m_centroidY[c] = static_cast<float>(m_clusterSumY[c] / m_clusterWeights[c]);
         }
-        std::cout << std::endl;
     }
+    PublishCentroids();
+}
 
+size_t LocationClustering::AssignMiniBatch(const std::vector<size_t>& indices)
+{
+    const int k = static_cast<int>(m_centroidX.size());
+    std::vector<int> nearest(indices.size());
+
+    // Nearest centroids of the whole batch, measured against the centroids at the batch start
+    ThreadPool::Shared().ParallelFor(indices.size(), PointsPerChunk, [&](size_t, size_t begin, size_t end) {
+        float nearestSquared, secondSquared;
+        for (size_t b = begin; b < end; b++) {
+            size_t i = indices[b];
+            nearest[b] = NearestTwoCentroids(m_pointX[i], m_pointY[i], m_centroidX.data(), m_centroidY.data(), k,
+                nearestSquared, secondSquared);
+        }
+        });
+
+    // Move the points between the cluster sums in batch order, then move the centroids once
+    size_t changed = 0;
+    for (size_t b = 0; b < indices.size(); b++) {
+        size_t i = indices[b];
+        int label = m_labels[i];
+        if (label == nearest[b]) {
+            continue;
+        }
+
+        if (label >= 0) {
+            AccumulatePoint(i, label, -1.0);
+        }
+        AccumulatePoint(i, nearest[b], 1.0);
+        SetPointLabel(i, nearest[b]);
+        changed++;
+    }
+
+    UpdateCentroidsFromSums();
+    return changed;
+}
+
+bool LocationClustering::AddPoints(const std::vector<float>& x, const std::vector<float>& y,
+    const std::vector<float>& weights)
+{
+    if (x.size() != y.size() || (!weights.empty() && weights.size() != x.size())) {
+        std::cerr << "Cannot add points: coordinate and weight counts do not match" << std::endl;
+        return false;
+    }
+
+    if (m_centroidX.empty() && m_numClusters <= 0) {
+        std::cerr << "Cannot cluster into " << m_numClusters << " clusters" << std::endl;
+        return false;
+    }
+
+    size_t first = m_pointX.size();
+    m_pointX.insert(m_pointX.end(), x.begin(), x.end());
+    m_pointY.insert(m_pointY.end(), y.begin(), y.end());
+    if (weights.empty()) {
+        m_pointWeights.resize(m_pointX.size(), 1.0f);
+    }
+    else {
+        m_pointWeights.insert(m_pointWeights.end(), weights.begin(), weights.end());
+    }
+    m_labels.resize(m_pointX.size(), -1);
+
+    if (m_pointX.empty()) {
+        return true;
+    }
+
+    // Nothing to warm-start from yet: cluster everything collected so far
+    if (m_centroidX.empty()) {
+        int k = static_cast<int>(std::min<size_t>(m_numClusters, m_pointX.size()));
+        InitializeCentroids(k);
+        m_lastIterations = RunHamerly(m_maxIterations);
+        PublishCentroids();
+        return true;
+    }
+
+    std::vector<size_t> batch(x.size());
+    std::iota(batch.begin(), batch.end(), first);
+    AssignMiniBatch(batch);
+    return true;
+}
+
+bool LocationClustering::UpdatePoint(size_t index, float x, float y, float weight)
+{
+    if (index >= m_pointX.size() || m_centroidX.empty()) {
+        std::cerr << "Cannot update point " << index << ": no such clustered point" << std::endl;
+        return false;
+    }
+
+    // Take the old position and weight out of its cluster before changing them
+    if (m_labels[index] >= 0) {
+        AccumulatePoint(index, m_labels[index], -1.0);
+    }
+    m_pointX[index] = x;
+    m_pointY[index] = y;
+    m_pointWeights[index] = weight;
+
+    float nearestSquared, secondSquared;
+    int label = NearestTwoCentroids(x, y, m_centroidX.data(), m_centroidY.data(),
+        static_cast<int>(m_centroidX.size()), nearestSquared, secondSquared);
+    AccumulatePoint(index, label, 1.0);
+    SetPointLabel(index, label);
+
+    UpdateCentroidsFromSums();
     return true;
 }
 
+size_t LocationClustering::RunMiniBatch(size_t batchSize, int iterations)
+{
+    const size_t count = m_pointX.size();
+    if (count == 0 || m_centroidX.empty()) {
+        return 0;
+    }
+
+    std::vector<size_t> batch;
+    std::uniform_int_distribution<size_t> pick(0, count - 1);
+    size_t changed = 0;
+
+    for (int iteration = 0; iteration < iterations; iteration++) {
+        // A batch covering every point is one full Lloyd step
+        if (batchSize >= count) {
+            batch.resize(count);
+            std::iota(batch.begin(), batch.end(), static_cast<size_t>(0));
+        }
+        else {
+            batch.resize(batchSize);
+            for (size_t& index : batch) {
+                index = pick(m_rng);
+            }
+        }
+
+        changed += AssignMiniBatch(batch);
+    }
+
+    return changed;
+}
+
+bool LocationClustering::RefineClustering(int iterations)
+{
+    if (m_pointX.empty() || m_centroidX.empty()) {
+        std::cerr << "Cannot refine clustering: no previous clustering to start from" << std::endl;
+        return false;
+    }
+
+    m_lastIterations = RunHamerly(iterations);
+    PublishCentroids();
+
+    for (size_t i = 0; i < m_pointNames.size(); i++) {
+        m_clusterAssignments[m_pointNames[i]] = m_labels[i];
+    }
+
+    return true;
+}
+
+bool LocationClustering::RestoreClustering(const float* x, const float* y, const int* labels, size_t count,
+    int numClusters)
+{
+    if (numClusters <= 0) {
+        std::cerr << "Cannot restore clustering: no clusters" << std::endl;
+        return false;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (labels[i] < -1 || labels[i] >= numClusters) {
+            std::cerr << "Cannot restore clustering: invalid label " << labels[i] << std::endl;
+            return false;
+        }
+    }
+
+    m_pointX.assign(x, x + count);
+    m_pointY.assign(y, y + count);
+    m_labels.assign(labels, labels + count);
+    m_pointWeights.assign(count, 1.0f);
+    m_pointNames.clear();
+    m_clusterAssignments.clear();
+    m_clusterLoads.clear();
+    m_numClusters = numClusters;
+
+    // Per-chunk cluster sums, added up in chunk order
+    ThreadPool& pool = ThreadPool::Shared();
+    const size_t numChunks = ThreadPool::GetChunkCount(count, PointsPerChunk);
+    const int k = numClusters;
+    std::vector<double> chunkSums(numChunks * k * 3, 0.0);
+    pool.ParallelFor(count, PointsPerChunk, [&](size_t chunk, size_t begin, size_t end) {
+        double* sums = chunkSums.data() + chunk * k * 3;
+        for (size_t i = begin; i < end; i++) {
+            if (labels[i] >= 0) {
+                sums[labels[i] * 3] += x[i];
+                sums[labels[i] * 3 + 1] += y[i];
+                sums[labels[i] * 3 + 2] += 1.0;
+            }
+        }
+        });
+
+    m_centroidX.assign(k, 0.0f);
+    m_centroidY.assign(k, 0.0f);
+    m_clusterSumX.assign(k, 0.0);
+    m_clusterSumY.assign(k, 0.0);
+    m_clusterWeights.assign(k, 0.0);
+    for (size_t chunk = 0; chunk < numChunks; chunk++) {
+        for (int c = 0; c < k; c++) {
+            m_clusterSumX[c] += chunkSums[(chunk * k + c) * 3];
+            m_clusterSumY[c] += chunkSums[(chunk * k + c) * 3 + 1];
+            m_clusterWeights[c] += chunkSums[(chunk * k + c) * 3 + 2];
+        }
+    }
+    UpdateCentroidsFromSums();
+
+    std::vector<double> chunkInertia(numChunks, 0.0);
+    pool.ParallelFor(count, PointsPerChunk, [&](size_t chunk, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            if (labels[i] >= 0) {
+                float dx = x[i] - m_centroidX[labels[i]];
+                float dy = y[i] - m_centroidY[labels[i]];
+                chunkInertia[chunk] += dx * dx + dy * dy;
+            }
+        }
+        });
+    m_inertia = std::accumulate(chunkInertia.begin(), chunkInertia.end(), 0.0);
+    m_lastIterations = 0;
+
+    return true;
+}
+
+const std::vector<int>& LocationClustering::GetLabels() const
+{
+    return m_labels;
+}
+
+double LocationClustering::GetInertia() const
+{
+    return m_inertia;
+}
+
+int LocationClustering::GetLastIterations() const
+{
+    return m_lastIterations;
+}
+
+void LocationClustering::SetTolerance(float tolerance)
+{
+    m_tolerance = std::max(0.0f, tolerance);
+}
+
+void LocationClustering::SetRandomSeed(unsigned int seed)
+{
+    m_rng.seed(seed);
+}
+
 int LocationClustering::GetClusterForLocation(const std::string& locationName) const
 {
     // Return -1 if location not found
@@ -285,7 +1682,7 @@ void LocationClustering::SetWasteLevelWeight(float weight)
 
 std::pair<float, float> LocationClustering::GetClusterCentroid(int clusterId) const
 {
-    if (clusterId >= 0 && clusterId < m_numClusters) {
+    if (clusterId >= 0 && clusterId < static_cast<int>(m_centroids.size())) {
         return m_centroids[clusterId];
     }
 
@@ -6,6 +6,26 @@
 #include <vector>
 #include <unordered_map>
 #include <string>
+#include <random>
+
+/**
+ * @brief Clustering quality of one number of clusters in a sweep
+ */
+struct ClusterCountScore {
+    int numClusters = 0;      // Number of clusters
+    double inertia = 0.0;     // Sum of squared distances to the centroids
+    double silhouette = 0.0;  // Mean silhouette of the sampled points (-1 to 1, higher is better)
+};
+
+/**
+ * @brief Result of sweeping the number of clusters
+ */
+struct ClusterCountSweep {
+    std::vector<ClusterCountScore> scores;  // One entry per tried number of clusters, ascending
+    int elbowClusters = 0;                  // Number of clusters at the knee of the inertia curve
+    int bestSilhouetteClusters = 0;         // Number of clusters with the highest silhouette
+    double milliseconds = 0.0;              // Wall time of the sweep
+};
 
 /**
  * @brief AI component for clustering waste locations
@@ -13,6 +33,27 @@
  * This class implements a K-means clustering algorithm to group waste
  * locations based on proximity and waste levels, allowing for more
  * efficient collection routes.
+ *
+ * Points are kept in contiguous coordinate arrays with integer cluster labels.
+ * Centroids are seeded with K-means++ and refined with Hamerly's algorithm, which
+ * keeps an upper bound on each point's distance to its own centroid and a lower
+ * bound on the distance to every other centroid. Points whose bounds prove their
+ * label cannot change are skipped, so later iterations touch only a few points.
+ *
+ * For continuously arriving data the clustering can also be maintained in place:
+ * weighted coordinate sums are kept per cluster, so adding, moving or reweighting
+ * a point only moves the centroids it touches, and mini-batch steps refine the
+ * zones from the previous centroids instead of seeding them again.
+ *
+ * The balanced mode caps the total waste of every cluster at a truck's capacity.
+ * Its assignment step is an auction: clusters raise a price per unit of waste when
+ * they are overfull, so points move to their next best cluster only when that costs
+ * the least extra distance. Points the auction cannot place are repaired greedily.
+ *
+ * The density mode (DBSCAN) needs no cluster count: points with enough neighbours
+ * within a radius form clusters of any shape, and isolated points are left out as
+ * noise with label -1. Neighbours are found through a uniform grid of radius-sized
+ * cells, and the cells are processed in parallel.
  */
 class LocationClustering {
 private:
@@ -27,6 +68,44 @@ private:
     // Cluster centroids (x, y coordinates)
     std::vector<std::pair<float, float>> m_centroids;
 
+    // Points of the last clustering run and their integer labels
+    std::vector<float> m_pointX;
+    std::vector<float> m_pointY;
+    std::vector<int> m_labels;
+    std::vector<float> m_pointWeights;        // Weight per point (1 unless set by streaming updates)
+    std::vector<std::string> m_pointNames;    // Location name per point when clustering locations
+
+    // Centroids as separate coordinate arrays for the distance loops
+    std::vector<float> m_centroidX;
+    std::vector<float> m_centroidY;
+
+    // Weighted coordinate sums and total weight per cluster, kept in step with the labels
+    std::vector<double> m_clusterSumX;
+    std::vector<double> m_clusterSumY;
+    std::vector<double> m_clusterWeights;
+
+    // Total demand per cluster of the last balanced run
+    std::vector<float> m_clusterLoads;
+
+    // Result of the last cluster count sweep
+    ClusterCountSweep m_lastSweep;
+
+    // Hamerly bounds per point
+    std::vector<float> m_upperBounds;   // Distance to the assigned centroid or more
+    std::vector<float> m_lowerBounds;   // Distance to any other centroid or less
+
+    // Other centroids of each centroid sorted by distance, (k - 1) entries per centroid.
+    // A point closer to its centroid a than d(a, c) / 2 cannot be closer to c, so
+    // reassignment scans stop early instead of testing every centroid.
+    std::vector<float> m_neighborDistances;
+    std::vector<int> m_neighborIds;
+
+    // Result statistics of the last run
+    int m_lastIterations;
+    double m_inertia;
+
+    std::mt19937 m_rng;
+
     // Distance weights for clustering
     float m_distanceWeight;
     float m_wasteLevelWeight;
@@ -34,16 +113,54 @@ private:
     // Maximum iterations for K-means
     int m_maxIterations;
 
+    // Stop once the squared centroid shifts add up to less than this fraction of the point variance
+    float m_tolerance;
+
     // Helper functions
 
-    // Initialized centroids using K-means++ algorithm
-    void InitializeCentroids(const std::vector<WasteLocation>& locations, int k);
+    // Initialize centroids using K-means++ algorithm
+    void InitializeCentroids(int k);
+
+    // Find the nearest and second nearest centroid of a point
+    int FindNearestTwo(float x, float y, float& nearestDistance, float& secondDistance) const;
+
+    // Sort each centroid's neighbours by distance
+    void SortCentroidNeighbors();
+
+    // Find the nearest and second nearest centroid of a point assigned to label, scanning
+    // the label's neighbours outwards; labelDistance is the point's distance to label
+    int FindNearestTwoFrom(float x, float y, int label, float labelDistance,
+        float& nearestDistance, float& secondDistance) const;
+
+    // Run Hamerly's K-means from the current centroids; returns the number of iterations
+    int RunHamerly(int maxIterations);
+
+    // Copy the centroid arrays to the (x, y) pairs returned by the getters
+    void PublishCentroids();
 
-    // Assign locations to nearest centroid
-    bool AssignClusters(const std::vector<WasteLocation>& locations);
+    // Collect the coordinates, waste levels and names of the locations, skipping the station
+    void GatherLocationPoints(const std::vector<WasteLocation>& locations, std::vector<float>& x,
+        std::vector<float>& y, std::vector<float>& wasteLevels, std::vector<std::string>& names) const;
 
-    // Update centroid positions
-    void UpdateCentroids(const std::vector<WasteLocation>& locations);
+    // Store the location names of the points and their name-keyed assignments
+    void PublishLocationAssignments(const std::vector<std::string>& names);
+
+    // Assign points to the current centroids without exceeding the capacity of any cluster;
+    // returns the points that could not be placed
+    std::vector<size_t> AssignWithCapacity(const std::vector<float>& demands, float capacity);
+
+    // Add (sign = 1) or remove (sign = -1) a point's weighted coordinates to a cluster's sums
+    void AccumulatePoint(size_t index, int label, double sign);
+
+    // Set a point's label and its name-keyed assignment
+    void SetPointLabel(size_t index, int label);
+
+    // Move every non-empty centroid to the mean of its cluster sums
+    void UpdateCentroidsFromSums();
+
+    // Reassign a batch of points to their nearest centroids and update the centroids once;
+    // returns the number of points whose label changed
+    size_t AssignMiniBatch(const std::vector<size_t>& indices);
 
     // Calculate weighted distance between two locations
     float CalculateDistance(const WasteLocation& loc1, const WasteLocation& loc2);
@@ -81,6 +198,174 @@ public:
      */
     bool RunClustering(const std::vector<WasteLocation>& locations, int iterations = 100);
 
+    /**
+     * @brief Run K-means clustering on raw coordinates
+     * @param x X coordinate of every point
+     * @param y Y coordinate of every point
+     * @param iterations Maximum number of iterations
+     * @return True if clustering was successful
+     */
+    bool RunClustering(const std::vector<float>& x, const std::vector<float>& y, int iterations = 100);
+
+    /**
+     * @brief Run K-means with the total demand of every cluster capped at a capacity
+     *
+     * Uses at least as many clusters as needed for the total demand to fit, and opens
+     * more if the demands cannot be packed into those.
+     * @param x X coordinate of every point
+     * @param y Y coordinate of every point
+     * @param demands Demand of every point, no larger than the capacity
+     * @param capacity Maximum total demand of a cluster
+     * @param iterations Maximum number of iterations
+     * @return True if clustering was successful
+     */
+    bool RunBalancedClustering(const std::vector<float>& x, const std::vector<float>& y,
+        const std::vector<float>& demands, float capacity, int iterations = 20);
+
+    /**
+     * @brief Cluster waste locations so each cluster's waste fits in one truck
+     * @param locations Vector of waste locations
+     * @param capacity Truck capacity in bin percent (e.g. 200 = two full bins)
+     * @param iterations Maximum number of iterations
+     * @return True if clustering was successful
+     */
+    bool RunBalancedClustering(const std::vector<WasteLocation>& locations, float capacity, int iterations = 20);
+
+    /**
+     * @brief Run DBSCAN density clustering on raw coordinates
+     * @param x X coordinate of every point
+     * @param y Y coordinate of every point
+     * @param radius Neighbourhood radius
+     * @param minPoints Points within the radius (the point included) that make a core point
+     * @return True if clustering was successful
+     */
+    bool RunDensityClustering(const std::vector<float>& x, const std::vector<float>& y,
+        float radius, int minPoints = 4);
+
+    /**
+     * @brief Run DBSCAN density clustering on waste locations
+     * @param locations Vector of waste locations
+     * @param radius Neighbourhood radius in map units
+     * @param minPoints Locations within the radius (the location included) that make a core location
+     * @return True if clustering was successful; noise locations get cluster -1
+     */
+    bool RunDensityClustering(const std::vector<WasteLocation>& locations, float radius, int minPoints = 2);
+
+    /**
+     * @brief Cluster the current points with every number of clusters in a range
+     *
+     * Each count runs on its own thread pool task. The silhouette is computed on a
+     * fixed random sample of the points so every count is scored on the same subset.
+     * @param minClusters Smallest number of clusters
+     * @param maxClusters Largest number of clusters (capped at the number of points)
+     * @param silhouetteSamples Number of sampled points for the silhouette
+     * @return Scores per number of clusters with the elbow and best silhouette choices
+     */
+    ClusterCountSweep SweepClusterCounts(int minClusters, int maxClusters, size_t silhouetteSamples = 2000);
+
+    /**
+     * @brief Choose the number of clusters at the elbow of a sweep and recluster with it
+     * @param minClusters Smallest number of clusters
+     * @param maxClusters Largest number of clusters
+     * @return True if there were points to cluster
+     */
+    bool RunAutoClustering(int minClusters = 2, int maxClusters = 10);
+
+    /**
+     * @brief Get the result of the last cluster count sweep
+     * @return Last sweep, without scores if none ran yet
+     */
+    const ClusterCountSweep& GetLastSweep() const;
+
+    /**
+     * @brief Get the total demand of every cluster of the last balanced run
+     * @return Demand per cluster
+     */
+    const std::vector<float>& GetClusterLoads() const;
+
+    /**
+     * @brief Add points to the current clustering without starting over
+     *
+     * New points join their nearest centroid and the centroids move to the new cluster
+     * means. When there is no clustering yet, all points collected so far are clustered.
+     * @param x X coordinate of every new point
+     * @param y Y coordinate of every new point
+     * @param weights Weight of every new point (empty = all 1)
+     * @return True if the points were added
+     */
+    bool AddPoints(const std::vector<float>& x, const std::vector<float>& y,
+        const std::vector<float>& weights = std::vector<float>());
+
+    /**
+     * @brief Move or reweight a point and update the centroids it affects
+     * @param index Index of the point, in the order points were clustered or added
+     * @param x New X coordinate
+     * @param y New Y coordinate
+     * @param weight New weight (0 removes the point's influence on the centroids)
+     * @return True if the point exists and was updated
+     */
+    bool UpdatePoint(size_t index, float x, float y, float weight = 1.0f);
+
+    /**
+     * @brief Refine the current centroids with mini-batch K-means steps
+     * @param batchSize Number of randomly sampled points per step (all points if larger than the count)
+     * @param iterations Number of steps
+     * @return Number of label changes
+     */
+    size_t RunMiniBatch(size_t batchSize, int iterations = 1);
+
+    /**
+     * @brief Run full K-means iterations warm-started from the current centroids
+     * @param iterations Maximum number of iterations
+     * @return True if there was a clustering to refine
+     */
+    bool RefineClustering(int iterations = 100);
+
+    /**
+     * @brief Restore a saved clustering without running K-means
+     *
+     * Centroids are recomputed from the labels in one pass, so RefineClustering and
+     * RunMiniBatch can continue from the restored state. Points labelled -1 stay unclustered.
+     * @param x X coordinate of every point
+     * @param y Y coordinate of every point
+     * @param labels Cluster of every point, -1 or below numClusters
+     * @param count Number of points
+     * @param numClusters Number of clusters the labels refer to
+     * @return True if the labels were valid
+     */
+    bool RestoreClustering(const float* x, const float* y, const int* labels, size_t count, int numClusters);
+
+    /**
+     * @brief Get the cluster label of every point of the last run
+     * @return Cluster ID per point, in input order
+     */
+    const std::vector<int>& GetLabels() const;
+
+    /**
+     * @brief Get the sum of squared distances from points to their centroids
+     * @return Inertia of the last run
+     */
+    double GetInertia() const;
+
+    /**
+     * @brief Get the number of iterations of the last run
+     * @return Number of K-means iterations
+     */
+    int GetLastIterations() const;
+
+    /**
+     * @brief Set the convergence tolerance
+     * @param tolerance Stop when the summed squared centroid shift falls below this fraction
+     *                  of the mean coordinate variance (0 = run until no label changes)
+     */
+    void SetTolerance(float tolerance);
+
+    /**
+     * @brief Seed the random number generator used for K-means++ seeding
+     * @param seed Seed value
+     */
+    void SetRandomSeed(unsigned int seed);
+
     /**
      * @brief Get cluster assignment for a location
      * @param locationName Name of the location
@@ -0,0 +1,148 @@
+// ReplayBuffer.cpp
+// Implementation of the circular experience replay buffer
+#include "pch.h"
+#include "ReplayBuffer.h"
+
+ReplayBuffer::ReplayBuffer(size_t capacity, bool prioritized, float alpha, float beta)
+    : m_capacity(std::max<size_t>(1, capacity)),
+    m_size(0),
+    m_next(0),
+    m_prioritized(false),
+    m_alpha(alpha),
+    m_beta(beta),
+    m_maxPriority(1.0f),
+    m_treeLeaves(1)
+{
+    m_storage.resize(m_capacity);
+    SetPrioritized(prioritized);
+}
+
+void ReplayBuffer::Add(const Experience& experience)
+{
+    m_storage[m_next] = experience;
+
+    // New experiences get the highest priority so they are replayed at least once
+    if (m_prioritized) {
+        SetTreePriority(m_next, std::pow(m_maxPriority, m_alpha));
+    }
+
+    m_next = (m_next + 1) % m_capacity;
+    m_size = std::min(m_size + 1, m_capacity);
+}
+
+size_t ReplayBuffer::Sample(std::mt19937& rng, size_t batchSize, size_t* indices, float* weights) const
+{
+    if (m_size == 0) {
+        return 0;
+    }
+
+    if (!m_prioritized) {
+        std::uniform_int_distribution<size_t> dist(0, m_size - 1);
+        for (size_t i = 0; i < batchSize; i++) {
+            indices[i] = dist(rng);
+            weights[i] = 1.0f;
+        }
+        return batchSize;
+    }
+
+    // Stratified sampling: one draw from each equal slice of the total priority
+    const double total = m_sumTree[1];
+    const double segment = total / batchSize;
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+
+    float maxWeight = 0.0f;
+    for (size_t i = 0; i < batchSize; i++) {
+        size_t slot = FindTreeSlot(segment * (i + dist(rng)));
+        indices[i] = slot;
+
+        // w = (N * P(i))^-beta
+        double probability = m_sumTree[m_treeLeaves + slot] / total;
+        weights[i] = static_cast<float>(std::pow(m_size * probability, -static_cast<double>(m_beta)));
+        maxWeight = std::max(maxWeight, weights[i]);
+    }
+
+    // Normalize so updates are only ever scaled down
+    if (maxWeight > 0.0f) {
+        for (size_t i = 0; i < batchSize; i++) {
+            weights[i] /= maxWeight;
+        }
+    }
+
+    return batchSize;
+}
+
+void ReplayBuffer::UpdatePriority(size_t index, float tdError)
+{
+    if (!m_prioritized || index >= m_size) {
+        return;
+    }
+
+    // Small offset so no experience becomes impossible to sample
+    float priority = std::abs(tdError) + 1e-3f;
+    m_maxPriority = std::max(m_maxPriority, priority);
+
+    SetTreePriority(index, std::pow(priority, m_alpha));
+}
+
+void ReplayBuffer::Clear()
+{
+    m_size = 0;
+    m_next = 0;
+    m_maxPriority = 1.0f;
+    std::fill(m_sumTree.begin(), m_sumTree.end(), 0.0);
+}
+
+void ReplayBuffer::SetPrioritized(bool prioritized)
+{
+    m_prioritized = prioritized;
+
+    if (!m_prioritized) {
+        m_sumTree.clear();
+        m_sumTree.shrink_to_fit();
+        return;
+    }
+
+    m_treeLeaves = 1;
+    while (m_treeLeaves < m_capacity) {
+        m_treeLeaves *= 2;
+    }
+    m_sumTree.assign(2 * m_treeLeaves, 0.0);
+
+    // Stored experiences start with the highest priority
+    double priority = std::pow(m_maxPriority, m_alpha);
+    for (size_t i = 0; i < m_size; i++) {
+        m_sumTree[m_treeLeaves + i] = priority;
+    }
+    for (size_t node = m_treeLeaves - 1; node >= 1; node--) {
+        m_sumTree[node] = m_sumTree[2 * node] + m_sumTree[2 * node + 1];
+    }
+}
+
+void ReplayBuffer::SetTreePriority(size_t index, double priority)
+{
+    size_t node = m_treeLeaves + index;
+    m_sumTree[node] = priority;
+
+    // Recompute the sums instead of adding deltas so rounding errors cannot build up
+    for (node /= 2; node >= 1; node /= 2) {
+        m_sumTree[node] = m_sumTree[2 * node] + m_sumTree[2 * node + 1];
+    }
+}
+
+size_t ReplayBuffer::FindTreeSlot(double value) const
+{
+    size_t node = 1;
+    while (node < m_treeLeaves) {
+        size_t left = 2 * node;
+        if (value < m_sumTree[left] || m_sumTree[left + 1] <= 0.0) {
+            node = left;
+        }
+        else {
+            value -= m_sumTree[left];
+            node = left + 1;
+        }
+    }
+
+    // Rounding can land on an empty leaf past the stored experiences
+    return std::min(node - m_treeLeaves, m_size - 1);
+}
@@ -0,0 +1,104 @@
+// ReplayBuffer.h
+// This file defines a fixed-capacity experience replay buffer for reinforcement learning
+#pragma once
+
+#include <vector>
+#include <random>
+#include <cstdint>
+
+/**
+ * @brief One state transition of a route episode
+ *
+ * A state is the current location ID plus a bitmask of visited location IDs.
+ */
+struct Experience {
+    int currentLocation;        // Location the action was taken from
+    uint32_t visitedMask;       // Locations visited before the action
+    int action;                 // Location moved to
+    float reward;               // Reward received for the move
+    int nextLocation;           // Location after the move
+    uint32_t nextVisitedMask;   // Locations visited after the move
+    bool isDone;                // Whether the episode ended with this move
+};
+
+/**
+ * @brief Circular experience replay buffer with optional prioritized sampling
+ *
+ * Experiences are stored in one contiguous array and the oldest one is overwritten
+ * once the buffer is full. In prioritized mode a sum-tree over the priorities lets
+ * experiences be sampled in proportion to their last TD error in O(log n), with
+ * importance-sampling weights to correct for the bias.
+ */
+class ReplayBuffer {
+private:
+    /* Private members in ReplayBuffer class */
+    std::vector<Experience> m_storage;   // Experience slots
+    size_t m_capacity;                   // Maximum number of experiences
+    size_t m_size;                       // Number of stored experiences
+    size_t m_next;                       // Slot written next
+
+    // Prioritized replay
+    bool m_prioritized;                  // Whether sampling is proportional to priority
+    float m_alpha;                       // How strongly priorities skew sampling (0 = uniform)
+    float m_beta;                        // Strength of the importance-sampling correction
+    float m_maxPriority;                 // Priority given to new experiences
+    size_t m_treeLeaves;                 // Number of leaves of the sum-tree (power of two)
+    std::vector<double> m_sumTree;       // Sum-tree, node i has children 2i and 2i+1, leaves start at m_treeLeaves
+
+    // Set the priority of a slot and update the sums above it
+    void SetTreePriority(size_t index, double priority);
+
+    // Find the slot whose cumulative priority range contains value
+    size_t FindTreeSlot(double value) const;
+
+public:
+    /**
+     * @brief Constructor for ReplayBuffer
+     * @param capacity Maximum number of experiences
+     * @param prioritized Sample in proportion to the TD error instead of uniformly
+     * @param alpha Priority exponent used in prioritized mode
+     * @param beta Importance-sampling exponent used in prioritized mode
+     */
+    explicit ReplayBuffer(size_t capacity, bool prioritized = false, float alpha = 0.6f, float beta = 0.4f);
+
+    /**
+     * @brief Add an experience, overwriting the oldest one when the buffer is full
+     * @param experience Experience to store
+     */
+    void Add(const Experience& experience);
+
+    /**
+     * @brief Sample a batch of experiences without allocating memory
+     * @param rng Random number generator
+     * @param batchSize Number of experiences to sample
+     * @param[out] indices Receives batchSize slot indices
+     * @param[out] weights Receives batchSize importance-sampling weights (all 1 in uniform mode)
+     * @return Number of sampled experiences (0 if the buffer is empty)
+     */
+    size_t Sample(std::mt19937& rng, size_t batchSize, size_t* indices, float* weights) const;
+
+    /**
+     * @brief Update the priority of a sampled experience from its TD error
+     * @param index Slot index returned by Sample
+     * @param tdError TD error of the latest update of the experience
+     */
+    void UpdatePriority(size_t index, float tdError);
+
+    /**
+     * @brief Remove all experiences
+     */
+    void Clear();
+
+    /**
+     * @brief Switch between uniform and prioritized sampling
+     * @param prioritized True for prioritized sampling
+     */
+    void SetPrioritized(bool prioritized);
+
+    // Getters and setters
+    const Experience& Get(size_t index) const { return m_storage[index]; }
+    size_t Size() const { return m_size; }
+    size_t Capacity() const { return m_capacity; }
+    bool IsPrioritized() const { return m_prioritized; }
+    void SetBeta(float beta) { m_beta = beta; }
+};
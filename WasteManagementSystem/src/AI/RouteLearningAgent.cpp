@@ -2,13 +2,171 @@
 // Implementation of the reinforcement learning agent for route optimization
 #include "pch.h"
 #include "RouteLearningAgent.h"
+#include "../Utils/ThreadPool.h"
+#include "../Utils/MappedFile.h"
+#include "LocationClustering.h"
+#include <cstring>
+
+namespace {
+    // Binary model file layout (little-endian):
+    //   ModelFileHeader
+    //   record block of storedSize bytes, zero-run compressed if ModelFlagCompressed is set
+    //   numFeatureWeights floats with the weights of the feature-based policy (version 2)
+    // Uncompressed, the record block holds either every Q-value of the dense table
+    // (recordCount floats) or, with ModelFlagSparse, recordCount SparseRecords.
+    // The checksum covers the record block and the feature weights.
+    const char ModelMagic[4] = { 'R', 'L', 'Q', 'M' };
+    const uint16_t ModelVersion = 2;
+    const uint16_t MinModelVersion = 1;     // Version 1 files have no feature weights
+    const uint16_t ModelFlagSparse = 1;
+    const uint16_t ModelFlagCompressed = 2;
+
+    struct ModelFileHeader {
+        char magic[4];
+        uint16_t version;
+        uint16_t flags;
+        uint32_t numNodes;
+        int32_t numIterations;
+        uint64_t recordCount;
+        uint64_t storedSize;     // Size of the record block in the file
+        uint64_t rawSize;        // Size of the record block after decompression
+        uint32_t checksum;       // FNV-1a of the stored record block and the feature weights
+        uint32_t numFeatureWeights;
+    };
+    static_assert(sizeof(ModelFileHeader) == 48, "Model file header must have a fixed layout");
+
+    struct SparseRecord {
+        uint32_t index;          // Q-table index of the state-action pair
+        float value;
+    };
+    static_assert(sizeof(SparseRecord) == 8, "Sparse records must be fixed width");
+
+    // Zero runs shorter than this are cheaper to keep inside a literal run
+    const size_t MinZeroRun = 8;
+
+    uint32_t Fnv1a(const uint8_t* data, size_t size, uint32_t hash = 2166136261u)
+    {
+        for (size_t i = 0; i < size; i++) {
+            hash = (hash ^ data[i]) * 16777619u;
+        }
+        return hash;
+    }
+
+    void WriteVarint(std::vector<uint8_t>& out, uint64_t value)
+    {
+        while (value >= 0x80) {
+            out.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    bool ReadVarint(const uint8_t*& data, const uint8_t* end, uint64_t& value)
+    {
+        value = 0;
+        for (int shift = 0; shift < 64 && data < end; shift += 7) {
+            uint8_t byte = *data++;
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Encode bytes as (zero count, literal count, literal bytes) runs. Q-tables are
+    // mostly unexplored zeros, so this shrinks them well without a compression library.
+    std::vector<uint8_t> CompressZeroRuns(const std::vector<uint8_t>& raw)
+    {
+        std::vector<uint8_t> out;
+        size_t i = 0;
+        while (i < raw.size()) {
+            size_t zeroStart = i;
+            while (i < raw.size() && raw[i] == 0) {
+                i++;
+            }
+
+            // Literal run ends where the next long zero run starts
+            size_t literalStart = i;
+            size_t zeros = 0;
+            while (i < raw.size() && zeros < MinZeroRun) {
+                zeros = raw[i] == 0 ? zeros + 1 : 0;
+                i++;
+            }
+            if (zeros == MinZeroRun) {
+                i -= zeros;
+            }
+
+            WriteVarint(out, literalStart - zeroStart);
+            WriteVarint(out, i - literalStart);
+            out.insert(out.end(), raw.begin() + literalStart, raw.begin() + i);
+        }
+        return out;
+    }
+
+    bool DecompressZeroRuns(const uint8_t* data, size_t size, std::vector<uint8_t>& raw, size_t rawSize)
+    {
+        raw.assign(rawSize, 0);
+        const uint8_t* end = data + size;
+        size_t position = 0;
 
+        while (data < end) {
+            uint64_t zeros, literals;
+            if (!ReadVarint(data, end, zeros) || !ReadVarint(data, end, literals)) {
+                return false;
+            }
+            if (zeros > rawSize - position || literals > rawSize - position - zeros ||
+                literals > static_cast<uint64_t>(end - data)) {
+                return false;
+            }
+
+            position += static_cast<size_t>(zeros);
+            std::memcpy(raw.data() + position, data, static_cast<size_t>(literals));
+            position += static_cast<size_t>(literals);
+            data += literals;
+        }
+        return position == rawSize;
+    }
+}
+
+
+// Number of set bits in a location mask
+static int CountLocations(uint32_t mask)
+{
+    int count = 0;
+    while (mask) {
+        mask &= mask - 1;
+        count++;
+    }
+    return count;
+}
+
+// ID of the lowest location in a mask
+static int LowestLocation(uint32_t mask)
+{
+    int id = 0;
+    while (!(mask & 1u)) {
+        mask >>= 1;
+        id++;
+    }
+    return id;
+}
 
 RouteLearningAgent::RouteLearningAgent()
     : m_learningRate(0.1f),
     m_discountFactor(0.9f),
     m_explorationRate(0.3f),
-    m_numIterations(0)
+    m_numIterations(0),
+    m_qTableSize(0),
+    m_numNodes(0),
+    m_prioritizedReplay(false),
+    m_mainWorker(m_maxBufferSize, m_batchSize, false, std::random_device()()),
+    m_isTraining(false),
+    m_trainingCompleted(0),
+    m_trainingTotal(0),
+    m_useFeaturePolicy(false),
+    m_clustering(nullptr),
+    m_vehicleCapacity(1000.0f)
 {
     // Initialize random number generator
     std::random_device rd;
@@ -17,134 +175,164 @@ RouteLearningAgent::RouteLearningAgent()
 
 RouteLearningAgent::~RouteLearningAgent()
 {
+    // Background training still uses this agent
+    if (m_trainingTask.valid()) {
+        m_trainingTask.wait();
+    }
 }
 
 void RouteLearningAgent::Initialize()
 {
-    // Initialize Q-table with zeros
-    for (int i = 0; i < 8; i++) {
-        for (int j = 0; j < 8; j++) {
-            // Skip if no direct path
-            if (WasteLocation::map_distance_matrix[i][j] >= INF) {
-                continue;
-            }
+    if (IsTraining()) {
+        std::cerr << "Cannot reinitialize the route learning agent while it is training" << std::endl;
+        return;
+    }
 
-            // Create a state with only location i visited
-            std::vector<int> visited = { i };
-            std::string state = EncodeState(visited, i);
+    m_numNodes = static_cast<int>(WasteLocation::dict_Id_to_Name.size());
+    if (m_numNodes > m_maxNodes) {
+        std::cout << "Q-table supports at most " << m_maxNodes << " locations, got " << m_numNodes
+            << "; using the feature-based policy" << std::endl;
+        m_numNodes = 0;
+        m_useFeaturePolicy = true;
+    }
 
-            // Initialize Q-value for action j
-            m_qTable[state][j] = 0.0f;
-        }
+    // Initialize Q-table with zeros for every (visited set, location, action)
+    m_qTableSize = m_numNodes > 0 ? (static_cast<size_t>(1) << m_numNodes) * m_numNodes * m_numNodes : 0;
+    m_qTable = std::make_unique<std::atomic<float>[]>(m_qTableSize);
+    for (size_t i = 0; i < m_qTableSize; i++) {
+        StoreQ(i, 0.0f);
     }
 
-    // Clear experience buffer
-    m_experienceBuffer.clear();
+    size_t numPairs = static_cast<size_t>(m_numNodes) * m_numNodes;
+    m_qPairSums = std::make_unique<std::atomic<int64_t>[]>(numPairs);
+    m_qPairCounts = std::make_unique<std::atomic<int32_t>[]>(numPairs);
+    m_qMatrix.assign(numPairs, 0.0f);
+    RebuildQMatrix();
+
+    // Clear experience buffers
+    m_mainWorker.replayBuffer.Clear();
+    m_workers.clear();
 }
 
-std::string RouteLearningAgent::EncodeState(const std::vector<int>& visitedLocations, int currentLocation)
+std::string RouteLearningAgent::EncodeState(uint32_t visitedMask, int currentLocation) const
 {
-    // Sort visited locations for consistent encoding
-    std::vector<int> sortedVisited = visitedLocations;
-    std::sort(sortedVisited.begin(), sortedVisited.end());
-
-    // Build state string as "current:visited[0],visited[1],..."
+    // Build state string as "current:visited[0],visited[1],..." with sorted IDs
     std::ostringstream oss;
     oss << currentLocation << ":";
 
-    for (size_t i = 0; i < sortedVisited.size(); i++) {
-        oss << sortedVisited[i];
-        if (i < sortedVisited.size() - 1) {
-            oss << ",";
+    bool first = true;
+    for (int id = 0; id < m_numNodes; id++) {
+        if (visitedMask & (1u << id)) {
+            if (!first) {
+                oss << ",";
+            }
+            oss << id;
+            first = false;
         }
     }
 
     return oss.str();
 }
 
-std::vector<int> RouteLearningAgent::GetAvailableActions(const std::string& state, const std::vector<WasteLocation>& locations)
+bool RouteLearningAgent::DecodeState(const std::string& state, uint32_t& visitedMask, int& currentLocation) const
 {
-    // Parse the state string to get current location and visited locations
-    std::istringstream iss(state);
-    std::string currentStr;
-    std::string visitedStr;
-
-    std::getline(iss, currentStr, ':');
-    std::getline(iss, visitedStr);
-
-    int currentLocation = std::stoi(currentStr);
-
-    // Parse visited locations
-    std::vector<int> visitedLocations;
-    std::istringstream visitedStream(visitedStr);
-    std::string token;
+    size_t separator = state.find(':');
+    if (separator == std::string::npos) {
+        return false;
+    }
 
-    while (std::getline(visitedStream, token, ',')) {
-        if (!token.empty()) {
-            visitedLocations.push_back(std::stoi(token));
-        }
+    // Parse "current:visited[0],visited[1],..."
+    const char* text = state.c_str();
+    char* end = nullptr;
+    currentLocation = static_cast<int>(std::strtol(text, &end, 10));
+    if (end != text + separator || currentLocation < 0 || currentLocation >= m_numNodes) {
+        return false;
     }
 
-    // Get all location IDs with waste level >= 40%
-    std::vector<int> validLocations;
-    for (const auto& location : locations) {
-        if (location.GetWasteLevel() >= 40.0f) {
-            int id = WasteLocation::dict_Name_toId[location.GetLocationName()];
-            if (id > 0) { // Skip station (0)
-                validLocations.push_back(id);
-            }
+    visitedMask = 0;
+    const char* cursor = text + separator + 1;
+    while (*cursor) {
+        long id = std::strtol(cursor, &end, 10);
+        if (end == cursor || id < 0 || id >= m_numNodes) {
+            return false;
         }
+
+        visitedMask |= 1u << id;
+        cursor = (*end == ',') ? end + 1 : end;
     }
 
-    // Add the station as a valid destination
-    validLocations.push_back(0);
+    return true;
+}
+
+RouteLearningAgent::EpisodeContext RouteLearningAgent::BuildEpisodeContext(const std::vector<WasteLocation>& locations) const
+{
+    EpisodeContext context;
+    context.wasteById.assign(m_numNodes, 0.0f);
+    context.reachableMask.assign(m_numNodes, 0);
+
+    // The station is always a valid destination
+    context.validMask = 1u;
 
-    // Filter out locations that have already been visited
-    std::vector<int> availableActions;
-    for (int location : validLocations) {
-        // Skip if location has already been visited
-        if (std::find(visitedLocations.begin(), visitedLocations.end(), location) != visitedLocations.end()) {
+    // Locations with waste level >= 40% need collection
+    for (const auto& location : locations) {
+        auto it = WasteLocation::dict_Name_toId.find(location.GetLocationName());
+        if (it == WasteLocation::dict_Name_toId.end() || it->second >= m_numNodes) {
             continue;
         }
 
-        // Skip if no direct path from current location
-        if (WasteLocation::map_distance_matrix[currentLocation][location] >= INF) {
-            continue;
+        int id = it->second;
+        context.wasteById[id] = location.GetWasteLevel();
+        if (id > 0 && location.GetWasteLevel() >= 40.0f) { // Skip station (0)
+            context.validMask |= 1u << id;
         }
+    }
 
-        availableActions.push_back(location);
+    // Pairs with a direct path
+    for (int from = 0; from < m_numNodes; from++) {
+        for (int to = 0; to < m_numNodes; to++) {
+            if (WasteLocation::map_distance_matrix[from][to] < INF) {
+                context.reachableMask[from] |= 1u << to;
+            }
+        }
     }
 
-    return availableActions;
+    return context;
 }
 
-int RouteLearningAgent::ChooseAction(const std::string& state, const std::vector<int>& availableActions)
+uint32_t RouteLearningAgent::GetAvailableActions(int currentLocation, uint32_t visitedMask, const EpisodeContext& context) const
+{
+    // Valid locations that have not been visited and are directly reachable
+    return context.validMask & ~visitedMask & context.reachableMask[currentLocation];
+}
+
+int RouteLearningAgent::ChooseAction(int currentLocation, uint32_t visitedMask, uint32_t availableActions,
+    float explorationRate, std::mt19937& rng)
 {
     // If no actions available, return -1
-    if (availableActions.empty()) {
+    if (availableActions == 0) {
         return -1;
     }
 
-    // Epsilon-greedy policy: explore with probability m_explorationRate
+    // Epsilon-greedy policy: explore with probability explorationRate
     std::uniform_real_distribution<float> dist(0.0f, 1.0f);
-    if (dist(m_rng) < m_explorationRate) {
+    if (dist(rng) < explorationRate) {
         // Explore: choose a random action
-        std::uniform_int_distribution<size_t> actionDist(0, availableActions.size() - 1);
-        return availableActions[actionDist(m_rng)];
+        std::uniform_int_distribution<int> actionDist(0, CountLocations(availableActions) - 1);
+        int skip = actionDist(rng);
+        while (skip-- > 0) {
+            availableActions &= availableActions - 1;
+        }
+        return LowestLocation(availableActions);
     }
     else {
         // Exploit: choose the action with the highest Q-value
-        int bestAction = availableActions[0];
+        size_t stateIndex = QIndex(visitedMask, currentLocation, 0);
+        int bestAction = LowestLocation(availableActions);
         float bestValue = -std::numeric_limits<float>::max();
 
-        for (int action : availableActions) {
-            // If state-action pair doesn't exist in Q-table, initialize it
-            if (m_qTable.find(state) == m_qTable.end() ||
-                m_qTable[state].find(action) == m_qTable[state].end()) {
-                m_qTable[state][action] = 0.0f;
-            }
-
-            float qValue = m_qTable[state][action];
+        for (uint32_t remaining = availableActions; remaining; remaining &= remaining - 1) {
+            int action = LowestLocation(remaining);
+            float qValue = LoadQ(stateIndex + action);
             if (qValue > bestValue) {
                 bestValue = qValue;
                 bestAction = action;
@@ -181,60 +369,103 @@ float RouteLearningAgent::CalculateReward(int fromLocation, int toLocation, floa
     return distancePenalty + wasteLevelReward + returnBonus;
 }
 
-void RouteLearningAgent::UpdateQValue(const std::string& state, int action, float reward, const std::string& nextState)
+float RouteLearningAgent::UpdateQValue(const Experience& experience, float weight)
 {
-    // If state-action pair doesn't exist in Q-table, initialize it
-    if (m_qTable.find(state) == m_qTable.end() ||
-        m_qTable[state].find(action) == m_qTable[state].end()) {
-        m_qTable[state][action] = 0.0f;
-    }
-
     // Get current Q-value
-    float currentQ = m_qTable[state][action];
+    size_t index = QIndex(experience.visitedMask, experience.currentLocation, experience.action);
+    float currentQ = LoadQ(index);
 
-    // Calculate maximum Q-value for next state
+    // Calculate maximum Q-value for next state (never below zero, as for unexplored states)
     float maxNextQ = 0.0f;
-    if (!nextState.empty() && m_qTable.find(nextState) != m_qTable.end()) {
-        for (const auto& pair : m_qTable[nextState]) {
-            maxNextQ = std::max(maxNextQ, pair.second);
+    if (!experience.isDone) {
+        size_t nextIndex = QIndex(experience.nextVisitedMask, experience.nextLocation, 0);
+        for (int action = 0; action < m_numNodes; action++) {
+            maxNextQ = std::max(maxNextQ, LoadQ(nextIndex + action));
         }
     }
 
-    // Update Q-value using Q-learning update rule
-    float newQ = currentQ + m_learningRate * (reward + m_discountFactor * maxNextQ - currentQ);
+    // Update Q-value using Q-learning update rule. Concurrent updates of the same
+    // entry may overwrite each other, which Hogwild-style training tolerates.
+    float tdError = experience.reward + m_discountFactor * maxNextQ - currentQ;
+    SetQ(index, currentQ + m_learningRate * weight * tdError);
+
+    return tdError;
+}
+
+void RouteLearningAgent::SetQ(size_t index, float value)
+{
+    // Exchange returns the value actually replaced, so the aggregates stay exact
+    // even when another thread wrote the same entry in between
+    float oldValue = m_qTable[index].exchange(value, std::memory_order_relaxed);
+    size_t pair = index % (static_cast<size_t>(m_numNodes) * m_numNodes);
+
+    int64_t delta = std::llround(value * s_qPairSumScale) - std::llround(oldValue * s_qPairSumScale);
+    if (delta != 0) {
+        m_qPairSums[pair].fetch_add(delta, std::memory_order_relaxed);
+    }
+
+    int countDelta = (value != 0.0f) - (oldValue != 0.0f);
+    if (countDelta != 0) {
+        m_qPairCounts[pair].fetch_add(countDelta, std::memory_order_relaxed);
+    }
+}
 
-    // Store updated Q-value
-    m_qTable[state][action] = newQ;
+void RouteLearningAgent::RebuildQMatrix()
+{
+    size_t numPairs = static_cast<size_t>(m_numNodes) * m_numNodes;
+    for (size_t pair = 0; pair < numPairs; pair++) {
+        m_qPairSums[pair].store(0, std::memory_order_relaxed);
+        m_qPairCounts[pair].store(0, std::memory_order_relaxed);
+    }
+
+    for (size_t i = 0; i < m_qTableSize; i++) {
+        float qValue = LoadQ(i);
+        if (qValue != 0.0f) {
+            size_t pair = i % numPairs;
+            m_qPairSums[pair].fetch_add(std::llround(qValue * s_qPairSumScale), std::memory_order_relaxed);
+            m_qPairCounts[pair].fetch_add(1, std::memory_order_relaxed);
+        }
+    }
 }
 
-void RouteLearningAgent::TrainOnBatch()
+void RouteLearningAgent::TrainOnBatch(RolloutWorker& worker)
 {
+    ReplayBuffer& buffer = worker.replayBuffer;
+
     // If experience buffer is too small, do nothing
-    if (m_experienceBuffer.size() < m_batchSize) {
+    if (buffer.Size() < m_batchSize) {
         return;
     }
 
-    // Select random batch from experience buffer
-    std::uniform_int_distribution<size_t> dist(0, m_experienceBuffer.size() - 1);
+    // Select random batch from experience buffer into the preallocated arrays
+    size_t numSamples = buffer.Sample(worker.rng, m_batchSize, worker.batchIndices.data(), worker.batchWeights.data());
 
-    for (size_t i = 0; i < m_batchSize; i++) {
-        size_t index = dist(m_rng);
-        const Experience& exp = m_experienceBuffer[index];
+    for (size_t i = 0; i < numSamples; i++) {
+        size_t index = worker.batchIndices[i];
 
-        // Update Q-value for this experience
-        UpdateQValue(exp.state, exp.action, exp.reward, exp.nextState);
+        // Update Q-value for this experience and its replay priority
+        float tdError = UpdateQValue(buffer.Get(index), worker.batchWeights[i]);
+        buffer.UpdatePriority(index, tdError);
+
+        worker.squaredErrorSum += tdError * tdError;
+        worker.numUpdates++;
     }
 }
 
-std::vector<int> RouteLearningAgent::GenerateEpisode(const std::vector<WasteLocation>& locations)
+std::vector<int> RouteLearningAgent::GenerateEpisode(const EpisodeContext& context, RolloutWorker& worker,
+    float explorationRate, float& totalReward)
 {
     // Start at the station
     int currentLocation = 0;
-    std::vector<int> visitedLocations = { 0 };
+    uint32_t visitedMask = 1u;
     std::vector<int> route = { 0 };
 
+    if (m_numNodes == 0) {
+        return route;
+    }
+
     // Keep track of total reward
-    float totalReward = 0.0f;
+    totalReward = 0.0f;
 
     // Limit episode length to prevent infinite loops
     const int maxSteps = 20;
@@ -243,68 +474,48 @@ std::vector<int> RouteLearningAgent::GenerateEpisode(const std::vector<WasteLoca
     while (steps < maxSteps) {
         steps++;
 
-        // Encode current state
-        std::string state = EncodeState(visitedLocations, currentLocation);
-
-        // Get available actions
-        std::vector<int> availableActions = GetAvailableActions(state, locations);
-
-        // If no actions available or we're at the station and have visited at least one other location, end episode
-        if (availableActions.empty() ||
-            (currentLocation == 0 && visitedLocations.size() > 1 &&
-                std::find(visitedLocations.begin(), visitedLocations.end(), 0) != visitedLocations.begin())) {
+        // Get available actions; the episode ends when there are none
+        uint32_t availableActions = GetAvailableActions(currentLocation, visitedMask, context);
+        if (availableActions == 0) {
             break;
         }
 
         // Choose action
-        int nextLocation = ChooseAction(state, availableActions);
+        int nextLocation = ChooseAction(currentLocation, visitedMask, availableActions, explorationRate, worker.rng);
 
         // If no valid action, end episode
         if (nextLocation == -1) {
             break;
         }
 
-        // Get waste level of next location
-        float wasteLevel = 0.0f;
-        for (const auto& location : locations) {
-            if (WasteLocation::dict_Name_toId[location.GetLocationName()] == nextLocation) {
-                wasteLevel = location.GetWasteLevel();
-                break;
-            }
-        }
-
         // Calculate reward
-        float reward = CalculateReward(currentLocation, nextLocation, wasteLevel);
+        float reward = CalculateReward(currentLocation, nextLocation, context.wasteById[nextLocation]);
         totalReward += reward;
 
         // Move to next location
-        currentLocation = nextLocation;
-        visitedLocations.push_back(currentLocation);
-        route.push_back(currentLocation);
-
-        // Encode next state
-        std::string nextState = EncodeState(visitedLocations, currentLocation);
+        uint32_t nextVisitedMask = visitedMask | (1u << nextLocation);
 
         // Store experience in replay buffer
         Experience exp = {
-            state,
+            currentLocation,
+            visitedMask,
             nextLocation,
             reward,
-            nextState,
+            nextLocation,
+            nextVisitedMask,
             false
         };
 
-        // Add to experience buffer
-        m_experienceBuffer.push_back(exp);
+        // Add to experience buffer; once it is full, the oldest experience is overwritten
+        worker.replayBuffer.Add(exp);
 
-        // If buffer is full, remove oldest experiences
-        if (m_experienceBuffer.size() > m_maxBufferSize) {
-            m_experienceBuffer.erase(m_experienceBuffer.begin());
-        }
+        currentLocation = nextLocation;
+        visitedMask = nextVisitedMask;
+        route.push_back(currentLocation);
 
         // Train on batch of experiences
-        if (m_experienceBuffer.size() >= m_batchSize && steps % 5 == 0) {
-            TrainOnBatch();
+        if (worker.replayBuffer.Size() >= m_batchSize && steps % 5 == 0) {
+            TrainOnBatch(worker);
         }
     }
 
@@ -318,170 +529,640 @@ std::vector<int> RouteLearningAgent::GenerateEpisode(const std::vector<WasteLoca
 
 void RouteLearningAgent::Train(const std::vector<WasteLocation>& locations, int iterations)
 {
+    if (m_useFeaturePolicy) {
+        TrainFeaturePolicy(BuildFeatureProblem(locations), iterations);
+        return;
+    }
+
+    if (m_numNodes == 0 || iterations <= 0) {
+        return;
+    }
+
     std::cout << "Training route learning agent..." << std::endl;
 
-    // Initialize exploration rate
-    m_explorationRate = 0.3f;
+    // Waste levels do not change during training, so resolve them once
+    EpisodeContext context = BuildEpisodeContext(locations);
 
-    // Train for the specified number of iterations
-    for (int i = 0; i < iterations; i++) {
-        // Generate an episode
-        std::vector<int> route = GenerateEpisode(locations);
+    // One worker per thread; workers keep their replay buffers between runs
+    ThreadPool& pool = ThreadPool::Shared();
+    size_t numWorkers = std::min(pool.GetConcurrency(), static_cast<size_t>(iterations));
+    while (m_workers.size() < numWorkers) {
+        m_workers.push_back(std::make_unique<RolloutWorker>(m_maxBufferSize, m_batchSize, m_prioritizedReplay, m_rng()));
+    }
 
-        // Decay exploration rate
-        m_explorationRate = std::max(0.05f, m_explorationRate * 0.99f);
+    m_trainingTotal = iterations;
+    m_trainingCompleted = 0;
 
-        // Print progress
-        if (i % 10 == 0) {
-            std::cout << "Training iteration " << i << "/" << iterations << std::endl;
+    // About 200 learning curve points per run
+    const int curveInterval = std::max(1, iterations / 200);
+    const int progressInterval = std::max(1, iterations / 10);
+    std::atomic<int> nextEpisode{ 0 };
+
+    pool.ParallelFor(numWorkers, 1, [&](size_t workerIndex, size_t, size_t) {
+        RolloutWorker& worker = *m_workers[workerIndex];
+
+        // Workers take episodes from a shared counter so fast threads do more of them
+        int episode;
+        while ((episode = nextEpisode.fetch_add(1)) < iterations) {
+            // Exploration decays with the episode number as in serial training
+            float explorationRate = std::max(0.05f, 0.3f * std::pow(0.99f, static_cast<float>(episode)));
+
+            float totalReward;
+            GenerateEpisode(context, worker, explorationRate, totalReward);
+
+            worker.rewardSum += totalReward;
+            if (++worker.numEpisodes >= curveInterval) {
+                RecordLearningPoint(worker);
+            }
+
+            // Print progress
+            int completed = m_trainingCompleted.fetch_add(1) + 1;
+            if (completed % progressInterval == 0) {
+                std::lock_guard<std::mutex> lock(m_historyMutex);
+                std::cout << "Training iteration " << completed << "/" << iterations << std::endl;
+            }
+        }
+        });
+
+    // Increment iteration counter
+    m_numIterations += iterations;
+    m_explorationRate = std::max(0.05f, 0.3f * std::pow(0.99f, static_cast<float>(iterations)));
+
+    std::cout << "Training complete after " << m_numIterations << " iterations" << std::endl;
+}
+
+void RouteLearningAgent::TrainAsync(const std::vector<WasteLocation>& locations, int iterations)
+{
+    if (IsTraining()) {
+        std::cerr << "Route learning agent is already training" << std::endl;
+        return;
+    }
+
+    m_isTraining = true;
+    m_trainingCompleted = 0;
+    m_trainingTotal = iterations;
+
+    if (m_useFeaturePolicy) {
+        // Take the cluster IDs now, the clustering may be rerun while training
+        FeatureRoutingProblem problem = BuildFeatureProblem(locations);
+        m_trainingTask = ThreadPool::Shared().Enqueue([this, problem, iterations]() {
+            TrainFeaturePolicy(problem, iterations);
+            m_isTraining = false;
+            });
+        return;
+    }
+
+    m_trainingTask = ThreadPool::Shared().Enqueue([this, locations, iterations]() {
+        Train(locations, iterations);
+        m_isTraining = false;
+        });
+}
+
+bool RouteLearningAgent::IsTraining() const
+{
+    return m_isTraining;
+}
+
+float RouteLearningAgent::GetTrainingProgress() const
+{
+    int total = m_trainingTotal;
+    if (total <= 0) {
+        return 0.0f;
+    }
+
+    return std::min(1.0f, static_cast<float>(m_trainingCompleted) / total);
+}
+
+void RouteLearningAgent::RecordLearningPoint(RolloutWorker& worker)
+{
+    float averageReward = static_cast<float>(worker.rewardSum / std::max(1, worker.numEpisodes));
+    float loss = worker.numUpdates > 0 ? static_cast<float>(worker.squaredErrorSum / worker.numUpdates) : 0.0f;
+
+    worker.rewardSum = 0.0;
+    worker.squaredErrorSum = 0.0;
+    worker.numUpdates = 0;
+    worker.numEpisodes = 0;
+
+    std::lock_guard<std::mutex> lock(m_historyMutex);
+    m_rewardHistory.push_back(averageReward);
+    m_lossHistory.push_back(loss);
+
+    // Keep the most recent points only
+    if (m_rewardHistory.size() > m_maxHistoryPoints) {
+        m_rewardHistory.erase(m_rewardHistory.begin());
+        m_lossHistory.erase(m_lossHistory.begin());
+    }
+}
+
+std::vector<float> RouteLearningAgent::GetRewardHistory() const
+{
+    std::lock_guard<std::mutex> lock(m_historyMutex);
+    return m_rewardHistory;
+}
+
+void RouteLearningAgent::TrainFeaturePolicy(const FeatureRoutingProblem& problem, int iterations)
+{
+    if (iterations <= 0) {
+        return;
+    }
+
+    std::cout << "Training feature-based route policy..." << std::endl;
+
+    // Episodes depend on each other through the weights, so they run on one worker
+    if (m_workers.empty()) {
+        m_workers.push_back(std::make_unique<RolloutWorker>(m_maxBufferSize, m_batchSize, m_prioritizedReplay, m_rng()));
+    }
+    RolloutWorker& worker = *m_workers[0];
+
+    m_trainingTotal = iterations;
+    m_trainingCompleted = 0;
+
+    const int curveInterval = std::max(1, iterations / 200);
+    const int progressInterval = std::max(1, iterations / 10);
+
+    for (int episode = 0; episode < iterations; episode++) {
+        float explorationRate = std::max(0.05f, 0.3f * std::pow(0.99f, static_cast<float>(episode)));
+
+        worker.rewardSum += m_featurePolicy.TrainEpisode(problem, explorationRate, worker.rng,
+            worker.squaredErrorSum, worker.numUpdates);
+        if (++worker.numEpisodes >= curveInterval) {
+            RecordLearningPoint(worker);
         }
 
-        // Increment iteration counter
-        m_numIterations++;
+        // Print progress
+        int completed = m_trainingCompleted.fetch_add(1) + 1;
+        if (completed % progressInterval == 0) {
+            std::cout << "Training iteration " << completed << "/" << iterations << std::endl;
+        }
     }
 
+    m_numIterations += iterations;
+
     std::cout << "Training complete after " << m_numIterations << " iterations" << std::endl;
 }
 
+FeatureRoutingProblem RouteLearningAgent::BuildFeatureProblem(const std::vector<WasteLocation>& locations) const
+{
+    size_t numLocations = WasteLocation::dict_Id_to_Name.size();
+
+    FeatureRoutingProblem problem;
+    problem.vehicleCapacity = m_vehicleCapacity;
+    problem.wasteLevel.assign(numLocations, 0.0f);
+    problem.clusterId.assign(numLocations, -1);
+
+    // The distance matrix only covers the fixed map. Larger location sets use straight-line
+    // distances between map coordinates, which needs no N x N matrix.
+    const size_t mapSize = sizeof(WasteLocation::map_distance_matrix) / sizeof(WasteLocation::map_distance_matrix[0]);
+    const bool straightLine = numLocations > mapSize;
+    if (!straightLine) {
+        problem.distanceMatrix.resize(numLocations * numLocations);
+        for (size_t from = 0; from < numLocations; from++) {
+            for (size_t to = 0; to < numLocations; to++) {
+                problem.distanceMatrix[from * numLocations + to] = WasteLocation::map_distance_matrix[from][to];
+            }
+        }
+    }
+    else {
+        // Map coordinates in km, with the scale of WasteLocation::CalculateDirectDistance
+        const float pixelsPerKm = 30.0f;
+        problem.x.assign(numLocations, WasteLocation::location_coordinates[0][0] / pixelsPerKm);
+        problem.y.assign(numLocations, WasteLocation::location_coordinates[0][1] / pixelsPerKm);
+        for (size_t id = 0; id < mapSize; id++) {
+            problem.x[id] = WasteLocation::location_coordinates[id][0] / pixelsPerKm;
+            problem.y[id] = WasteLocation::location_coordinates[id][1] / pixelsPerKm;
+        }
+    }
+
+    for (const auto& location : locations) {
+        auto it = WasteLocation::dict_Name_toId.find(location.GetLocationName());
+        if (it == WasteLocation::dict_Name_toId.end() || it->second < 0 ||
+            static_cast<size_t>(it->second) >= numLocations) {
+            continue;
+        }
+
+        // Locations without a map position keep a zero waste level and are never visited
+        if (straightLine && static_cast<size_t>(it->second) >= mapSize) {
+            continue;
+        }
+
+        problem.wasteLevel[it->second] = location.GetWasteLevel();
+        if (m_clustering != nullptr) {
+            problem.clusterId[it->second] = m_clustering->GetClusterForLocation(location.GetLocationName());
+        }
+    }
+
+    return problem;
+}
+
 std::vector<int> RouteLearningAgent::GetBestRoute(const std::vector<WasteLocation>& locations)
 {
-    // Set exploration rate to 0 for best route
-    float oldExplorationRate = m_explorationRate;
-    m_explorationRate = 0.0f;
+    if (m_useFeaturePolicy) {
+        return m_featurePolicy.GetRoute(BuildFeatureProblem(locations));
+    }
 
     // Generate an episode with no exploration
-    std::vector<int> bestRoute = GenerateEpisode(locations);
+    float totalReward;
+    return GenerateEpisode(BuildEpisodeContext(locations), m_mainWorker, 0.0f, totalReward);
+}
+
+void RouteLearningAgent::SetPrioritizedReplay(bool enabled)
+{
+    if (IsTraining()) {
+        std::cerr << "Cannot change the replay mode while the route learning agent is training" << std::endl;
+        return;
+    }
+
+    m_prioritizedReplay = enabled;
+    m_mainWorker.replayBuffer.SetPrioritized(enabled);
+    for (auto& worker : m_workers) {
+        worker->replayBuffer.SetPrioritized(enabled);
+    }
+}
+
+bool RouteLearningAgent::IsPrioritizedReplay() const
+{
+    return m_prioritizedReplay;
+}
+
+void RouteLearningAgent::SetFeaturePolicyEnabled(bool enabled)
+{
+    if (IsTraining()) {
+        std::cerr << "Cannot change the policy while the route learning agent is training" << std::endl;
+        return;
+    }
+
+    // Without a Q-table only the feature-based policy can route
+    if (!enabled && m_numNodes == 0 && WasteLocation::dict_Id_to_Name.size() > static_cast<size_t>(m_maxNodes)) {
+        std::cerr << "Too many locations for the Q-table, keeping the feature-based policy" << std::endl;
+        return;
+    }
+
+    m_useFeaturePolicy = enabled;
+}
+
+bool RouteLearningAgent::IsFeaturePolicyEnabled() const
+{
+    return m_useFeaturePolicy;
+}
 
-    // Restore exploration rate
-    m_explorationRate = oldExplorationRate;
+void RouteLearningAgent::SetLocationClustering(const LocationClustering* clustering)
+{
+    m_clustering = clustering;
+}
 
-    return bestRoute;
+void RouteLearningAgent::SetVehicleCapacity(float capacity)
+{
+    m_vehicleCapacity = std::max(100.0f, capacity);
 }
 
 void RouteLearningAgent::Reset()
 {
-    // Clear Q-table and experience buffer
-    m_qTable.clear();
-    m_experienceBuffer.clear();
+    if (IsTraining()) {
+        std::cerr << "Cannot reset the route learning agent while it is training" << std::endl;
+        return;
+    }
 
-    // Reset iteration counter
+    // Reset iteration counter and learning curve
     m_numIterations = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_historyMutex);
+        m_rewardHistory.clear();
+        m_lossHistory.clear();
+    }
 
-    // Reinitialize
+    // Reinitialize the Q-table with zeros and clear the experience buffer
     Initialize();
+    m_featurePolicy.Reset();
 }
 
 float RouteLearningAgent::GetQValue(const std::string& state, int action)
 {
-    // If state-action pair doesn't exist in Q-table, return 0
-    if (m_qTable.find(state) == m_qTable.end() ||
-        m_qTable[state].find(action) == m_qTable[state].end()) {
+    // If the state or action is not part of the Q-table, return 0
+    uint32_t visitedMask;
+    int currentLocation;
+    if (!DecodeState(state, visitedMask, currentLocation)) {
         return 0.0f;
     }
 
-    return m_qTable[state][action];
+    return GetQValue(currentLocation, visitedMask, action);
 }
 
-float** RouteLearningAgent::GetQMatrix()
+float RouteLearningAgent::GetQValue(int currentLocation, uint32_t visitedMask, int action) const
 {
-    // Allocate memory for Q-matrix
-    float** qMatrix = new float* [8];
-    for (int i = 0; i < 8; i++) {
-        qMatrix[i] = new float[8];
-
-        // Initialize with zeros
-        for (int j = 0; j < 8; j++) {
-            qMatrix[i][j] = 0.0f;
-        }
+    if (currentLocation < 0 || currentLocation >= m_numNodes || action < 0 || action >= m_numNodes ||
+        (visitedMask >> m_numNodes) != 0) {
+        return 0.0f;
     }
 
-    // For each state-action pair in the Q-table
-    for (const auto& statePair : m_qTable) {
-        // Parse the state string to get current location
-        std::istringstream iss(statePair.first);
-        std::string currentStr;
-        std::getline(iss, currentStr, ':');
-
-        int fromLocation = std::stoi(currentStr);
-
-        // For each action
-        for (const auto& actionPair : statePair.second) {
-            int toLocation = actionPair.first;
-            float qValue = actionPair.second;
+    return LoadQ(QIndex(visitedMask, currentLocation, action));
+}
 
-            // Only update if locations are valid
-            if (fromLocation >= 0 && fromLocation < 8 && toLocation >= 0 && toLocation < 8) {
-                qMatrix[fromLocation][toLocation] = qValue;
-            }
-        }
+QMatrixView RouteLearningAgent::GetQMatrix()
+{
+    // Turn the maintained sums into means; unexplored pairs stay zero
+    for (size_t pair = 0; pair < m_qMatrix.size(); pair++) {
+        int count = m_qPairCounts[pair].load(std::memory_order_relaxed);
+        int64_t sum = m_qPairSums[pair].load(std::memory_order_relaxed);
+        m_qMatrix[pair] = count > 0 ? static_cast<float>(sum / s_qPairSumScale / count) : 0.0f;
     }
 
-    return qMatrix;
+    QMatrixView view;
+    view.values = m_qMatrix.data();
+    view.size = m_numNodes;
+    return view;
 }
 
 std::pair<float, float> RouteLearningAgent::GetLearningMetrics()
 {
-    // For demonstration, return placeholder values
-    return { 0.75f, 0.1f };
+    std::lock_guard<std::mutex> lock(m_historyMutex);
+    if (m_rewardHistory.empty()) {
+        return { 0.0f, 0.0f };
+    }
+
+    return { m_rewardHistory.back(), m_lossHistory.back() };
 }
 
-void RouteLearningAgent::SaveModel(const std::string& filename)
+bool RouteLearningAgent::SaveModel(const std::string& filename, RouteModelFormat format)
 {
     // Open file for writing
-    std::ofstream file(filename);
+    std::ofstream file(filename, format == RouteModelFormat::Text ? std::ios::out : std::ios::out | std::ios::binary);
     if (!file.is_open()) {
         std::cerr << "Failed to open file: " << filename << std::endl;
-        return;
+        return false;
     }
 
-    // Write number of state-action pairs
+    // Count learned state-action pairs
     size_t numPairs = 0;
-    for (const auto& statePair : m_qTable) {
-        numPairs += statePair.second.size();
+    for (size_t i = 0; i < m_qTableSize; i++) {
+        if (LoadQ(i) != 0.0f) {
+            numPairs++;
+        }
     }
 
-    file << numPairs << std::endl;
+    if (format == RouteModelFormat::Text) {
+        file << numPairs << std::endl;
+
+        // Write each learned state-action pair and its Q-value in the "current:visited action value" format
+        uint32_t numMasks = m_numNodes > 0 ? (1u << m_numNodes) : 0;
+        for (uint32_t mask = 0; mask < numMasks; mask++) {
+            for (int location = 0; location < m_numNodes; location++) {
+                size_t stateIndex = QIndex(mask, location, 0);
+
+                for (int action = 0; action < m_numNodes; action++) {
+                    float qValue = LoadQ(stateIndex + action);
+                    if (qValue != 0.0f) {
+                        file << EncodeState(mask, location) << " " << action << " " << qValue << std::endl;
+                    }
+                }
+            }
+        }
+
+        // Feature-based policy weights on a final line; older readers stop before it
+        file.precision(std::numeric_limits<float>::max_digits10);
+        file << "weights";
+        for (float weight : m_featurePolicy.GetWeights()) {
+            file << " " << weight;
+        }
+        file << std::endl;
+    }
+    else {
+        ModelFileHeader header = {};
+        std::memcpy(header.magic, ModelMagic, sizeof(ModelMagic));
+        header.version = ModelVersion;
+        header.numNodes = static_cast<uint32_t>(m_numNodes);
+        header.numIterations = m_numIterations;
+
+        // Sparse records when fewer than half of the Q-values have been learned
+        std::vector<uint8_t> records;
+        if (numPairs * sizeof(SparseRecord) < m_qTableSize * sizeof(float)) {
+            header.flags |= ModelFlagSparse;
+            header.recordCount = numPairs;
+            records.resize(numPairs * sizeof(SparseRecord));
+
+            size_t offset = 0;
+            for (size_t i = 0; i < m_qTableSize; i++) {
+                SparseRecord record = { static_cast<uint32_t>(i), LoadQ(i) };
+                if (record.value != 0.0f) {
+                    std::memcpy(records.data() + offset, &record, sizeof(record));
+                    offset += sizeof(record);
+                }
+            }
+        }
+        else {
+            header.recordCount = m_qTableSize;
+            records.resize(m_qTableSize * sizeof(float));
+
+            for (size_t i = 0; i < m_qTableSize; i++) {
+                float qValue = LoadQ(i);
+                std::memcpy(records.data() + i * sizeof(float), &qValue, sizeof(float));
+            }
+        }
 
-    // Write each state-action pair and its Q-value
-    for (const auto& statePair : m_qTable) {
-        for (const auto& actionPair : statePair.second) {
-            file << statePair.first << " " << actionPair.first << " " << actionPair.second << std::endl;
+        header.rawSize = records.size();
+        if (format == RouteModelFormat::CompressedBinary) {
+            header.flags |= ModelFlagCompressed;
+            records = CompressZeroRuns(records);
         }
+        header.storedSize = records.size();
+
+        std::vector<float> featureWeights = m_featurePolicy.GetWeights();
+        header.numFeatureWeights = static_cast<uint32_t>(featureWeights.size());
+        header.checksum = Fnv1a(reinterpret_cast<const uint8_t*>(featureWeights.data()),
+            featureWeights.size() * sizeof(float), Fnv1a(records.data(), records.size()));
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(records.data()), records.size());
+        file.write(reinterpret_cast<const char*>(featureWeights.data()), featureWeights.size() * sizeof(float));
+    }
+
+    if (!file) {
+        std::cerr << "Failed to write model to: " << filename << std::endl;
+        return false;
     }
 
     file.close();
 
     std::cout << "Model saved to: " << filename << std::endl;
+    return true;
+}
+
+bool RouteLearningAgent::LoadModel(const std::string& filename)
+{
+    if (IsTraining()) {
+        std::cerr << "Cannot load a model while the route learning agent is training" << std::endl;
+        return false;
+    }
+
+    // Map the file and check for the binary header
+    MappedFile file;
+    if (!file.Open(filename)) {
+        std::cerr << "Failed to open file: " << filename << std::endl;
+        return false;
+    }
+
+    bool loaded;
+    if (file.GetSize() >= sizeof(ModelMagic) && std::memcmp(file.GetData(), ModelMagic, sizeof(ModelMagic)) == 0) {
+        loaded = LoadBinaryModel(file, filename);
+    }
+    else {
+        file.Close();
+        loaded = LoadTextModel(filename);
+    }
+
+    if (loaded) {
+        std::cout << "Model loaded from: " << filename << std::endl;
+    }
+    return loaded;
+}
+
+bool RouteLearningAgent::LoadBinaryModel(const MappedFile& file, const std::string& filename)
+{
+    if (file.GetSize() < sizeof(ModelFileHeader)) {
+        std::cerr << "Model file is truncated: " << filename << std::endl;
+        return false;
+    }
+
+    ModelFileHeader header;
+    std::memcpy(&header, file.GetData(), sizeof(header));
+    const uint8_t* stored = file.GetData() + sizeof(header);
+
+    if (header.version < MinModelVersion || header.version > ModelVersion) {
+        std::cerr << "Unsupported model version " << header.version << " in: " << filename << std::endl;
+        return false;
+    }
+
+    // Version 1 used the weight count as a reserved, zero field
+    uint64_t numFeatureWeights = header.version >= 2 ? header.numFeatureWeights : 0;
+    if (numFeatureWeights != 0 && numFeatureWeights != FeatureQPolicy::NumFeatures) {
+        std::cerr << "Model in " << filename << " has " << numFeatureWeights
+            << " feature weights, expected " << FeatureQPolicy::NumFeatures << std::endl;
+        return false;
+    }
+    if (header.numNodes != static_cast<uint32_t>(m_numNodes)) {
+        std::cerr << "Model in " << filename << " was trained on " << header.numNodes
+            << " locations, expected " << m_numNodes << std::endl;
+        return false;
+    }
+
+    bool sparse = (header.flags & ModelFlagSparse) != 0;
+    uint64_t recordSize = sparse ? sizeof(SparseRecord) : sizeof(float);
+    uint64_t maxRecords = m_qTableSize;
+    uint64_t weightsSize = numFeatureWeights * sizeof(float);
+    if (header.storedSize > file.GetSize() - sizeof(header) ||
+        weightsSize != file.GetSize() - sizeof(header) - header.storedSize || header.recordCount > maxRecords ||
+        header.rawSize != header.recordCount * recordSize || (!sparse && header.recordCount != m_qTableSize)) {
+        std::cerr << "Model file is corrupt: " << filename << std::endl;
+        return false;
+    }
+    const uint8_t* weights = stored + header.storedSize;
+    if (Fnv1a(weights, static_cast<size_t>(weightsSize), Fnv1a(stored, static_cast<size_t>(header.storedSize))) != header.checksum) {
+        std::cerr << "Model file checksum mismatch: " << filename << std::endl;
+        return false;
+    }
+
+    // Uncompressed records are read in place from the mapping
+    std::vector<uint8_t> decompressed;
+    const uint8_t* records = stored;
+    if (header.flags & ModelFlagCompressed) {
+        if (!DecompressZeroRuns(stored, static_cast<size_t>(header.storedSize), decompressed,
+            static_cast<size_t>(header.rawSize))) {
+            std::cerr << "Model file is corrupt: " << filename << std::endl;
+            return false;
+        }
+        records = decompressed.data();
+    }
+
+    size_t recordCount = static_cast<size_t>(header.recordCount);
+    if (sparse) {
+        for (size_t i = 0; i < m_qTableSize; i++) {
+            StoreQ(i, 0.0f);
+        }
+
+        for (size_t i = 0; i < recordCount; i++) {
+            SparseRecord record;
+            std::memcpy(&record, records + i * sizeof(SparseRecord), sizeof(record));
+            if (record.index < m_qTableSize) {
+                StoreQ(record.index, record.value);
+            }
+        }
+    }
+    else {
+        for (size_t i = 0; i < recordCount; i++) {
+            float qValue;
+            std::memcpy(&qValue, records + i * sizeof(float), sizeof(float));
+            StoreQ(i, qValue);
+        }
+    }
+
+    RebuildQMatrix();
+    m_numIterations = header.numIterations;
+
+    if (numFeatureWeights > 0) {
+        std::vector<float> featureWeights(static_cast<size_t>(numFeatureWeights));
+        std::memcpy(featureWeights.data(), weights, static_cast<size_t>(weightsSize));
+        m_featurePolicy.SetWeights(featureWeights);
+    }
+    return true;
 }
 
-void RouteLearningAgent::LoadModel(const std::string& filename)
+bool RouteLearningAgent::LoadTextModel(const std::string& filename)
 {
     // Open file for reading
     std::ifstream file(filename);
     if (!file.is_open()) {
         std::cerr << "Failed to open file: " << filename << std::endl;
-        return;
+        return false;
     }
 
     // Clear existing Q-table
-    m_qTable.clear();
+    for (size_t i = 0; i < m_qTableSize; i++) {
+        StoreQ(i, 0.0f);
+    }
 
     // Read number of state-action pairs
     size_t numPairs;
     file >> numPairs;
 
     // Read each state-action pair and its Q-value
+    size_t numSkipped = 0;
     for (size_t i = 0; i < numPairs; i++) {
         std::string state;
         int action;
         float qValue;
 
-        file >> state >> action >> qValue;
+        if (!(file >> state >> action >> qValue)) {
+            break;
+        }
+
+        uint32_t visitedMask;
+        int currentLocation;
+        if (!DecodeState(state, visitedMask, currentLocation) || action < 0 || action >= m_numNodes) {
+            numSkipped++;
+            continue;
+        }
 
-        m_qTable[state][action] = qValue;
+        StoreQ(QIndex(visitedMask, currentLocation, action), qValue);
+    }
+
+    // Feature-based policy weights, absent in older files
+    std::string tag;
+    if (file >> tag && tag == "weights") {
+        std::vector<float> featureWeights(FeatureQPolicy::NumFeatures);
+        bool complete = true;
+        for (float& weight : featureWeights) {
+            complete = complete && static_cast<bool>(file >> weight);
+        }
+        if (complete) {
+            m_featurePolicy.SetWeights(featureWeights);
+        }
     }
 
     file.close();
+    RebuildQMatrix();
+
+    if (numSkipped > 0) {
+        std::cerr << "Skipped " << numSkipped << " entries that do not match the current locations" << std::endl;
+    }
 
-    std::cout << "Model loaded from: " << filename << std::endl;
-}
\ No newline at end of file
+    return true;
+}
@@ -3,10 +3,41 @@
 #pragma once
 
 #include "../Core/WasteLocation.h"
+#include "ReplayBuffer.h"
+#include "FeatureQPolicy.h"
 #include <vector>
 #include <unordered_map>
 #include <string>
 #include <random>
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <future>
+#include <memory>
+
+class MappedFile;
+class LocationClustering;
+
+/**
+ * @brief Read-only view of the agent's N x N matrix of route segment values
+ *
+ * The values are owned by the agent and stay valid until the next GetQMatrix call.
+ */
+struct QMatrixView {
+    const float* values = nullptr;   // Row-major [from * size + to]
+    int size = 0;                    // Number of locations (N)
+
+    float At(int fromLocation, int toLocation) const { return values[fromLocation * size + toLocation]; }
+};
+
+/**
+ * @brief File formats for saving a learned route model
+ */
+enum class RouteModelFormat {
+    Text,               // One "current:visited action value" line per learned pair
+    Binary,             // Header plus dense Q-values or fixed-width sparse records
+    CompressedBinary    // Binary with the record block zero-run compressed
+};
 
 /**
  * @brief AI agent that learns optimal routes using reinforcement learning
@@ -19,51 +50,137 @@ private:
     float m_learningRate;
     float m_discountFactor;
     float m_explorationRate;
-    int m_numIterations;
-
-    // Q-table: state -> action -> Q-value
-    // State is represented as a string encoding of visited locations
-    // Action is the next location to visit
-    std::unordered_map<std::string, std::unordered_map<int, float>> m_qTable;
-
-    // Experience replay buffer
-    struct Experience {
-        std::string state;
-        int action;
-        float reward;
-        std::string nextState;
-        bool isDone;
-    };
+    std::atomic<int> m_numIterations;
 
-    std::vector<Experience> m_experienceBuffer;
+    // Q-table: (visited set, current location) -> action -> Q-value
+    // A state is the current location plus a bitmask of visited location IDs,
+    // stored densely as m_qTable[(visitedMask * N + current) * N + action].
+    // Training threads update it lock-free (Hogwild), so entries are relaxed atomics.
+    std::unique_ptr<std::atomic<float>[]> m_qTable;
+    size_t m_qTableSize;
+
+    // Mean learned Q-value of each (current, action) pair over all visited sets, kept
+    // up to date as Q-values change. Sums are fixed point so that concurrent updates
+    // add up exactly; m_qMatrix caches the means handed out by GetQMatrix.
+    std::unique_ptr<std::atomic<int64_t>[]> m_qPairSums;
+    std::unique_ptr<std::atomic<int32_t>[]> m_qPairCounts;
+    std::vector<float> m_qMatrix;
+    static constexpr double s_qPairSumScale = 1048576.0;   // 2^20 fixed-point steps per unit
+
+    int m_numNodes;                  // Number of locations (N) covered by the Q-table
+    const int m_maxNodes = 16;       // Largest N the dense table supports
+
+    // Experience replay parameters
     const size_t m_maxBufferSize = 10000;
     const size_t m_batchSize = 32;
+    bool m_prioritizedReplay;
+
+    // Everything one training thread owns: its RNG, replay buffer and statistics
+    struct RolloutWorker {
+        std::mt19937 rng;
+        ReplayBuffer replayBuffer;
+        std::vector<size_t> batchIndices;   // Preallocated storage for one sampled batch
+        std::vector<float> batchWeights;
+        double rewardSum = 0.0;             // Episode rewards since the last learning curve point
+        double squaredErrorSum = 0.0;       // Squared TD errors since the last learning curve point
+        size_t numUpdates = 0;
+        int numEpisodes = 0;
+
+        RolloutWorker(size_t bufferSize, size_t batchSize, bool prioritized, unsigned int seed)
+            : rng(seed), replayBuffer(bufferSize, prioritized), batchIndices(batchSize), batchWeights(batchSize) {}
+    };
+
+    RolloutWorker m_mainWorker;                             // Used outside of Train (e.g. GetBestRoute)
+    std::vector<std::unique_ptr<RolloutWorker>> m_workers;  // One per training thread
+
+    // Training progress and learning curve
+    std::atomic<bool> m_isTraining;
+    std::atomic<int> m_trainingCompleted;
+    std::atomic<int> m_trainingTotal;
+    std::future<void> m_trainingTask;
+    mutable std::mutex m_historyMutex;        // Guards the learning curve
+    std::vector<float> m_rewardHistory;       // Average episode reward per learning curve point
+    std::vector<float> m_lossHistory;         // Mean squared TD error per learning curve point
+    const size_t m_maxHistoryPoints = 1000;
+
+    // Add a learning curve point from a worker's statistics and reset them
+    void RecordLearningPoint(RolloutWorker& worker);
+
+    // Problem data resolved once from the waste locations instead of on every step
+    struct EpisodeContext {
+        std::vector<float> wasteById;          // Waste level per location ID
+        std::vector<uint32_t> reachableMask;   // Directly reachable locations per location ID
+        uint32_t validMask;                    // Locations that need collection, plus the station
+    };
+
+    // Feature-based policy, used instead of the Q-table when there are too many
+    // locations for a dense table or when it is selected explicitly
+    FeatureQPolicy m_featurePolicy;
+    bool m_useFeaturePolicy;
+    const LocationClustering* m_clustering;   // Source of cluster IDs (may be null)
+    float m_vehicleCapacity;                  // Waste one trip can carry, in bin percent
 
     // Random number generator
     std::mt19937 m_rng;
 
+    // Relaxed atomic access to Q-table entries
+    float LoadQ(size_t index) const { return m_qTable[index].load(std::memory_order_relaxed); }
+    void StoreQ(size_t index, float value) { m_qTable[index].store(value, std::memory_order_relaxed); }
+
+    // Store a Q-value and update the pair aggregates behind GetQMatrix
+    void SetQ(size_t index, float value);
+
+    // Recompute the pair aggregates from the whole Q-table (after bulk StoreQ calls)
+    void RebuildQMatrix();
+
     // Helper functions
 
-    // Encode a state (set of visited locations) as a string
-    std::string EncodeState(const std::vector<int>& visitedLocations, int currentLocation);
+    // Index of a state-action pair in the Q-table
+    size_t QIndex(uint32_t visitedMask, int currentLocation, int action) const {
+        return (static_cast<size_t>(visitedMask) * m_numNodes + currentLocation) * m_numNodes + action;
+    }
+
+    // Encode a state (set of visited locations) as a string, used by the text model format
+    std::string EncodeState(uint32_t visitedMask, int currentLocation) const;
+
+    // Decode a state string such as "3:0,1,3"; returns false if it is not valid for this table
+    bool DecodeState(const std::string& state, uint32_t& visitedMask, int& currentLocation) const;
 
-    // Get available actions (unvisited locations) from a state
-    std::vector<int> GetAvailableActions(const std::string& state, const std::vector<WasteLocation>& locations);
+    // Load a model in the binary format from a mapped file
+    bool LoadBinaryModel(const MappedFile& file, const std::string& filename);
+
+    // Load a model in the text format
+    bool LoadTextModel(const std::string& filename);
+
+    // Describe the locations as a problem for the feature-based policy
+    FeatureRoutingProblem BuildFeatureProblem(const std::vector<WasteLocation>& locations) const;
+
+    // Train the feature-based policy on one problem
+    void TrainFeaturePolicy(const FeatureRoutingProblem& problem, int iterations);
+
+    // Resolve waste levels and reachability for a set of locations
+    EpisodeContext BuildEpisodeContext(const std::vector<WasteLocation>& locations) const;
+
+    // Get available actions (unvisited valid locations) from a state as a bitmask
+    uint32_t GetAvailableActions(int currentLocation, uint32_t visitedMask, const EpisodeContext& context) const;
 
     // Choose an action using epsilon-greedy policy
-    int ChooseAction(const std::string& state, const std::vector<int>& availableActions);
+    int ChooseAction(int currentLocation, uint32_t visitedMask, uint32_t availableActions,
+        float explorationRate, std::mt19937& rng);
 
     // Calculate reward for taking an action
     float CalculateReward(int fromLocation, int toLocation, float wasteLevel);
 
-    // Update Q-value for a state-action pair
-    void UpdateQValue(const std::string& state, int action, float reward, const std::string& nextState);
+    // Update Q-value for a state-action pair, scaled by an importance-sampling weight.
+    // Returns the TD error before the update.
+    float UpdateQValue(const Experience& experience, float weight = 1.0f);
 
-    // Train on a batch of experiences from the replay buffer
-    void TrainOnBatch();
+    // Train on a batch of experiences from a worker's replay buffer
+    void TrainOnBatch(RolloutWorker& worker);
 
-    // Generate an episode (complete route) using current policy
-    std::vector<int> GenerateEpisode(const std::vector<WasteLocation>& locations);
+    // Generate an episode (complete route) using current policy; totalReward receives its reward
+    std::vector<int> GenerateEpisode(const EpisodeContext& context, RolloutWorker& worker,
+        float explorationRate, float& totalReward);
 
 public:
     /**
@@ -83,11 +200,40 @@ public:
 
     /**
      * @brief Train the agent on waste locations
+     *
+     * Episodes are generated on all threads of the shared pool. Every thread has its
+     * own RNG and replay buffer and updates the shared Q-table without locks.
+     *
      * @param locations Vector of waste locations
-     * @param iterations Number of training iterations
+     * @param iterations Number of training iterations (episodes)
      */
     void Train(const std::vector<WasteLocation>& locations, int iterations);
 
+    /**
+     * @brief Start training in the background and return immediately
+     * @param locations Vector of waste locations (copied)
+     * @param iterations Number of training iterations (episodes)
+     */
+    void TrainAsync(const std::vector<WasteLocation>& locations, int iterations);
+
+    /**
+     * @brief Check whether background training is running
+     * @return True while TrainAsync is running
+     */
+    bool IsTraining() const;
+
+    /**
+     * @brief Get the progress of the current or last training run
+     * @return Fraction of episodes completed (0-1)
+     */
+    float GetTrainingProgress() const;
+
+    /**
+     * @brief Get the learning curve recorded during training
+     * @return Average episode reward per recorded point, oldest first
+     */
+    std::vector<float> GetRewardHistory() const;
+
     /**
      * @brief Get the best route according to learned policy
      * @param locations Vector of waste locations
@@ -95,6 +241,48 @@ public:
      */
     std::vector<int> GetBestRoute(const std::vector<WasteLocation>& locations);
 
+    /**
+     * @brief Choose between uniform and prioritized experience replay
+     * @param enabled True to replay experiences in proportion to their TD error
+     */
+    void SetPrioritizedReplay(bool enabled);
+
+    /**
+     * @brief Check whether prioritized experience replay is used
+     * @return True if prioritized replay is enabled
+     */
+    bool IsPrioritizedReplay() const;
+
+    /**
+     * @brief Choose between the Q-table and the feature-based policy
+     *
+     * The feature-based policy scores moves from distance, waste level, cluster and
+     * remaining capacity with a linear Q-function, so its memory does not grow with
+     * the number of visited sets. It is selected automatically when there are more
+     * locations than the Q-table supports.
+     *
+     * @param enabled True to train and route with the feature-based policy
+     */
+    void SetFeaturePolicyEnabled(bool enabled);
+
+    /**
+     * @brief Check whether the feature-based policy is used
+     * @return True if the feature-based policy is used
+     */
+    bool IsFeaturePolicyEnabled() const;
+
+    /**
+     * @brief Set where the feature-based policy takes cluster IDs from
+     * @param clustering Location clustering instance (null for no clusters)
+     */
+    void SetLocationClustering(const LocationClustering* clustering);
+
+    /**
+     * @brief Set the vehicle capacity used by the feature-based policy
+     * @param capacity Waste one trip can carry, in bin percent
+     */
+    void SetVehicleCapacity(float capacity);
+
     /**
      * @brief Reset the learning agent
      */
@@ -102,33 +290,57 @@ public:
 
     /**
      * @brief Get the Q-value for a state-action pair
-     * @param state State string
+     * @param state State string such as "3:0,1,3" (current location : visited locations)
      * @param action Action (location ID)
      * @return Q-value
      */
     float GetQValue(const std::string& state, int action);
 
     /**
-     * @brief Get Q-values for all locations
-     * @return 2D matrix of Q-values [from][to]
+     * @brief Get the Q-value for a state-action pair
+     * @param currentLocation Current location ID
+     * @param visitedMask Bitmask of visited location IDs
+     * @param action Action (location ID)
+     * @return Q-value
+     */
+    float GetQValue(int currentLocation, uint32_t visitedMask, int action) const;
+
+    /**
+     * @brief Get the value of each route segment for all locations
+     *
+     * Each entry is the mean learned Q-value of moving from one location to another,
+     * taken over all visited sets. The agent keeps the sums up to date while it learns,
+     * so this only divides N x N sums and does not scan the Q-table.
+     *
+     * @return View of the N x N matrix [from][to], valid until the next call
      */
-    float** GetQMatrix();
+    QMatrixView GetQMatrix();
 
     /**
      * @brief Get learning metrics
-     * @return Pair of average reward and loss over last episode
+     * @return Pair of average episode reward and mean squared TD error of the latest learning curve point
      */
     std::pair<float, float> GetLearningMetrics();
 
     /**
      * @brief Save the learned model to a file
+     *
+     * Both the Q-table and the weights of the feature-based policy are saved.
+     *
      * @param filename Filename to save to
+     * @param format File format to write
+     * @return True if successful, false otherwise
      */
-    void SaveModel(const std::string& filename);
+    bool SaveModel(const std::string& filename, RouteModelFormat format = RouteModelFormat::Binary);
 
     /**
      * @brief Load a learned model from a file
+     *
+     * The format is detected from the file contents. Binary models are memory-mapped
+     * and, unless compressed, copied straight from the mapping into the Q-table.
+     *
      * @param filename Filename to load from
+     * @return True if successful, false otherwise
      */
-    void LoadModel(const std::string& filename);
+    bool LoadModel(const std::string& filename);
 };
\ No newline at end of file
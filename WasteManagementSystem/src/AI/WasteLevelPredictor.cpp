@@ -2,6 +2,13 @@
 // Implementation of the AI-based waste level prediction component
 #include "pch.h"
 #include "WasteLevelPredictor.h"
+#include "../Utils/ThreadPool.h"
+#include <atomic>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
 // Helper function to get day of week (0 = Sunday, 6 = Saturday)
 int GetDayOfWeek(time_t time) {
@@ -20,7 +27,160 @@ float Sigmoid(float x) {
     return 1.0f / (1.0f + std::exp(-x));
 }
 
+#if defined(__AVX2__)
+// Vectorized exp(x) for 8 floats (Cephes-style range reduction and polynomial)
+static inline __m256 Exp256(__m256 x)
+{
+    x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(-87.3f)), _mm256_set1_ps(88.3f));
+
+    // Split x into n * ln(2) + r with |r| <= ln(2) / 2
+    __m256 n = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(1.44269504088896341f)),
+        _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256 r = _mm256_sub_ps(x, _mm256_mul_ps(n, _mm256_set1_ps(0.693359375f)));
+    r = _mm256_sub_ps(r, _mm256_mul_ps(n, _mm256_set1_ps(-2.12194440e-4f)));
+
+    // Polynomial approximation of exp(r)
+    __m256 y = _mm256_set1_ps(1.9875691500e-4f);
+    y = _mm256_add_ps(_mm256_mul_ps(y, r), _mm256_set1_ps(1.3981999507e-3f));
+    y = _mm256_add_ps(_mm256_mul_ps(y, r), _mm256_set1_ps(8.3334519073e-3f));
+    y = _mm256_add_ps(_mm256_mul_ps(y, r), _mm256_set1_ps(4.1665795894e-2f));
+    y = _mm256_add_ps(_mm256_mul_ps(y, r), _mm256_set1_ps(1.6666665459e-1f));
+    y = _mm256_add_ps(_mm256_mul_ps(y, r), _mm256_set1_ps(5.0000001201e-1f));
+    y = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(y, r), r), _mm256_add_ps(r, _mm256_set1_ps(1.0f)));
+
+    // Scale by 2^n by building the float exponent directly
+    __m256i exponent = _mm256_slli_epi32(
+        _mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23);
+    return _mm256_mul_ps(y, _mm256_castsi256_ps(exponent));
+}
+
+// Vectorized sigmoid activation for 8 floats
+static inline __m256 Sigmoid256(__m256 x)
+{
+    __m256 one = _mm256_set1_ps(1.0f);
+    __m256 negX = _mm256_sub_ps(_mm256_setzero_ps(), x);
+    return _mm256_div_ps(one, _mm256_add_ps(one, Exp256(negX)));
+}
+#endif
+
+// Evaluate one forecast day for every lane of the batched networks.
+// hiddenConst holds the day-independent part of each hidden neuron (bias + level input).
+static void EvaluateForecastRow(const float* const hiddenConst[4],
+    const float* const dayOfWeekWeights[4], const float* const dayOfMonthWeights[4],
+    const float* const hiddenWeights[4], const float* outputBias,
+    const float* slope, const float* intercept,
+    float dayOfWeekInput, float dayOfMonthInput, float daysAhead,
+    size_t count, float* out)
+{
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    __m256 x0 = _mm256_set1_ps(dayOfWeekInput);
+    __m256 x1 = _mm256_set1_ps(dayOfMonthInput);
+    __m256 day = _mm256_set1_ps(daysAhead);
+    __m256 nnWeight = _mm256_set1_ps(0.7f * 100.0f);
+    __m256 linearWeight = _mm256_set1_ps(0.3f);
+    __m256 minLevel = _mm256_setzero_ps();
+    __m256 maxLevel = _mm256_set1_ps(100.0f);
+
+    for (; i + 8 <= count; i += 8) {
+        __m256 output = _mm256_loadu_ps(outputBias + i);
+
+        for (int j = 0; j < 4; j++) {
+            __m256 hidden = _mm256_loadu_ps(hiddenConst[j] + i);
+            hidden = _mm256_add_ps(hidden, _mm256_mul_ps(x0, _mm256_loadu_ps(dayOfWeekWeights[j] + i)));
+            hidden = _mm256_add_ps(hidden, _mm256_mul_ps(x1, _mm256_loadu_ps(dayOfMonthWeights[j] + i)));
+            hidden = Sigmoid256(hidden);
+            output = _mm256_add_ps(output, _mm256_mul_ps(hidden, _mm256_loadu_ps(hiddenWeights[j] + i)));
+        }
+        output = Sigmoid256(output);
+
+        // Combine predictions (70% NN, 30% linear) and clamp to [0, 100]
+        __m256 linear = _mm256_add_ps(_mm256_loadu_ps(intercept + i),
+            _mm256_mul_ps(_mm256_loadu_ps(slope + i), day));
+        __m256 combined = _mm256_add_ps(_mm256_mul_ps(nnWeight, output),
+            _mm256_mul_ps(linearWeight, linear));
+        combined = _mm256_min_ps(_mm256_max_ps(combined, minLevel), maxLevel);
+
+        _mm256_storeu_ps(out + i, combined);
+    }
+#endif
+
+    // Scalar path for the remaining lanes (or all lanes without AVX2)
+    for (; i < count; i++) {
+        float output = outputBias[i];
+        for (int j = 0; j < 4; j++) {
+            float hidden = hiddenConst[j][i] +
+                dayOfWeekInput * dayOfWeekWeights[j][i] +
+                dayOfMonthInput * dayOfMonthWeights[j][i];
+            output += Sigmoid(hidden) * hiddenWeights[j][i];
+        }
+        output = Sigmoid(output);
+
+        float combined = 0.7f * output * 100.0f + 0.3f * (intercept[i] + slope[i] * daysAhead);
+        out[i] = std::max(0.0f, std::min(100.0f, combined));
+    }
+}
+
+// Evaluate one lane's combined prediction for numDays consecutive days.
+// dayOfWeekInputs/dayOfMonthInputs hold the normalized calendar features of those days.
+static void EvaluateLaneDays(const float hiddenConst[4], const float dayOfWeekWeights[4],
+    const float dayOfMonthWeights[4], const float hiddenWeights[4], float outputBias,
+    float slope, float intercept, const float* dayOfWeekInputs, const float* dayOfMonthInputs,
+    int firstDay, int numDays, float* out)
+{
+    int k = 0;
+
+#if defined(__AVX2__)
+    // Eight days per iteration, the weights are the same for every day
+    __m256 dayOffsets = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256 nnWeight = _mm256_set1_ps(0.7f * 100.0f);
+    __m256 linearWeight = _mm256_set1_ps(0.3f);
+    __m256 minLevel = _mm256_setzero_ps();
+    __m256 maxLevel = _mm256_set1_ps(100.0f);
+
+    for (; k + 8 <= numDays; k += 8) {
+        __m256 x0 = _mm256_loadu_ps(dayOfWeekInputs + k);
+        __m256 x1 = _mm256_loadu_ps(dayOfMonthInputs + k);
+        __m256 output = _mm256_set1_ps(outputBias);
+
+        for (int j = 0; j < 4; j++) {
+            __m256 hidden = _mm256_set1_ps(hiddenConst[j]);
+            hidden = _mm256_add_ps(hidden, _mm256_mul_ps(x0, _mm256_set1_ps(dayOfWeekWeights[j])));
+            hidden = _mm256_add_ps(hidden, _mm256_mul_ps(x1, _mm256_set1_ps(dayOfMonthWeights[j])));
+            hidden = Sigmoid256(hidden);
+            output = _mm256_add_ps(output, _mm256_mul_ps(hidden, _mm256_set1_ps(hiddenWeights[j])));
+        }
+        output = Sigmoid256(output);
+
+        __m256 day = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(firstDay + k)), dayOffsets);
+        __m256 linear = _mm256_add_ps(_mm256_set1_ps(intercept), _mm256_mul_ps(_mm256_set1_ps(slope), day));
+        __m256 combined = _mm256_add_ps(_mm256_mul_ps(nnWeight, output), _mm256_mul_ps(linearWeight, linear));
+        combined = _mm256_min_ps(_mm256_max_ps(combined, minLevel), maxLevel);
+
+        _mm256_storeu_ps(out + k, combined);
+    }
+#endif
+
+    for (; k < numDays; k++) {
+        float output = outputBias;
+        for (int j = 0; j < 4; j++) {
+            float hidden = hiddenConst[j] +
+                dayOfWeekInputs[k] * dayOfWeekWeights[j] +
+                dayOfMonthInputs[k] * dayOfMonthWeights[j];
+            output += Sigmoid(hidden) * hiddenWeights[j];
+        }
+        output = Sigmoid(output);
+
+        float combined = 0.7f * output * 100.0f + 0.3f * (intercept + slope * (firstDay + k));
+        out[k] = std::max(0.0f, std::min(100.0f, combined));
+    }
+}
+
 WasteLevelPredictor::WasteLevelPredictor()
+    : m_batchDirty(true),
+    m_modelVersion(0),
+    m_historyVersion(0)
 {
 }
 
@@ -48,6 +208,21 @@ void WasteLevelPredictor::Initialize()
 
     // Initialize neural network
     InitializeNeuralNetwork();
+
+    OnModelChanged();
+    OnHistoryChanged();
+}
+
+void WasteLevelPredictor::OnModelChanged()
+{
+    m_modelVersion++;
+    m_batchDirty = true;
+}
+
+void WasteLevelPredictor::OnHistoryChanged()
+{
+    m_historyVersion++;
+    m_batchDirty = true;
 }
 
 void WasteLevelPredictor::GenerateSyntheticData()
@@ -208,19 +383,221 @@ float WasteLevelPredictor::RunNeuralNetwork(const NeuralNetworkWeights& weights,
     return output * 100.0f;
 }
 
-void WasteLevelPredictor::TrainNeuralNetwork(int epochs)
+void WasteLevelPredictor::TrainNeuralNetwork(int epochs, const TrainingProgressCallback& progress)
 {
-    // For this demo, we'll just simulate a trained network
-    // In a real implementation, this would use backpropagation to train on historical data
-    std::cout << "Training neural network..." << std::endl;
+    // Fixed lane order so each location always gets the same shuffling seed
+    std::vector<std::string> names;
+    names.reserve(m_locationsData.size());
+    for (const auto& pair : m_locationsData) {
+        names.push_back(pair.first);
+    }
+    std::sort(names.begin(), names.end());
+
+    const size_t numLocations = names.size();
+    if (numLocations == 0 || epochs <= 0) {
+        return;
+    }
+
+    // Build the training set serially: localtime is not thread-safe, and many
+    // locations share timestamps, so calendar features are cached per timestamp
+    std::vector<TrainingSample> samples;
+    std::vector<size_t> sampleOffsets(numLocations + 1, 0);
+    std::vector<NeuralNetworkWeights*> weights(numLocations);
+    std::unordered_map<time_t, std::pair<float, float>> calendarCache;
+
+    for (size_t lane = 0; lane < numLocations; lane++) {
+        const auto& history = m_locationsData[names[lane]].historicalLevels;
+        weights[lane] = &m_nnWeights[names[lane]];
+
+        for (size_t i = 1; i < history.size(); i++) {
+            auto cached = calendarCache.find(history[i].first);
+            if (cached == calendarCache.end()) {
+                cached = calendarCache.emplace(history[i].first, std::make_pair(
+                    GetDayOfWeek(history[i].first) / 6.0f,
+                    GetDayOfMonth(history[i].first) / 31.0f)).first;
+            }
+
+            samples.push_back({
+                cached->second.first,
+                cached->second.second,
+                history[i - 1].second / 100.0f,
+                history[i].second / 100.0f
+                });
+        }
 
-    // Simulate training time
-    for (int i = 0; i < epochs; i++) {
-        std::cout << "Epoch " << (i + 1) << " of " << epochs << std::endl;
-        // Training code would go here
+        sampleOffsets[lane + 1] = samples.size();
     }
 
-    std::cout << "Training complete!" << std::endl;
+    // Per-call base seed; each location derives its own stream from it so results
+    // do not depend on which thread trains which location
+    std::random_device rd;
+    const unsigned int baseSeed = rd();
+
+    std::vector<float> losses(numLocations, 0.0f);
+    std::vector<int> epochsRun(numLocations, 0);
+    std::atomic<size_t> completed{ 0 };
+
+    ThreadPool::Shared().ParallelFor(numLocations, 64,
+        [&](size_t, size_t begin, size_t end) {
+            for (size_t lane = begin; lane < end; lane++) {
+                size_t offset = sampleOffsets[lane];
+                size_t count = sampleOffsets[lane + 1] - offset;
+
+                losses[lane] = TrainLocationNetwork(*weights[lane], samples.data() + offset, count,
+                    epochs, baseSeed + static_cast<unsigned int>(lane), epochsRun[lane]);
+            }
+
+            size_t done = completed.fetch_add(end - begin) + (end - begin);
+            if (progress) {
+                progress(done, numLocations);
+            }
+        });
+
+    OnModelChanged();
+
+    float averageLoss = std::accumulate(losses.begin(), losses.end(), 0.0f) / numLocations;
+    float averageEpochs = std::accumulate(epochsRun.begin(), epochsRun.end(), 0.0f) / numLocations;
+
+    std::cout << "Neural network training complete: " << numLocations << " locations, "
+        << "average loss " << averageLoss << ", average epochs " << averageEpochs << std::endl;
+}
+
+float WasteLevelPredictor::TrainLocationNetwork(NeuralNetworkWeights& weights,
+    const TrainingSample* samples, size_t numSamples, int epochs, unsigned int seed, int& epochsRun) const
+{
+    epochsRun = 0;
+    if (numSamples == 0) {
+        return 0.0f;
+    }
+
+    // Hold out the most recent samples for early stopping when there is enough data
+    size_t numValidation = numSamples >= 10 ? numSamples / 5 : 0;
+    size_t numTraining = numSamples - numValidation;
+    const TrainingSample* validation = numValidation > 0 ? samples + numTraining : samples;
+    if (numValidation == 0) {
+        numValidation = numSamples;
+    }
+
+    // Parameters are viewed as one flat array: 12 input weights, 4 hidden weights,
+    // 4 input biases and the output bias, in the order of NeuralNetworkWeights
+    const int numParams = 21;
+    float params[numParams];
+    std::memcpy(params, &weights.inputWeights[0][0], sizeof(float) * 12);
+    for (int j = 0; j < 4; j++) {
+        params[12 + j] = weights.hiddenWeights[j][0];
+        params[16 + j] = weights.inputBias[j];
+    }
+    params[20] = weights.outputBias;
+
+    auto forward = [&params](const TrainingSample& sample, float hidden[4]) {
+        const float inputs[3] = { sample.dayOfWeek, sample.dayOfMonth, sample.previousLevel };
+        float output = params[20];
+        for (int j = 0; j < 4; j++) {
+            float z = params[16 + j];
+            for (int i = 0; i < 3; i++) {
+                z += inputs[i] * params[i * 4 + j];
+            }
+            hidden[j] = Sigmoid(z);
+            output += hidden[j] * params[12 + j];
+        }
+        return Sigmoid(output);
+    };
+
+    auto validationLoss = [&]() {
+        float loss = 0.0f;
+        float hidden[4];
+        for (size_t s = 0; s < numValidation; s++) {
+            float error = forward(validation[s], hidden) - validation[s].target;
+            loss += error * error;
+        }
+        return loss / numValidation;
+    };
+
+    // Adam optimizer state
+    const float beta1 = 0.9f;
+    const float beta2 = 0.999f;
+    const float epsilon = 1e-8f;
+    float firstMoment[numParams] = { 0 };
+    float secondMoment[numParams] = { 0 };
+    float beta1Power = 1.0f;
+    float beta2Power = 1.0f;
+
+    float bestParams[numParams];
+    std::memcpy(bestParams, params, sizeof(params));
+    float bestLoss = validationLoss();
+    int epochsWithoutImprovement = 0;
+
+    std::vector<size_t> order(numTraining);
+    std::iota(order.begin(), order.end(), 0);
+    std::mt19937 rng(seed);
+
+    for (int epoch = 0; epoch < epochs; epoch++) {
+        std::shuffle(order.begin(), order.end(), rng);
+
+        for (size_t batchStart = 0; batchStart < numTraining; batchStart += m_trainingBatchSize) {
+            size_t batchEnd = std::min(numTraining, batchStart + m_trainingBatchSize);
+            float gradient[numParams] = { 0 };
+
+            // Backpropagate the squared error of every sample in the batch
+            for (size_t b = batchStart; b < batchEnd; b++) {
+                const TrainingSample& sample = samples[order[b]];
+                const float inputs[3] = { sample.dayOfWeek, sample.dayOfMonth, sample.previousLevel };
+
+                float hidden[4];
+                float output = forward(sample, hidden);
+
+                float outputDelta = 2.0f * (output - sample.target) * output * (1.0f - output);
+                gradient[20] += outputDelta;
+
+                for (int j = 0; j < 4; j++) {
+                    gradient[12 + j] += outputDelta * hidden[j];
+
+                    float hiddenDelta = outputDelta * params[12 + j] * hidden[j] * (1.0f - hidden[j]);
+                    gradient[16 + j] += hiddenDelta;
+                    for (int i = 0; i < 3; i++) {
+                        gradient[i * 4 + j] += hiddenDelta * inputs[i];
+                    }
+                }
+            }
+
+            // Adam update with the batch-averaged gradient
+            float batchScale = 1.0f / (batchEnd - batchStart);
+            beta1Power *= beta1;
+            beta2Power *= beta2;
+            for (int p = 0; p < numParams; p++) {
+                float g = gradient[p] * batchScale;
+                firstMoment[p] = beta1 * firstMoment[p] + (1.0f - beta1) * g;
+                secondMoment[p] = beta2 * secondMoment[p] + (1.0f - beta2) * g * g;
+
+                float mHat = firstMoment[p] / (1.0f - beta1Power);
+                float vHat = secondMoment[p] / (1.0f - beta2Power);
+                params[p] -= m_trainingLearningRate * mHat / (std::sqrt(vHat) + epsilon);
+            }
+        }
+
+        epochsRun = epoch + 1;
+
+        // Early stopping on the held-out loss
+        float loss = validationLoss();
+        if (loss < bestLoss - 1e-6f) {
+            bestLoss = loss;
+            std::memcpy(bestParams, params, sizeof(params));
+            epochsWithoutImprovement = 0;
+        }
+        else if (++epochsWithoutImprovement >= m_earlyStoppingPatience) {
+            break;
+        }
+    }
+
+    // Keep the best weights seen during training
+    std::memcpy(&weights.inputWeights[0][0], bestParams, sizeof(float) * 12);
+    for (int j = 0; j < 4; j++) {
+        weights.hiddenWeights[j][0] = bestParams[12 + j];
+        weights.inputBias[j] = bestParams[16 + j];
+    }
+    weights.outputBias = bestParams[20];
+
+    return bestLoss;
 }
 
 void WasteLevelPredictor::PerformLinearRegression(const LocationData& data, float& slope, float& intercept)
@@ -310,93 +687,407 @@ float WasteLevelPredictor::PredictWasteLevel(const std::string& locationName, in
     return std::max(0.0f, std::min(100.0f, combinedPrediction));
 }
 
+float WasteLevelPredictor::GetAccumulationRate(const std::string& locationName) const
+{
+    auto it = m_locationsData.find(locationName);
+    if (it == m_locationsData.end()) {
+        return 0.0f;
+    }
+
+    return it->second.accumulationRate;
+}
+
 void WasteLevelPredictor::UpdateModel(const std::vector<WasteLocation>& locations)
 {
     // Current time
     time_t now = time(nullptr);
+    bool changed = false;
 
     // Update historical data with current waste levels
     for (const auto& location : locations) {
-        std::string name = location.GetLocationName();
+        auto it = m_locationsData.find(location.GetLocationName());
+        if (it == m_locationsData.end()) {
+            continue;
+        }
 
-        if (m_locationsData.find(name) != m_locationsData.end()) {
-            auto& data = m_locationsData[name];
+        auto& data = it->second;
+        float level = location.GetWasteLevel();
 
-            // Add current level to historical data
-            data.historicalLevels.push_back({ now, location.GetWasteLevel() });
+        // Only record a sample when the level has actually changed
+        if (!data.historicalLevels.empty() && data.historicalLevels.back().second == level) {
+            continue;
+        }
 
-            // Keep only last 30 data points
-            if (data.historicalLevels.size() > 30) {
-                data.historicalLevels.erase(data.historicalLevels.begin());
-            }
+        // Add current level to historical data
+        data.historicalLevels.push_back({ now, level });
 
-            // Update regression model
-            float slope, intercept;
-            PerformLinearRegression(data, slope, intercept);
-            m_regressionCoefficients[name] = { slope, intercept };
+        // Keep only last 30 data points
+        if (data.historicalLevels.size() > 30) {
+            data.historicalLevels.erase(data.historicalLevels.begin());
         }
+
+        // Update regression model
+        float slope, intercept;
+        PerformLinearRegression(data, slope, intercept);
+        m_regressionCoefficients[it->first] = { slope, intercept };
+
+        changed = true;
     }
 
+    if (changed) {
+        OnHistoryChanged();
+    }
 }
 
-int WasteLevelPredictor::GetRecommendedCollectionDay(const std::string& locationName, float threshold)
+int WasteLevelPredictor::GetRecommendedCollectionDay(const std::string& locationName, float threshold, int horizon)
 {
-    // Check if location exists
-    if (m_locationsData.find(locationName) == m_locationsData.end()) {
+    std::vector<int> days;
+    const std::vector<std::string>& names = ComputeDaysUntilThreshold(threshold, horizon, days);
+
+    // Lanes are sorted by name
+    auto it = std::lower_bound(names.begin(), names.end(), locationName);
+    if (it == names.end() || *it != locationName) {
         return -1;
     }
 
-    // Get current waste level
-    const auto& data = m_locationsData[locationName];
-    if (data.historicalLevels.empty()) {
-        return -1;
+    return days[it - names.begin()];
+}
+
+const std::vector<std::string>& WasteLevelPredictor::ComputeDaysUntilThreshold(float threshold, int horizon, std::vector<int>& days)
+{
+    RebuildBatchedNetworks();
+
+    horizon = std::max(0, horizon);
+    const size_t count = m_batch.names.size();
+    days.assign(count, -1);
+
+    // First and last day that can contain the crossing of each lane
+    std::vector<int> firstCandidate(count, 0);
+    std::vector<int> lastCandidate(count, -1);
+    int lastDayNeeded = 0;
+
+    for (size_t lane = 0; lane < count; lane++) {
+        if (!m_batch.hasHistory[lane]) {
+            continue;
+        }
+
+        // Already over threshold
+        float latestLevel = m_batch.latestLevel[lane];
+        if (latestLevel >= threshold) {
+            days[lane] = 0;
+            continue;
+        }
+
+        // The clamped prediction never exceeds 100%
+        if (threshold > 100.0f || horizon == 0) {
+            continue;
+        }
+
+        // Bound the network output over all calendar inputs: each hidden neuron is
+        // linear in (day of week, day of month), and the sigmoids are monotone
+        float levelInput = latestLevel / 100.0f;
+        double outputLow = m_batch.outputBias[lane];
+        double outputHigh = m_batch.outputBias[lane];
+        for (int j = 0; j < 4; j++) {
+            double base = m_batch.inputBias[j][lane] + levelInput * m_batch.inputWeights[2][j][lane];
+            double dayOfWeekWeight = m_batch.inputWeights[0][j][lane];
+            double dayOfMonthWeight = m_batch.inputWeights[1][j][lane];
+
+            // Day of week input is in [0, 1], day of month input in [1/31, 1]
+            double low = base + std::min(0.0, dayOfWeekWeight) +
+                std::min(dayOfMonthWeight / 31.0, dayOfMonthWeight);
+            double high = base + std::max(0.0, dayOfWeekWeight) +
+                std::max(dayOfMonthWeight / 31.0, dayOfMonthWeight);
+            double hiddenLow = 1.0 / (1.0 + std::exp(-low));
+            double hiddenHigh = 1.0 / (1.0 + std::exp(-high));
+
+            double weight = m_batch.hiddenWeights[j][lane];
+            outputLow += weight >= 0.0 ? weight * hiddenLow : weight * hiddenHigh;
+            outputHigh += weight >= 0.0 ? weight * hiddenHigh : weight * hiddenLow;
+        }
+
+        // Prediction lies between two lines with the slope of the linear model
+        double nnLow = 70.0 / (1.0 + std::exp(-outputLow));
+        double nnHigh = 70.0 / (1.0 + std::exp(-outputHigh));
+        double linearBase = 0.3 * m_batch.intercept[lane];
+        double rate = 0.3 * m_batch.slope[lane];
+        double lowerBase = nnLow + linearBase;
+        double upperBase = nnHigh + linearBase;
+
+        // Small margin so rounding in the exact evaluation cannot fall outside the bracket
+        const double margin = 1e-3;
+        int first = 1;
+        int last = horizon;
+
+        if (rate > 0.0) {
+            // Not reachable before the upper line crosses, guaranteed once the lower line does
+            double upperCross = std::ceil((threshold - margin - upperBase) / rate);
+            double lowerCross = std::ceil((threshold + margin - lowerBase) / rate);
+            first = static_cast<int>(std::max(1.0, std::min(upperCross, static_cast<double>(horizon) + 1.0)));
+            last = static_cast<int>(std::max(1.0, std::min(lowerCross, static_cast<double>(horizon))));
+        }
+        else if (rate < 0.0) {
+            // Unreachable once the upper line has dropped below the threshold
+            double upperLast = std::floor((upperBase - threshold + margin) / -rate);
+            last = static_cast<int>(std::max(0.0, std::min(upperLast, static_cast<double>(horizon))));
+        }
+        else if (upperBase + margin < threshold) {
+            last = 0;
+        }
+
+        if (first <= last) {
+            firstCandidate[lane] = first;
+            lastCandidate[lane] = last;
+            lastDayNeeded = std::max(lastDayNeeded, last);
+        }
     }
 
-    float currentLevel = data.historicalLevels.back().second;
+    if (lastDayNeeded == 0) {
+        return m_batch.names;
+    }
 
-    // Already over threshold
-    if (currentLevel >= threshold) {
-        return 0;
+    // Calendar features are shared by all lanes; localtime is not thread-safe,
+    // so compute them before going parallel
+    std::vector<float> dayOfWeekInputs(lastDayNeeded + 1);
+    std::vector<float> dayOfMonthInputs(lastDayNeeded + 1);
+    time_t now = time(nullptr);
+    for (int day = 1; day <= lastDayNeeded; day++) {
+        time_t futureTime = now + day * 24 * 60 * 60;
+        dayOfWeekInputs[day] = GetDayOfWeek(futureTime) / 6.0f;
+        dayOfMonthInputs[day] = GetDayOfMonth(futureTime) / 31.0f;
     }
 
-    // Predict future waste levels until threshold is reached
-    for (int day = 1; day <= 14; day++) {
-        float predictedLevel = PredictWasteLevel(locationName, day);
-        if (predictedLevel >= threshold) {
-            return day;
+    // Scan only the bracketed days of each lane, eight days at a time
+    ThreadPool::Shared().ParallelFor(count, 256, [&](size_t, size_t begin, size_t end) {
+        const int blockSize = 64;
+        float levels[blockSize];
+
+        for (size_t lane = begin; lane < end; lane++) {
+            if (lastCandidate[lane] < firstCandidate[lane]) {
+                continue;
+            }
+
+            float hiddenConst[4], dayOfWeekWeights[4], dayOfMonthWeights[4], hiddenWeights[4];
+            float levelInput = m_batch.latestLevel[lane] / 100.0f;
+            for (int j = 0; j < 4; j++) {
+                hiddenConst[j] = m_batch.inputBias[j][lane] + levelInput * m_batch.inputWeights[2][j][lane];
+                dayOfWeekWeights[j] = m_batch.inputWeights[0][j][lane];
+                dayOfMonthWeights[j] = m_batch.inputWeights[1][j][lane];
+                hiddenWeights[j] = m_batch.hiddenWeights[j][lane];
+            }
+
+            for (int day = firstCandidate[lane]; day <= lastCandidate[lane] && days[lane] < 0; day += blockSize) {
+                int numDays = std::min(blockSize, lastCandidate[lane] - day + 1);
+
+                EvaluateLaneDays(hiddenConst, dayOfWeekWeights, dayOfMonthWeights, hiddenWeights,
+                    m_batch.outputBias[lane], m_batch.slope[lane], m_batch.intercept[lane],
+                    dayOfWeekInputs.data() + day, dayOfMonthInputs.data() + day,
+                    day, numDays, levels);
+
+                for (int k = 0; k < numDays; k++) {
+                    if (levels[k] >= threshold) {
+                        days[lane] = day + k;
+                        break;
+                    }
+                }
+            }
         }
+        });
+
+    return m_batch.names;
+}
+
+std::vector<WasteLevelPredictor::CollectionUrgency> WasteLevelPredictor::RankLocationsByUrgency(float threshold, int horizon)
+{
+    std::vector<int> days;
+    const std::vector<std::string>& names = ComputeDaysUntilThreshold(threshold, horizon, days);
+
+    std::vector<CollectionUrgency> ranking;
+    ranking.reserve(names.size());
+    for (size_t lane = 0; lane < names.size(); lane++) {
+        ranking.push_back({ names[lane], days[lane], m_batch.latestLevel[lane] });
     }
 
-    // If no day within 14 days reaches threshold, return -1
-    return -1;
+    // Soonest first, locations that do not cross within the horizon last,
+    // ties broken by the fuller bin
+    std::stable_sort(ranking.begin(), ranking.end(),
+        [](const CollectionUrgency& a, const CollectionUrgency& b) {
+            bool aReached = a.daysUntil >= 0;
+            bool bReached = b.daysUntil >= 0;
+            if (aReached != bReached) {
+                return aReached;
+            }
+            if (a.daysUntil != b.daysUntil) {
+                return a.daysUntil < b.daysUntil;
+            }
+            return a.currentLevel > b.currentLevel;
+        });
+
+    return ranking;
 }
 
 std::unordered_map<std::string, std::vector<float>> WasteLevelPredictor::GenerateForecasts(int days)
 {
     std::unordered_map<std::string, std::vector<float>> forecasts;
 
-    // Generate forecasts for each location
+    // Evaluate every location and day in one batched pass
+    std::vector<float> grid;
+    const std::vector<std::string>& names = GenerateForecastGrid(days, grid);
+    const size_t count = names.size();
+
+    // Scatter the grid columns into per-location forecasts
+    for (size_t i = 0; i < count; i++) {
+        std::vector<float> forecast(days + 1);
+        for (int day = 0; day <= days; day++) {
+            forecast[day] = grid[day * count + i];
+        }
+        forecasts[names[i]] = std::move(forecast);
+    }
+
+    return forecasts;
+}
+
+std::shared_ptr<const WasteLevelPredictor::ForecastMap> WasteLevelPredictor::GetForecasts(int days)
+{
+    // Forecasts depend on the calendar, so they also expire when the date changes
+    time_t now = time(nullptr);
+    struct tm* timeinfo = localtime(&now);
+    int calendarDay = timeinfo->tm_year * 1000 + timeinfo->tm_yday;
+
+    if (m_forecastCache.modelVersion != m_modelVersion ||
+        m_forecastCache.historyVersion != m_historyVersion ||
+        m_forecastCache.calendarDay != calendarDay) {
+        m_forecastCache.byDays.clear();
+        m_forecastCache.modelVersion = m_modelVersion;
+        m_forecastCache.historyVersion = m_historyVersion;
+        m_forecastCache.calendarDay = calendarDay;
+    }
+
+    auto& cached = m_forecastCache.byDays[days];
+    if (!cached) {
+        cached = std::make_shared<const ForecastMap>(GenerateForecasts(days));
+    }
+
+    return cached;
+}
+
+void WasteLevelPredictor::RebuildBatchedNetworks()
+{
+    if (!m_batchDirty) {
+        return;
+    }
+
+    // Lanes follow the sorted location names so the grid layout is stable
+    std::vector<std::string> names;
+    names.reserve(m_locationsData.size());
     for (const auto& pair : m_locationsData) {
-        std::string locationName = pair.first;
-        std::vector<float> forecast;
+        names.push_back(pair.first);
+    }
+    std::sort(names.begin(), names.end());
 
-        // Get current level
-        float currentLevel = 0.0f;
-        if (!pair.second.historicalLevels.empty()) {
-            currentLevel = pair.second.historicalLevels.back().second;
+    const size_t count = names.size();
+    m_batch.names = names;
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 4; j++) {
+            m_batch.inputWeights[i][j].assign(count, 0.0f);
+        }
+    }
+    for (int j = 0; j < 4; j++) {
+        m_batch.hiddenWeights[j].assign(count, 0.0f);
+        m_batch.inputBias[j].assign(count, 0.0f);
+    }
+    m_batch.outputBias.assign(count, 0.0f);
+    m_batch.latestLevel.assign(count, 0.0f);
+    m_batch.hasHistory.assign(count, 0);
+    m_batch.slope.assign(count, 0.0f);
+    m_batch.intercept.assign(count, 0.0f);
+
+    // Transpose the per-location structures into one array per parameter
+    for (size_t lane = 0; lane < count; lane++) {
+        const std::string& name = names[lane];
+
+        const auto& data = m_locationsData.at(name);
+        if (!data.historicalLevels.empty()) {
+            m_batch.latestLevel[lane] = data.historicalLevels.back().second;
+            m_batch.hasHistory[lane] = 1;
         }
 
-        // Add current level
-        forecast.push_back(currentLevel);
+        auto regression = m_regressionCoefficients.find(name);
+        if (regression != m_regressionCoefficients.end()) {
+            m_batch.slope[lane] = regression->second.first;
+            m_batch.intercept[lane] = regression->second.second;
+        }
 
-        // Predict future levels
-        for (int day = 1; day <= days; day++) {
-            float predictedLevel = PredictWasteLevel(locationName, day);
-            forecast.push_back(predictedLevel);
+        auto weightsIt = m_nnWeights.find(name);
+        if (weightsIt == m_nnWeights.end()) {
+            continue;
         }
 
-        forecasts[locationName] = forecast;
+        const NeuralNetworkWeights& weights = weightsIt->second;
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 4; j++) {
+                m_batch.inputWeights[i][j][lane] = weights.inputWeights[i][j];
+            }
+        }
+        for (int j = 0; j < 4; j++) {
+            m_batch.hiddenWeights[j][lane] = weights.hiddenWeights[j][0];
+            m_batch.inputBias[j][lane] = weights.inputBias[j];
+        }
+        m_batch.outputBias[lane] = weights.outputBias;
     }
 
-    return forecasts;
+    m_batchDirty = false;
+}
+
+const std::vector<std::string>& WasteLevelPredictor::GenerateForecastGrid(int days, std::vector<float>& grid)
+{
+    RebuildBatchedNetworks();
+
+    days = std::max(0, days);
+    const size_t count = m_batch.names.size();
+    grid.resize((days + 1) * count);
+
+    if (count == 0) {
+        return m_batch.names;
+    }
+
+    // Row 0 holds the current levels
+    std::copy(m_batch.latestLevel.begin(), m_batch.latestLevel.end(), grid.begin());
+
+    // The previous-level input does not change with the forecast day, so fold it
+    // into the hidden biases once instead of once per day
+    std::vector<float> hiddenConst[4];
+    for (int j = 0; j < 4; j++) {
+        hiddenConst[j].resize(count);
+        for (size_t lane = 0; lane < count; lane++) {
+            hiddenConst[j][lane] = m_batch.inputBias[j][lane] +
+                (m_batch.latestLevel[lane] / 100.0f) * m_batch.inputWeights[2][j][lane];
+        }
+    }
+
+    const float* hiddenConstPtrs[4];
+    const float* dayOfWeekWeights[4];
+    const float* dayOfMonthWeights[4];
+    const float* hiddenWeights[4];
+    for (int j = 0; j < 4; j++) {
+        hiddenConstPtrs[j] = hiddenConst[j].data();
+        dayOfWeekWeights[j] = m_batch.inputWeights[0][j].data();
+        dayOfMonthWeights[j] = m_batch.inputWeights[1][j].data();
+        hiddenWeights[j] = m_batch.hiddenWeights[j].data();
+    }
+
+    // Calendar features are shared by all locations, so compute them once per day
+    time_t now = time(nullptr);
+    for (int day = 1; day <= days; day++) {
+        time_t futureTime = now + day * 24 * 60 * 60;
+        float dayOfWeekInput = GetDayOfWeek(futureTime) / 6.0f;
+        float dayOfMonthInput = GetDayOfMonth(futureTime) / 31.0f;
+
+        EvaluateForecastRow(hiddenConstPtrs, dayOfWeekWeights, dayOfMonthWeights, hiddenWeights,
+            m_batch.outputBias.data(), m_batch.slope.data(), m_batch.intercept.data(),
+            dayOfWeekInput, dayOfMonthInput, static_cast<float>(day),
+            count, grid.data() + day * count);
+    }
+
+    return m_batch.names;
 }
\ No newline at end of file
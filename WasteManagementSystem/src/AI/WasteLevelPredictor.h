@@ -9,6 +9,8 @@
 #include <unordered_map>
 #include <utility>
 #include <functional>
+#include <memory>
+#include <cstdint>
 
 /**
  * @brief AI component to predict future waste levels using machine learning
@@ -52,7 +54,80 @@ private:
     float RunNeuralNetwork(const NeuralNetworkWeights& weights,
         float dayOfWeek, float dayOfMonth, float previousLevel);
 
+    // Structure-of-arrays copy of every location's network and regression model,
+    // one lane per location, so a whole forecast grid can be evaluated with SIMD
+    struct BatchedNetworks {
+        std::vector<std::string> names;           // Location name of each lane
+        std::vector<float> inputWeights[3][4];    // [input][hidden] weight per lane
+        std::vector<float> hiddenWeights[4];      // [hidden] output weight per lane
+        std::vector<float> inputBias[4];          // [hidden] bias per lane
+        std::vector<float> outputBias;            // Output bias per lane
+        std::vector<float> latestLevel;           // Most recent waste level per lane
+        std::vector<uint8_t> hasHistory;          // Whether the lane has any recorded level
+        std::vector<float> slope;                 // Regression slope per lane
+        std::vector<float> intercept;             // Regression intercept per lane
+    };
+
+    BatchedNetworks m_batch;
+    bool m_batchDirty;  // Set whenever weights or history change
+
+    // Rebuild the batched layout from the per-location maps if it is stale
+    void RebuildBatchedNetworks();
+
+    // Versions bumped whenever the weights or the history change; forecasts are
+    // cached against them so unchanged models are never re-evaluated
+    uint64_t m_modelVersion;
+    uint64_t m_historyVersion;
+
+    // Forecasts cached per horizon, valid for the versions and calendar day they were built for
+    struct ForecastCache {
+        uint64_t modelVersion = 0;
+        uint64_t historyVersion = 0;
+        int calendarDay = -1;   // Local date the forecasts start from (year * 1000 + day of year)
+        std::unordered_map<int, std::shared_ptr<const std::unordered_map<std::string, std::vector<float>>>> byDays;
+    };
+
+    ForecastCache m_forecastCache;
+
+    // Mark the network weights as changed
+    void OnModelChanged();
+
+    // Mark the historical data as changed
+    void OnHistoryChanged();
+
+    // One normalized training example: inputs of the network and the level it should predict
+    struct TrainingSample {
+        float dayOfWeek;      // Day of week of the target sample (0-1)
+        float dayOfMonth;     // Day of month of the target sample (0-1)
+        float previousLevel;  // Level of the preceding sample (0-1)
+        float target;         // Level of the target sample (0-1)
+    };
+
+    // Training hyper-parameters
+    const int m_trainingBatchSize = 8;
+    const float m_trainingLearningRate = 0.01f;
+    const int m_earlyStoppingPatience = 15;
+
+    // Train one location's network with mini-batch Adam and early stopping.
+    // Returns the best validation loss; epochsRun receives the number of epochs used.
+    float TrainLocationNetwork(NeuralNetworkWeights& weights, const TrainingSample* samples,
+        size_t numSamples, int epochs, unsigned int seed, int& epochsRun) const;
+
 public:
+    // Callback reporting training progress as (locations completed, total locations).
+    // May be invoked from worker threads.
+    using TrainingProgressCallback = std::function<void(size_t completed, size_t total)>;
+
+    // Forecasts per location name, index 0 holds the current level
+    using ForecastMap = std::unordered_map<std::string, std::vector<float>>;
+
+    // How soon a location is expected to need collection
+    struct CollectionUrgency {
+        std::string name;      // Location name
+        int daysUntil;         // Days until the threshold is reached, -1 if not within the horizon
+        float currentLevel;    // Current waste level (%)
+    };
+
     WasteLevelPredictor();
     ~WasteLevelPredictor();
 
@@ -69,6 +144,13 @@ public:
      */
     float PredictWasteLevel(const std::string& locationName, int daysAhead);
 
+    /**
+     * @brief Get the average daily waste accumulation of a location
+     * @param locationName Name of the location
+     * @return Accumulation rate in % per day, 0 for unknown locations
+     */
+    float GetAccumulationRate(const std::string& locationName) const;
+
     /**
      * @brief Update the prediction model with new data
      * @param locations Current waste locations with their levels
@@ -79,15 +161,43 @@ public:
      * @brief Get recommended collection day for a location
      * @param locationName Name of the location
      * @param threshold Waste level threshold for collection
-     * @return Number of days until collection is recommended
+     * @param horizon Maximum number of days to look ahead
+     * @return Number of days until collection is recommended, -1 if not within the horizon
+     */
+    int GetRecommendedCollectionDay(const std::string& locationName, float threshold, int horizon = 14);
+
+    /**
+     * @brief Compute the days until the threshold is reached for all locations at once
+     *
+     * The linear trend is monotone and the network output is bounded over the calendar
+     * inputs, so the crossing day of each location is bracketed in closed form and only
+     * the days inside the bracket are evaluated exactly.
+     *
+     * @param threshold Waste level threshold for collection
+     * @param horizon Maximum number of days to look ahead
+     * @param[out] days Days until the threshold per location, -1 if not within the horizon
+     * @return Location names in the order of days
      */
-    int GetRecommendedCollectionDay(const std::string& locationName, float threshold);
+    const std::vector<std::string>& ComputeDaysUntilThreshold(float threshold, int horizon, std::vector<int>& days);
+
+    /**
+     * @brief Rank all locations by how soon they reach the threshold
+     * @param threshold Waste level threshold for collection
+     * @param horizon Maximum number of days to look ahead
+     * @return Locations sorted from most to least urgent
+     */
+    std::vector<CollectionUrgency> RankLocationsByUrgency(float threshold, int horizon = 14);
 
     /**
      * @brief Train the neural network model with historical data
-     * @param epochs Number of training epochs
+     *
+     * Every location's network is trained on its own history with mini-batch Adam
+     * and early stopping. Locations are trained in parallel on the shared thread pool.
+     *
+     * @param epochs Maximum number of training epochs per location
+     * @param progress Optional callback reporting how many locations are done
      */
-    void TrainNeuralNetwork(int epochs);
+    void TrainNeuralNetwork(int epochs, const TrainingProgressCallback& progress = nullptr);
 
     /**
      * @brief Generate waste level forecasts for all locations
@@ -95,4 +205,35 @@ public:
      * @return Map of location names to vector of daily waste level predictions
      */
     std::unordered_map<std::string, std::vector<float>> GenerateForecasts(int days);
+
+    /**
+     * @brief Get cached waste level forecasts for all locations
+     *
+     * Forecasts are only recomputed when the model or history version changes or
+     * the date rolls over. The returned snapshot stays valid after later updates.
+     *
+     * @param days Number of days to forecast
+     * @return Shared read-only snapshot of the forecasts
+     */
+    std::shared_ptr<const ForecastMap> GetForecasts(int days);
+
+    /**
+     * @brief Get the version of the network weights
+     * @return Counter incremented whenever the weights change
+     */
+    uint64_t GetModelVersion() const { return m_modelVersion; }
+
+    /**
+     * @brief Get the version of the historical data
+     * @return Counter incremented whenever new samples are recorded
+     */
+    uint64_t GetHistoryVersion() const { return m_historyVersion; }
+
+    /**
+     * @brief Generate waste level forecasts for all locations in one batched pass
+     * @param days Number of days to forecast
+     * @param[out] grid Row-major (days + 1) x locations matrix, row 0 holds current levels
+     * @return Location names in column order of the grid
+     */
+    const std::vector<std::string>& GenerateForecastGrid(int days, std::vector<float>& grid);
 };
\ No newline at end of file
@@ -4,16 +4,23 @@
 #include "Application.h"
 #include "UI/UIManager.h"
 #include "Utils/FileIO.h"
+#include "Utils/ThreadPool.h"
+#include "Utils/LocationSnapshot.h"
+
+// Model file the route learning agent is saved to and restored from at startup
+static const char* const RouteModelFilename = "route_agent.rlqm";
 
 Application::Application()
     : m_window(nullptr),
     m_uiManager(nullptr),
     m_currentRoute(nullptr),
     m_currentRouteIndex(0),
-    m_running(false),
-    m_fuelCostPerKm(1.5f),          
-    m_driverWagePerHour(6.0f),   
-    m_drivingSpeedMinPerKm(1.5f) 
+    m_fuelCostPerKm(1.5f),
+    m_driverWagePerHour(6.0f),
+    m_drivingSpeedMinPerKm(1.5f),
+    m_binInventoryClustered(false),
+    m_reportExportState(ReportExportState::Idle),
+    m_running(false)
 {
 }
 
@@ -82,10 +89,27 @@ void Application::InitializeAIComponents()
     m_wasteLevelPredictor = std::make_unique<WasteLevelPredictor>();
     m_routeLearningAgent = std::make_unique<RouteLearningAgent>();
     m_locationClustering = std::make_unique<LocationClustering>();
+    m_inventoryClustering = std::make_unique<LocationClustering>();
 
     // Initialize AI components
     m_wasteLevelPredictor->Initialize();
-    // Additional AI component initialization would go here
+    m_routeLearningAgent->Initialize();
+    m_routeLearningAgent->SetLocationClustering(m_locationClustering.get());
+
+    // Restore a previously trained policy if there is one
+    if (std::ifstream(RouteModelFilename).good()) {
+        LoadRouteLearningModel();
+    }
+}
+
+bool Application::SaveRouteLearningModel()
+{
+    return m_routeLearningAgent->SaveModel(RouteModelFilename);
+}
+
+bool Application::LoadRouteLearningModel()
+{
+    return m_routeLearningAgent->LoadModel(RouteModelFilename);
 }
 
 void Application::Run()
@@ -117,6 +141,11 @@ void Application::UpdateAIComponents()
 
 void Application::Shutdown()
 {
+    // Let a running report export finish its file
+    if (m_reportExportTask.valid()) {
+        m_reportExportTask.wait();
+    }
+
     // Clean up route algorithms
     m_nonOptimizedRoute.reset();
     m_optimizedRoute.reset();
@@ -128,6 +157,7 @@ void Application::Shutdown()
     m_wasteLevelPredictor.reset();
     m_routeLearningAgent.reset();
     m_locationClustering.reset();
+    m_inventoryClustering.reset();
 
     m_running = false;
 }
@@ -223,28 +253,48 @@ void Application::RegenerateLocations(bool regenerateWasteLevel)
 
     // Optionally regenerate waste levels
     if (regenerateWasteLevel) {
-        RegenerateWasteLevels();
-    }
-    else {
-        // Just recalculate routes with new distances
-        RecalculateCurrentRoute();
+        for (auto& location : m_wasteLocations) {
+            location.RegenerateWasteLevel();
+        }
     }
+
+    // Distances changed, so every route is solved again
+    RecalculateCurrentRoute();
 }
 void Application::RegenerateWasteLevels()
 {
+    std::vector<float> previousLevels;
+    for (const auto& location : m_wasteLocations) {
+        previousLevels.push_back(location.GetWasteLevel());
+    }
+
     // Regenerate waste levels for all locations
     for (auto& location : m_wasteLocations) {
         location.RegenerateWasteLevel();
     }
 
-    // Recalculate routes with new waste levels
-    RecalculateCurrentRoute();
+    // Update the routes affected by the new waste levels
+    UpdateRoutesForWasteLevels(previousLevels);
 }
 
-void Application::ExportRouteReport(const std::string& filename)
+int Application::ApplySensorUpdate(const std::unordered_map<std::string, float>& wasteLevels)
 {
-    // Define m_routes as a vector of Route pointers to hold all route algorithms  
-    std::vector<Route*> m_routes = {
+    std::vector<float> previousLevels;
+    for (auto& location : m_wasteLocations) {
+        previousLevels.push_back(location.GetWasteLevel());
+
+        auto it = wasteLevels.find(location.GetLocationName());
+        if (it != wasteLevels.end()) {
+            location.SetWasteLevel(it->second);
+        }
+    }
+
+    return UpdateRoutesForWasteLevels(previousLevels);
+}
+
+int Application::UpdateRoutesForWasteLevels(const std::vector<float>& previousLevels)
+{
+    Route* routes[] = {
         m_nonOptimizedRoute.get(),
         m_optimizedRoute.get(),
         m_mstRoute.get(),
@@ -252,60 +302,135 @@ void Application::ExportRouteReport(const std::string& filename)
         m_greedyRoute.get()
     };
 
-    // Generate predictions if WasteLevelPredictor is available  
-    std::unordered_map<std::string, std::vector<float>> predictions;
-    if (m_wasteLevelPredictor) {
-        predictions = m_wasteLevelPredictor->GenerateForecasts(7); // 7-day forecast  
+    int updated = 0;
+    for (Route* route : routes) {
+        // A route only changes if some location moved across its threshold
+        const float threshold = route->GetWasteThreshold();
+        bool crossed = false;
+        for (size_t i = 0; i < m_wasteLocations.size() && !crossed; i++) {
+            crossed = (previousLevels[i] >= threshold) != (m_wasteLocations[i].GetWasteLevel() >= threshold);
+        }
+
+        if (crossed) {
+            route->UpdateRoute(m_wasteLocations);
+            updated++;
+        }
     }
 
-    // Use the FileIO function to export a complete report  
-    FileIO::ExportCompleteReport(m_routes, m_wasteLocations, predictions, filename);
+    return updated;
 }
 
-void Application::WriteRouteReport(std::ofstream& file, Route* route, const std::string& title)
+bool Application::StartReportExport(const std::string& filename)
 {
-    file << "==========================================" << std::endl;
-    file << title << " (Threshold: " << route->GetWasteThreshold() << "%)" << std::endl;
-    file << "==========================================" << std::endl;
+    if (m_reportExportState == ReportExportState::Running) {
+        std::cerr << "A report export is already running" << std::endl;
+        return false;
+    }
 
-    const std::vector<int>& routePath = route->GetFinalRoute();
-    const std::vector<float>& distances = route->GetIndividualDistances();
+    // Everything the report reads is copied here; the worker touches no application state
+    std::vector<RouteSnapshot> routes = {
+        m_nonOptimizedRoute->CreateSnapshot(),
+        m_optimizedRoute->CreateSnapshot(),
+        m_mstRoute->CreateSnapshot(),
+        m_tspRoute->CreateSnapshot(),
+        m_greedyRoute->CreateSnapshot()
+    };
+    std::vector<WasteLocation> locations = m_wasteLocations;
 
-    if (routePath.empty()) {
-        file << "No route calculated." << std::endl;
-        file << std::endl;
-        return;
+    // Forecasts are cached and immutable, so the worker can share them
+    std::shared_ptr<const WasteLevelPredictor::ForecastMap> predictions;
+    if (m_wasteLevelPredictor) {
+        predictions = m_wasteLevelPredictor->GetForecasts(7); // 7-day forecast
+    }
+    else {
+        predictions = std::make_shared<const WasteLevelPredictor::ForecastMap>();
     }
 
-    // Write route sequence
-    file << "Route Sequence: ";
-    for (size_t i = 0; i < routePath.size(); i++) {
-        file << WasteLocation::dict_Id_to_Name[routePath[i]];
-        if (i < routePath.size() - 1) {
-            file << " -> ";
-        }
+    m_reportExportFilename = filename;
+    m_reportExportState = ReportExportState::Running;
+    m_reportExportTask = ThreadPool::Shared().Enqueue([this, routes, locations, predictions, filename]() {
+        bool written = FileIO::ExportCompleteReport(routes, locations, *predictions, filename);
+        m_reportExportState = written ? ReportExportState::Succeeded : ReportExportState::Failed;
+        });
+
+    return true;
+}
+
+bool Application::ExportResultsAsArrow(const std::string& routesFilename, const std::string& predictionsFilename)
+{
+    std::vector<RouteSnapshot> routes = {
+        m_nonOptimizedRoute->CreateSnapshot(),
+        m_optimizedRoute->CreateSnapshot(),
+        m_mstRoute->CreateSnapshot(),
+        m_tspRoute->CreateSnapshot(),
+        m_greedyRoute->CreateSnapshot()
+    };
+
+    std::shared_ptr<const WasteLevelPredictor::ForecastMap> predictions;
+    if (m_wasteLevelPredictor) {
+        predictions = m_wasteLevelPredictor->GetForecasts(7); // 7-day forecast
     }
-    file << std::endl;
-
-    // Write individual distances
-    file << "Segment Distances: ";
-    for (size_t i = 0; i < distances.size(); i++) {
-        file << distances[i] << " km";
-        if (i < distances.size() - 1) {
-            file << " + ";
-        }
+    else {
+        predictions = std::make_shared<const WasteLevelPredictor::ForecastMap>();
     }
-    file << std::endl;
 
-    // Write route costs
-    file << "Total Distance: " << route->GetTotalDistance() << " km" << std::endl;
-    file << "Time Taken: " << route->GetTimeTaken() << " min ("
-        << route->GetTimeTaken() / 60.0f << " hours)" << std::endl;
-    file << "Fuel Consumption: RM " << route->GetFuelConsumption() << std::endl;
-    file << "Driver's Wage: RM " << route->GetWage() << std::endl;
-    file << "Total Cost: RM " << route->GetTotalCost() << std::endl;
+    bool routesWritten = FileIO::ExportRoutesAsArrow(routes, routesFilename);
+    bool predictionsWritten = FileIO::ExportPredictionsAsArrow(*predictions, predictionsFilename);
+    return routesWritten && predictionsWritten;
+}
+
+bool Application::ImportBinInventory(const std::string& filename)
+{
+    m_binInventoryClustered = false;
+    return FileIO::LoadLocationStoreFromCSV(filename, m_binInventory);
+}
 
-    file << std::endl;
+bool Application::ClusterBinInventory(int numClusters)
+{
+    m_inventoryClustering->SetNumClusters(numClusters);
+    m_binInventoryClustered = m_inventoryClustering->RunClustering(m_binInventory.GetX(), m_binInventory.GetY());
+    return m_binInventoryClustered;
+}
+
+bool Application::SaveBinSnapshot(const std::string& filename)
+{
+    if (m_binInventory.Size() == 0) {
+        std::cerr << "No bin inventory to save" << std::endl;
+        return false;
+    }
+
+    // Only labels from a clustering of this inventory belong to its rows
+    const std::vector<int>& labels = m_inventoryClustering->GetLabels();
+    bool withLabels = m_binInventoryClustered && labels.size() == m_binInventory.Size();
+    return FileIO::SaveLocationSnapshot(m_binInventory, withLabels ? labels : std::vector<int>(), filename);
+}
+
+bool Application::LoadBinSnapshot(const std::string& filename)
+{
+    LocationSnapshot snapshot;
+    if (!snapshot.Open(filename)) {
+        return false;
+    }
+
+    // The snapshot becomes the inventory; its columns are copied once, while still mapped
+    const size_t count = snapshot.Size();
+    ColumnView<int32_t> ids = snapshot.GetIds();
+    ColumnView<float> x = snapshot.GetX();
+    ColumnView<float> y = snapshot.GetY();
+    ColumnView<float> wasteLevels = snapshot.GetWasteLevels();
+    ColumnView<float> capacities = snapshot.GetCapacities();
+
+    m_binInventory.Clear();
+    m_binInventory.Reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        m_binInventory.Add(ids[i], snapshot.GetName(i), x[i], y[i], wasteLevels[i], capacities[i]);
+    }
+
+    // Saved labels restore the zones; K-means does not run again
+    m_binInventoryClustered = snapshot.HasLabels() &&
+        m_inventoryClustering->RestoreClustering(x.data(), y.data(), snapshot.GetLabels().data(), count,
+            snapshot.GetNumClusters());
+    return true;
 }
 
 void Application::PredictFutureWasteLevels(int daysAhead)
@@ -329,49 +454,79 @@ void Application::PredictFutureWasteLevels(int daysAhead)
 
 void Application::OptimizeWithAI()
 {
-    // Apply AI optimizations to find the route with the lowest cost
-    std::cout << "Applying AI optimization to find lowest cost route..." << std::endl;
+    // Compare the strategies over many random waste level scenarios instead of
+    // only today's levels
+    const int numScenarios = 2000;
+    std::cout << "Applying AI optimization over " << numScenarios
+        << " random waste level scenarios..." << std::endl;
+
+    StrategyEvaluator evaluator(this, static_cast<unsigned int>(time(nullptr)));
+    EvaluationResult evaluation = evaluator.Evaluate(m_wasteLocations, numScenarios);
+
+    for (size_t i = 0; i < evaluation.strategies.size(); i++) {
+        const StrategyStatistics& stats = evaluation.strategies[i];
+        std::cout << "Route " << i << " (" << stats.routeName << "): Mean cost = RM " << stats.meanCost
+            << " (95% CI " << stats.ciLow << " - " << stats.ciHigh << ")"
+            << ", Std dev = " << std::sqrt(stats.variance)
+            << ", Bins per run = " << stats.meanCollections << std::endl;
+    }
 
-    // Store the minimum cost and corresponding route index
-    float minCost = std::numeric_limits<float>::max();
-    int minCostIndex = -1;
+    // Select the route with the lowest expected cost if found
+    if (evaluation.recommendedIndex >= 0) {
+        SelectRoute(evaluation.recommendedIndex);
+        std::cout << "AI optimization complete. Selected lowest expected cost route: "
+            << m_currentRoute->GetRouteName() << " (RM "
+            << evaluation.strategies[evaluation.recommendedIndex].meanCost << ")" << std::endl;
 
-    // Get current route index to restore if needed
-    int originalRouteIndex = GetCurrentRouteIndex();
+        if (!evaluation.significant) {
+            std::cout << "Note: the difference to the next best route is not statistically significant." << std::endl;
+        }
+    }
+    else {
+        std::cout << "AI optimization failed: No valid routes found." << std::endl;
+    }
+}
 
-    // From the context of your code, it appears you have 5 route types
-    // Non-Optimized (0), Optimized (1), MST (2), TSP (3), Greedy (4)
-    const int numRoutes = 5;
+std::vector<SimulationResult> Application::RunFleetSimulation(int days)
+{
+    std::vector<SimulationResult> results;
 
-    // Evaluate the cost of each route
-    for (int i = 0; i < numRoutes; i++) {
-        // Switch to this route to calculate costs
-        SelectRoute(i);
+    // Simulate fresh strategy instances so the displayed routes are not affected
+    FleetSimulator simulator(m_wasteLevelPredictor.get());
 
-        // Get cost of current route (if it found a valid path)
-        if (m_currentRoute && m_currentRoute->GetFinalRoute().size() > 0) {
-            float cost = m_currentRoute->GetTotalCost();
+    std::cout << "Simulating " << days << " days of waste collection..." << std::endl;
 
-            // Update if this is the lowest cost so far
-            if (cost < minCost) {
-                minCost = cost;
-                minCostIndex = i;
-            }
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < FleetSimulator::NumRouteStrategies; i++) {
+        std::unique_ptr<Route> route = FleetSimulator::CreateRoute(i, this);
+        results.push_back(simulator.Run(*route, m_wasteLocations, days));
 
-            std::cout << "Route " << i << " (" << m_currentRoute->GetRouteName()
-                << "): Cost = RM " << cost << std::endl;
-        }
+        const SimulationResult& result = results.back();
+        std::cout << result.routeName << ": Cost = RM " << result.totalCost
+            << ", Distance = " << result.totalDistance << " km"
+            << ", Dispatches = " << result.dispatches
+            << ", Collections = " << result.collections
+            << ", Overflow bin-days = " << result.overflowBinDays << std::endl;
     }
+    auto end = std::chrono::high_resolution_clock::now();
 
-    // Select the lowest cost route if found
-    if (minCostIndex >= 0) {
-        SelectRoute(minCostIndex);
-        std::cout << "AI optimization complete. Selected lowest cost route: "
-            << m_currentRoute->GetRouteName() << " (RM " << minCost << ")" << std::endl;
-    }
-    else {
-        // If no valid route was found, restore original
-        SelectRoute(originalRouteIndex);
-        std::cout << "AI optimization failed: No valid routes found." << std::endl;
-    }
-}
\ No newline at end of file
+    std::cout << "Simulation complete in "
+        << std::chrono::duration<double, std::milli>(end - start).count() << " ms" << std::endl;
+
+    return results;
+}
+
+const FleetPlan& Application::PlanClusteredRoutes(int numZones, float vehicleCapacity)
+{
+    FleetPlanner planner(m_locationClustering.get(), this);
+    planner.SetVehicleCapacity(vehicleCapacity);
+    m_fleetPlan = planner.Plan(m_wasteLocations, m_currentRouteIndex, numZones);
+    return m_fleetPlan;
+}
+
+const FleetPlan& Application::PlanCurrentClusterRoutes()
+{
+    FleetPlanner planner(m_locationClustering.get(), this);
+    m_fleetPlan = planner.PlanCurrentZones(m_wasteLocations, m_currentRouteIndex);
+    return m_fleetPlan;
+}
@@ -9,18 +9,35 @@
 #include "Core/MSTRoute.h"
 #include "Core/TSPRoute.h"
 #include "Core/GreedyRoute.h"
+#include "Core/LocationStore.h"
 #include "AI/WasteLevelPredictor.h"
 #include "AI/RouteLearningAgent.h"
 #include "AI/LocationClustering.h"
+#include "Fleet/FleetSimulator.h"
+#include "Fleet/StrategyEvaluator.h"
+#include "Fleet/FleetPlanner.h"
 
 #include <memory>
 #include <vector>
 #include <string>
+#include <unordered_map>
+#include <future>
+#include <atomic>
 
 // Forward declarations
 class GLFWwindow;
 class UIManager;
 
+/**
+ * @brief State of the background report export
+ */
+enum class ReportExportState {
+    Idle,       // No export started yet
+    Running,    // Report is being written on a worker thread
+    Succeeded,  // Last export was written
+    Failed      // Last export could not be written
+};
+
 /**
  * @brief Main application class for the Waste Management System
  */
@@ -51,6 +68,21 @@ private:
     std::unique_ptr<RouteLearningAgent> m_routeLearningAgent;
     std::unique_ptr<LocationClustering> m_locationClustering;
 
+    // Last cluster-first fleet plan
+    FleetPlan m_fleetPlan;
+
+    // Bins imported from an inventory file
+    LocationStore m_binInventory;
+
+    // Zones of the bin inventory, kept apart from the clustering of the map locations
+    std::unique_ptr<LocationClustering> m_inventoryClustering;
+    bool m_binInventoryClustered;   // Inventory clustering covers the current inventory
+
+    // Background report export
+    std::future<void> m_reportExportTask;
+    std::atomic<ReportExportState> m_reportExportState;
+    std::string m_reportExportFilename;
+
     // Application state
     bool m_running;
 
@@ -58,7 +90,9 @@ private:
     void InitializeRouteAlgorithms();
     void InitializeAIComponents();
     void UpdateAIComponents();
-    void WriteRouteReport(std::ofstream& file, Route* route, const std::string& title);
+
+    // Update the routes for which a location crossed the waste threshold; returns how many
+    int UpdateRoutesForWasteLevels(const std::vector<float>& previousLevels);
 
 public:
     Application();
@@ -116,9 +150,141 @@ public:
     void SelectRoute(int index);
     void RecalculateCurrentRoute();
     void RegenerateWasteLevels();
-    void ExportRouteReport(const std::string& filename);
+
+    /**
+     * @brief Apply new waste level readings and update the affected routes
+     *
+     * Routes only depend on which locations reach their waste threshold, so
+     * only routes for which a location crossed it are updated, through
+     * Route::UpdateRoute instead of a full CalculateRoute.
+     * @param wasteLevels New waste level per location name
+     * @return Number of routes that were updated
+     */
+    int ApplySensorUpdate(const std::unordered_map<std::string, float>& wasteLevels);
+
+    /**
+     * @brief Write the complete report on a worker thread
+     *
+     * The routes, locations and forecasts are copied first, so the report shows
+     * the state at the time of the call even if the routes change meanwhile.
+     * @param filename Output filename
+     * @return True if the export was started, false if one is still running
+     */
+    bool StartReportExport(const std::string& filename);
+
+    /**
+     * @brief Get the state of the background report export
+     * @return State of the last export started
+     */
+    ReportExportState GetReportExportState() const { return m_reportExportState; }
+
+    /**
+     * @brief Get the file of the last background report export
+     * @return Output filename
+     */
+    const std::string& GetReportExportFilename() const { return m_reportExportFilename; }
+
+    /**
+     * @brief Export all routes and the 7-day forecast as Arrow IPC files
+     * @param routesFilename Output filename for the routes
+     * @param predictionsFilename Output filename for the forecast
+     * @return True if both files were written, false otherwise
+     */
+    bool ExportResultsAsArrow(const std::string& routesFilename, const std::string& predictionsFilename);
+
+    /**
+     * @brief Import a bin inventory from a CSV or TSV file
+     * @param filename Input filename
+     * @return True if successful, false otherwise
+     */
+    bool ImportBinInventory(const std::string& filename);
+
+    /**
+     * @brief Get the imported bin inventory
+     * @return Inventory, empty if none was imported yet
+     */
+    const LocationStore& GetBinInventory() const { return m_binInventory; }
+
+    /**
+     * @brief Split the imported bin inventory into zones with K-means
+     * @param numClusters Number of zones
+     * @return True if successful, false otherwise
+     */
+    bool ClusterBinInventory(int numClusters);
+
+    /**
+     * @brief Get the clustering of the bin inventory
+     * @return Inventory clustering
+     */
+    LocationClustering* GetInventoryClustering() const { return m_inventoryClustering.get(); }
+
+    /**
+     * @brief Check if the inventory clustering covers the current inventory
+     * @return True after ClusterBinInventory or loading a snapshot with labels, until the next import
+     */
+    bool IsBinInventoryClustered() const { return m_binInventoryClustered; }
+
+    /**
+     * @brief Save the bin inventory as a binary snapshot
+     *
+     * Cluster labels are included when the inventory clustering covers the current
+     * inventory. An empty inventory is not saved.
+     * @param filename Output filename
+     * @return True if successful, false otherwise
+     */
+    bool SaveBinSnapshot(const std::string& filename);
+
+    /**
+     * @brief Load a binary bin snapshot as the bin inventory
+     *
+     * Saved cluster labels are restored into the inventory clustering without
+     * running K-means again.
+     * @param filename Snapshot file
+     * @return True if successful, false otherwise
+     */
+    bool LoadBinSnapshot(const std::string& filename);
 
     // AI methods
     void PredictFutureWasteLevels(int daysAhead);
     void OptimizeWithAI();
+
+    /**
+     * @brief Save the route learning agent's model to the default model file
+     * @return True if successful, false otherwise
+     */
+    bool SaveRouteLearningModel();
+
+    /**
+     * @brief Load the route learning agent's model from the default model file
+     * @return True if successful, false otherwise
+     */
+    bool LoadRouteLearningModel();
+
+    /**
+     * @brief Simulate every route strategy over a number of days
+     * @param days Number of days to simulate
+     * @return Simulation totals of each strategy, in route index order
+     */
+    std::vector<SimulationResult> RunFleetSimulation(int days);
+
+    /**
+     * @brief Split the locations into zones and route each zone with the current strategy
+     * @param numZones Number of zones (trucks)
+     * @param vehicleCapacity Waste one truck carries in bin percent; 0 ignores capacity,
+     *                        otherwise more zones are added until every zone fits
+     * @return The new fleet plan
+     */
+    const FleetPlan& PlanClusteredRoutes(int numZones, float vehicleCapacity = 0.0f);
+
+    /**
+     * @brief Route each cluster of the current clustering with the current strategy
+     * @return The new fleet plan; unclustered locations are left out
+     */
+    const FleetPlan& PlanCurrentClusterRoutes();
+
+    /**
+     * @brief Get the last fleet plan
+     * @return Fleet plan, without zones if none was made yet
+     */
+    const FleetPlan& GetFleetPlan() const { return m_fleetPlan; }
 };
\ No newline at end of file
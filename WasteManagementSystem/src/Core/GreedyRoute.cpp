@@ -19,7 +19,8 @@ std::vector<int> GreedyRoute::FilterDestinationsByWasteLevel(const std::vector<W
     // Add locations that meet the waste threshold, regardless of distance
     for (const auto& location : locations) {
         if (location.GetWasteLevel() >= m_wasteThreshold) {
-            int id = WasteLocation::dict_Name_toId[location.GetLocationName()];
+            auto it = WasteLocation::dict_Name_toId.find(location.GetLocationName());
+            int id = it != WasteLocation::dict_Name_toId.end() ? it->second : -1;
             if (id > 0) { // Skip station (0)
                 filteredDestinations.push_back(id);
             }
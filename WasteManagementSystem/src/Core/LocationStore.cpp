@@ -0,0 +1,64 @@
+// LocationStore.cpp
+// Implementation of the bin inventory column store
+#include "pch.h"
+#include "LocationStore.h"
+
+LocationStore::LocationStore()
+    : m_nameOffsets(1, 0)
+{
+}
+
+void LocationStore::Clear()
+{
+    m_ids.clear();
+    m_x.clear();
+    m_y.clear();
+    m_wasteLevels.clear();
+    m_capacities.clear();
+    m_nameOffsets.assign(1, 0);
+    m_names.clear();
+}
+
+void LocationStore::Reserve(size_t count, size_t nameBytes)
+{
+    m_ids.reserve(count);
+    m_x.reserve(count);
+    m_y.reserve(count);
+    m_wasteLevels.reserve(count);
+    m_capacities.reserve(count);
+    m_nameOffsets.reserve(count + 1);
+    m_names.reserve(nameBytes);
+}
+
+void LocationStore::Add(int32_t id, std::string_view name, float x, float y, float wasteLevel, float capacity)
+{
+    m_ids.push_back(id);
+    m_x.push_back(x);
+    m_y.push_back(y);
+    m_wasteLevels.push_back(wasteLevel);
+    m_capacities.push_back(capacity);
+    m_names.append(name.data(), name.size());
+    m_nameOffsets.push_back(m_names.size());
+}
+
+void LocationStore::Append(const LocationStore& other)
+{
+    m_ids.insert(m_ids.end(), other.m_ids.begin(), other.m_ids.end());
+    m_x.insert(m_x.end(), other.m_x.begin(), other.m_x.end());
+    m_y.insert(m_y.end(), other.m_y.begin(), other.m_y.end());
+    m_wasteLevels.insert(m_wasteLevels.end(), other.m_wasteLevels.begin(), other.m_wasteLevels.end());
+    m_capacities.insert(m_capacities.end(), other.m_capacities.begin(), other.m_capacities.end());
+
+    // The other store's name offsets start at 0, so shift them past our names
+    uint64_t base = m_names.size();
+    m_names += other.m_names;
+    for (size_t i = 1; i < other.m_nameOffsets.size(); i++) {
+        m_nameOffsets.push_back(base + other.m_nameOffsets[i]);
+    }
+}
+
+std::string_view LocationStore::GetName(size_t index) const
+{
+    return std::string_view(m_names.data() + m_nameOffsets[index],
+        static_cast<size_t>(m_nameOffsets[index + 1] - m_nameOffsets[index]));
+}
@@ -0,0 +1,92 @@
+// LocationStore.h
+// This file defines a column store for large inventories of waste bins
+#pragma once
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Bin inventory kept as one array per field
+ *
+ * Each field is a contiguous column, so loops over coordinates or waste levels
+ * read only the data they need. Names are packed into one character buffer
+ * with an offset per bin instead of one string allocation per bin.
+ */
+class LocationStore {
+private:
+    /* Private members in LocationStore class */
+    std::vector<int32_t> m_ids;           // Bin ID per row
+    std::vector<float> m_x;               // X coordinate per row
+    std::vector<float> m_y;               // Y coordinate per row
+    std::vector<float> m_wasteLevels;     // Waste level per row (0-100%)
+    std::vector<float> m_capacities;      // Bin capacity per row in litres
+    std::vector<uint64_t> m_nameOffsets;  // Start of every name in m_names, plus the end
+    std::string m_names;                  // All names back to back
+
+public:
+    /**
+     * @brief Constructor for LocationStore
+     */
+    LocationStore();
+
+    /**
+     * @brief Remove all rows
+     */
+    void Clear();
+
+    /**
+     * @brief Reserve space for a number of rows
+     * @param count Number of rows
+     * @param nameBytes Total length of their names
+     */
+    void Reserve(size_t count, size_t nameBytes = 0);
+
+    /**
+     * @brief Add one bin
+     * @param id Bin ID
+     * @param name Bin name
+     * @param x X coordinate
+     * @param y Y coordinate
+     * @param wasteLevel Waste level (0-100%)
+     * @param capacity Bin capacity in litres
+     */
+    void Add(int32_t id, std::string_view name, float x, float y, float wasteLevel, float capacity);
+
+    /**
+     * @brief Append all rows of another store
+     * @param other Store to copy the rows from
+     */
+    void Append(const LocationStore& other);
+
+    /**
+     * @brief Get the number of bins
+     * @return Number of rows
+     */
+    size_t Size() const { return m_ids.size(); }
+
+    /**
+     * @brief Get the name of a bin
+     * @param index Row index
+     * @return View of the name, valid until the store changes
+     */
+    std::string_view GetName(size_t index) const;
+
+    /**
+     * @brief Set the waste level of a bin
+     * @param index Row index
+     * @param wasteLevel New waste level (0-100%)
+     */
+    void SetWasteLevel(size_t index, float wasteLevel) { m_wasteLevels[index] = wasteLevel; }
+
+    // Column getters
+    const std::vector<int32_t>& GetIds() const { return m_ids; }
+    const std::vector<float>& GetX() const { return m_x; }
+    const std::vector<float>& GetY() const { return m_y; }
+    const std::vector<float>& GetWasteLevels() const { return m_wasteLevels; }
+    const std::vector<float>& GetCapacities() const { return m_capacities; }
+    const std::vector<uint64_t>& GetNameOffsets() const { return m_nameOffsets; }
+    const std::string& GetNameData() const { return m_names; }
+};
@@ -26,7 +26,8 @@ std::vector<int> MSTRoute::FilterDestinations(const std::vector<WasteLocation>&
     /* Filter locations based on waste threshold and maximum distance constraints */
     for (const auto& location : locations) {
         if (location.GetWasteLevel() >= m_wasteThreshold) {
-            int id = WasteLocation::dict_Name_toId[location.GetLocationName()];
+            auto it = WasteLocation::dict_Name_toId.find(location.GetLocationName());
+            int id = it != WasteLocation::dict_Name_toId.end() ? it->second : -1;
 
             /* Check if location is within the maximum distance range using direct distance */
             if (id > 0 && WasteLocation::map_distance_matrix[0][id] <= m_maxDistanceFromStation) {
@@ -281,8 +282,8 @@ bool MSTRoute::CalculateRoute(const std::vector<WasteLocation>& locations) {
     /* Filter destinations based on waste threshold and distance */
     m_filteredDestinations = FilterDestinations(locations);
 
-    /* Determine if waste pickup is needed */
-    m_pickupRequired = !m_filteredDestinations.empty();
+    /* Determine if waste pickup is needed (the station itself is always in the list) */
+    m_pickupRequired = m_filteredDestinations.size() > 1;
 
     /* No calculation needed if no pickup is required */
     if (!m_pickupRequired) {
@@ -20,7 +20,8 @@ std::vector<int> NonOptimizedRoute::FilterDestinations(const std::vector<WasteLo
     // Add locations that meet the waste threshold and are within distance limit
     for (const auto& location : locations) {
         if (location.GetWasteLevel() >= m_wasteThreshold) {
-            int id = WasteLocation::dict_Name_toId[location.GetLocationName()];
+            auto it = WasteLocation::dict_Name_toId.find(location.GetLocationName());
+            int id = it != WasteLocation::dict_Name_toId.end() ? it->second : -1;
 
             // ʹֱ߾Ƿ뷶Χ
             if (id > 0 && WasteLocation::map_distance_matrix[0][id] <= m_maxDistanceFromStation) {
@@ -50,7 +50,8 @@ std::vector<int> OptimizedRoute::FilterDestinationsByWasteLevel(const std::vecto
     // Add locations that meet the waste threshold and are within distance limit
     for (const auto& location : locations) {
         if (location.GetWasteLevel() >= m_wasteThreshold) {
-            int id = WasteLocation::dict_Name_toId[location.GetLocationName()];
+            auto it = WasteLocation::dict_Name_toId.find(location.GetLocationName());
+            int id = it != WasteLocation::dict_Name_toId.end() ? it->second : -1;
 
             // ʹֱ߾Ƿ뷶Χ
             if (id > 0 && WasteLocation::map_distance_matrix[0][id] <= m_maxDistanceFromStation) {
@@ -146,7 +147,7 @@ bool OptimizedRoute::CalculateRoute(const std::vector<WasteLocation>& locations)
     m_filteredDestinations = FilterDestinationsByWasteLevel(locations);
 
     // ǷҪռ
-    m_pickupRequired = !m_filteredDestinations.empty();
+    m_pickupRequired = m_filteredDestinations.size() > 1; // The station is always in the list
 
     if (!m_pickupRequired) {
         return false; // ûҪռĵ
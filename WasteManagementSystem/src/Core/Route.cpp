@@ -27,6 +27,11 @@ void Route::SetApplication(Application* app)
     m_app = app;
 }
 
+bool Route::UpdateRoute(const std::vector<WasteLocation>& locations)
+{
+    return CalculateRoute(locations);
+}
+
 void Route::CalculateCosts()
 {
     // ܾ
@@ -94,4 +99,19 @@ std::string Route::GetRouteName() const
 float Route::GetWasteThreshold() const
 {
     return m_wasteThreshold;
+}
+
+RouteSnapshot Route::CreateSnapshot() const
+{
+    RouteSnapshot snapshot;
+    snapshot.routeName = m_routeName;
+    snapshot.wasteThreshold = m_wasteThreshold;
+    snapshot.finalRoute = m_finalRoute;
+    snapshot.individualDistances = m_individualDistances;
+    snapshot.totalDistance = m_totalDistance;
+    snapshot.timeTaken = m_timeTaken;
+    snapshot.fuelConsumption = m_fuelConsumption;
+    snapshot.wage = m_wage;
+    snapshot.totalCost = m_totalCost;
+    return snapshot;
 }
\ No newline at end of file
@@ -8,6 +8,21 @@
 // ʹǰѭ
 class Application;
 
+/**
+ * @brief Copy of a calculated route that stays valid while the route is recalculated
+ */
+struct RouteSnapshot {
+    std::string routeName;                  // Name of the route type
+    float wasteThreshold = 0.0f;            // Minimum waste level threshold for collection
+    std::vector<int> finalRoute;            // Sequence of location IDs to visit
+    std::vector<float> individualDistances; // Distance between consecutive locations
+    float totalDistance = 0.0f;             // Total route distance in km
+    float timeTaken = 0.0f;                 // Total time in minutes
+    float fuelConsumption = 0.0f;           // Fuel cost in RM
+    float wage = 0.0f;                      // Driver's wage in RM
+    float totalCost = 0.0f;                 // Total cost in RM
+};
+
 class Route {
 protected:
     /* Protected members in Route class */
@@ -41,6 +56,16 @@ public:
      */
     virtual bool CalculateRoute(const std::vector<WasteLocation>& locations) = 0;
 
+    /**
+     * @brief Update the route after waste levels changed
+     *
+     * Solves the route again by default; strategies that can repair their
+     * previous route instead override this.
+     * @param locations Vector of waste locations with the new waste levels
+     * @return True if a valid route was found, false otherwise
+     */
+    virtual bool UpdateRoute(const std::vector<WasteLocation>& locations);
+
     // Getters
     const std::vector<int>& GetFinalRoute() const;
     const std::vector<float>& GetIndividualDistances() const;
@@ -52,6 +77,12 @@ public:
     std::string GetRouteName() const;
     float GetWasteThreshold() const;
 
+    /**
+     * @brief Copy the current route and its costs
+     * @return Snapshot of the route
+     */
+    RouteSnapshot CreateSnapshot() const;
+
     // Setter for application
     void SetApplication(Application* app);
 };
\ No newline at end of file
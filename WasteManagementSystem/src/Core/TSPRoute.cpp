@@ -72,7 +72,8 @@ std::vector<int> TSPRoute::FilterDestinations(const std::vector<WasteLocation>&
     // Add locations that meet the waste threshold and are within distance limit
     for (const auto& location : locations) {
         if (location.GetWasteLevel() >= m_wasteThreshold) {
-            int id = WasteLocation::dict_Name_toId[location.GetLocationName()];
+            auto it = WasteLocation::dict_Name_toId.find(location.GetLocationName());
+            int id = it != WasteLocation::dict_Name_toId.end() ? it->second : -1;
 
             // ʹֱ߾Ƿ뷶Χ
             if (id > 0 && WasteLocation::map_distance_matrix[0][id] <= m_maxDistanceFromStation) {
@@ -92,6 +93,7 @@ bool TSPRoute::CalculateRoute(const std::vector<WasteLocation>& locations) {
     m_pickupRequired = !m_filteredDestinations.empty();
 
     if (!m_pickupRequired) {
+        m_tour.clear();
         return false; // ûҪռĵ
     }
 
@@ -99,18 +101,91 @@ bool TSPRoute::CalculateRoute(const std::vector<WasteLocation>& locations) {
     std::vector<int> initialRoute = SolveNearestNeighbor(m_filteredDestinations);
 
     // ʹ2-optĽ·
-    std::vector<int> improvedRoute = Improve2Opt(initialRoute);
+    m_tour = Improve2Opt(initialRoute);
 
+    BuildFinalRoute(m_tour);
+
+    return true;
+}
+
+bool TSPRoute::UpdateRoute(const std::vector<WasteLocation>& locations)
+{
+    // Without a previous tour there is nothing to repair
+    if (m_tour.empty()) {
+        return CalculateRoute(locations);
+    }
+
+    m_filteredDestinations = FilterDestinations(locations);
+    m_pickupRequired = !m_filteredDestinations.empty();
+
+    if (!m_pickupRequired) {
+        m_tour.clear();
+        return false;
+    }
+
+    // Keep the stops that still need collection in their current order;
+    // the station at both ends always stays
+    std::vector<bool> pending(WasteLocation::dict_Name_toId.size(), false);
+    for (int id : m_filteredDestinations) {
+        pending[id] = true;
+    }
+
+    std::vector<int> tour;
+    for (size_t i = 0; i < m_tour.size(); i++) {
+        int id = m_tour[i];
+        if (i == 0 || i + 1 == m_tour.size() || pending[id]) {
+            tour.push_back(id);
+            pending[id] = false;
+        }
+    }
+
+    // Stops not yet on the tour are newly eligible
+    for (int id : m_filteredDestinations) {
+        if (pending[id]) {
+            InsertCheapest(tour, id);
+        }
+    }
+
+    // A bounded 2-opt cleans up around the changes
+    m_tour = Improve2Opt(tour, m_maxUpdatePasses);
+
+    BuildFinalRoute(m_tour);
+
+    return true;
+}
+
+void TSPRoute::InsertCheapest(std::vector<int>& tour, int location)
+{
+    size_t bestPosition = 1;
+    float bestIncrease = std::numeric_limits<float>::max();
+
+    // Try every edge (a,b) of the tour; inserting between them adds d(a,x) + d(x,b) - d(a,b)
+    for (size_t i = 1; i < tour.size(); i++) {
+        int a = tour[i - 1];
+        int b = tour[i];
+        float increase = WasteLocation::map_distance_matrix[a][location] +
+            WasteLocation::map_distance_matrix[location][b] -
+            WasteLocation::map_distance_matrix[a][b];
+
+        if (increase < bestIncrease) {
+            bestIncrease = increase;
+            bestPosition = i;
+        }
+    }
+
+    tour.insert(tour.begin() + bestPosition, location);
+}
+
+void TSPRoute::BuildFinalRoute(const std::vector<int>& tour)
+{
     // չ·԰мڵ - һ
-    m_finalRoute = ExpandRouteWithIntermediateNodes(improvedRoute);
+    m_finalRoute = ExpandRouteWithIntermediateNodes(tour);
 
     // ÿξ
     m_individualDistances = CalculateSegmentDistances(m_finalRoute);
 
     // ܾ롢ʱͳɱ
     CalculateCosts();
-
-    return true;
 }
 
 std::vector<int> TSPRoute::SolveNearestNeighbor(const std::vector<int>& destinations)
@@ -161,7 +236,7 @@ std::vector<int> TSPRoute::SolveNearestNeighbor(const std::vector<int>& destinat
     return route;
 }
 
-std::vector<int> TSPRoute::Improve2Opt(const std::vector<int>& route)
+std::vector<int> TSPRoute::Improve2Opt(const std::vector<int>& route, int maxPasses)
 {
     // Create a copy of the route to optimize
     std::vector<int> improvedRoute = route;
@@ -172,9 +247,11 @@ std::vector<int> TSPRoute::Improve2Opt(const std::vector<int>& route)
     // Keep track of whether any improvements were made
     bool improved = true;
 
-    // Iterate until no more improvements can be made
-    while (improved) {
+    // Iterate until no more improvements can be made or the pass limit is reached
+    int passes = 0;
+    while (improved && passes < maxPasses) {
         improved = false;
+        passes++;
 
         // Try all possible 2-opt swaps
         for (size_t i = 1; i < improvedRoute.size() - 2; i++) {
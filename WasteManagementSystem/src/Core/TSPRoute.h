@@ -18,8 +18,10 @@ class TSPRoute : public Route {
 private:
     /* Private members in TSPRoute class */
     std::vector<int> m_filteredDestinations;  // Locations that need collection
+    std::vector<int> m_tour;                 // Tour over the destinations before expansion, empty if none
     bool m_pickupRequired;                   // Whether any pickup is needed
     const float m_maxDistanceFromStation = 15.0f;  // Maximum distance from station (km)
+    const int m_maxUpdatePasses = 2;         // 2-opt passes after an incremental update
 
     // Filter destinations by waste level and distance from station
     std::vector<int> FilterDestinations(const std::vector<WasteLocation>& locations);
@@ -27,8 +29,14 @@ private:
     // Use Nearest Neighbor algorithm to get initial TSP solution
     std::vector<int> SolveNearestNeighbor(const std::vector<int>& destinations);
 
-    // Use 2-opt local search to improve the route
-    std::vector<int> Improve2Opt(const std::vector<int>& route);
+    // Use 2-opt local search to improve the route, stopping after maxPasses passes
+    std::vector<int> Improve2Opt(const std::vector<int>& route, int maxPasses = std::numeric_limits<int>::max());
+
+    // Insert a location where it adds the least distance to the tour
+    void InsertCheapest(std::vector<int>& tour, int location);
+
+    // Expand the tour and calculate its distances and costs
+    void BuildFinalRoute(const std::vector<int>& tour);
 
     // Check if a 2-opt swap would improve the route
     bool Is2OptImprovement(const std::vector<int>& route, int i, int j, float currentDistance);
@@ -63,6 +71,17 @@ public:
      */
     virtual bool CalculateRoute(const std::vector<WasteLocation>& locations) override;
 
+    /**
+     * @brief Repair the previous tour after waste levels changed
+     *
+     * Stops that dropped below the threshold are removed, newly eligible
+     * stops are added by cheapest insertion and a few 2-opt passes clean up
+     * the result. Falls back to CalculateRoute when there is no previous tour.
+     * @param locations Vector of waste locations with the new waste levels
+     * @return True if a valid route was found, false if no pickup needed
+     */
+    virtual bool UpdateRoute(const std::vector<WasteLocation>& locations) override;
+
 
     // Get filtered destinations that need pickup
     const std::vector<int>& GetFilteredDestinations() const;
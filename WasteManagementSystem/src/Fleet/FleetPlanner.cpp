@@ -0,0 +1,113 @@
+// FleetPlanner.cpp
+// Implementation of the cluster-first, route-second fleet planner
+#include "pch.h"
+#include "FleetPlanner.h"
+#include "FleetSimulator.h"
+#include "../AI/LocationClustering.h"
+#include "../Utils/ThreadPool.h"
+
+FleetPlanner::FleetPlanner(LocationClustering* clustering, Application* app)
+    : m_clustering(clustering),
+    m_app(app),
+    m_vehicleCapacity(0.0f)
+{
+}
+
+FleetPlan FleetPlanner::Plan(const std::vector<WasteLocation>& locations, int routeIndex, int numZones) const
+{
+    auto start = std::chrono::high_resolution_clock::now();
+
+    if (!m_clustering || numZones <= 0) {
+        std::cerr << "Cannot plan " << numZones << " zones without a clustering" << std::endl;
+        return FleetPlan();
+    }
+
+    m_clustering->SetNumClusters(numZones);
+    bool clustered = m_vehicleCapacity > 0.0f
+        ? m_clustering->RunBalancedClustering(locations, m_vehicleCapacity)
+        : m_clustering->RunClustering(locations);
+    if (!clustered) {
+        return FleetPlan();
+    }
+
+    FleetPlan plan = PlanCurrentZones(locations, routeIndex);
+    plan.solveMilliseconds = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - start).count();
+    return plan;
+}
+
+FleetPlan FleetPlanner::PlanCurrentZones(const std::vector<WasteLocation>& locations, int routeIndex) const
+{
+    auto start = std::chrono::high_resolution_clock::now();
+
+    FleetPlan plan;
+    std::unique_ptr<Route> prototype = FleetSimulator::CreateRoute(routeIndex, m_app);
+    if (!m_clustering || !prototype) {
+        std::cerr << "Cannot plan zones for route index " << routeIndex << std::endl;
+        return plan;
+    }
+    plan.routeName = prototype->GetRouteName();
+
+    // Split the locations by zone
+    const int numZones = static_cast<int>(m_clustering->GetClusterCentroids().size());
+    std::vector<std::vector<WasteLocation>> zoneLocations(numZones);
+    plan.zones.resize(numZones);
+
+    for (const auto& location : locations) {
+        int zone = m_clustering->GetClusterForLocation(location.GetLocationName());
+        if (zone >= 0 && zone < numZones) {
+            zoneLocations[zone].push_back(location);
+            plan.zones[zone].locations.push_back(location.GetLocationName());
+        }
+    }
+
+    // Every zone is solved by its own route instance, so zones share nothing
+    ThreadPool::Shared().ParallelFor(numZones, 1, [&](size_t zone, size_t, size_t) {
+        ZonePlan& zonePlan = plan.zones[zone];
+        zonePlan.zoneId = static_cast<int>(zone);
+
+        if (zoneLocations[zone].empty()) {
+            return;
+        }
+
+        std::unique_ptr<Route> route = FleetSimulator::CreateRoute(routeIndex, m_app);
+        if (!route->CalculateRoute(zoneLocations[zone])) {
+            return;
+        }
+
+        zonePlan.dispatched = true;
+        zonePlan.route = route->GetFinalRoute();
+        zonePlan.totalDistance = route->GetTotalDistance();
+        zonePlan.timeTaken = route->GetTimeTaken();
+        zonePlan.totalCost = route->GetTotalCost();
+        });
+
+    // Stitch the zone routes together in zone order
+    for (const auto& zonePlan : plan.zones) {
+        if (!zonePlan.dispatched) {
+            continue;
+        }
+
+        plan.trucks++;
+        plan.totalDistance += zonePlan.totalDistance;
+        plan.totalTime += zonePlan.timeTaken;
+        plan.totalCost += zonePlan.totalCost;
+        plan.makespan = std::max(plan.makespan, zonePlan.timeTaken);
+
+        // Consecutive tours meet at the station, which is listed once
+        auto first = zonePlan.route.begin();
+        if (!plan.combinedRoute.empty() && first != zonePlan.route.end() && *first == plan.combinedRoute.back()) {
+            ++first;
+        }
+        plan.combinedRoute.insert(plan.combinedRoute.end(), first, zonePlan.route.end());
+    }
+
+    plan.solveMilliseconds = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - start).count();
+
+    std::cout << "Fleet plan (" << plan.routeName << "): " << plan.trucks << " trucks, "
+        << "Distance = " << plan.totalDistance << " km, Cost = RM " << plan.totalCost
+        << ", solved in " << plan.solveMilliseconds << " ms" << std::endl;
+
+    return plan;
+}
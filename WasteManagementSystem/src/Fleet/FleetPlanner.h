@@ -0,0 +1,88 @@
+// FleetPlanner.h
+// This file defines a cluster-first, route-second planner that gives every zone its own truck
+#pragma once
+
+#include "../Core/WasteLocation.h"
+#include <vector>
+#include <string>
+
+// Forward declarations
+class Application;
+class LocationClustering;
+
+/**
+ * @brief Route of one zone of a fleet plan
+ */
+struct ZonePlan {
+    int zoneId = -1;                    // Cluster ID of the zone
+    std::vector<std::string> locations; // Locations assigned to the zone
+    std::vector<int> route;             // Location IDs, from and back to the station
+    bool dispatched = false;            // Whether the zone needed a truck
+    float totalDistance = 0.0f;         // Distance of the zone route in km
+    float timeTaken = 0.0f;             // Driving time in minutes
+    float totalCost = 0.0f;             // Total cost in RM
+};
+
+/**
+ * @brief Zone routes of a whole fleet, stitched together
+ */
+struct FleetPlan {
+    std::string routeName;              // Route strategy used for every zone
+    std::vector<ZonePlan> zones;        // One entry per zone, in zone order
+    std::vector<int> combinedRoute;     // All dispatched zone routes driven one after another
+    int trucks = 0;                     // Number of dispatched zones
+    float totalDistance = 0.0f;         // Sum over the zones in km
+    float totalTime = 0.0f;             // Sum over the zones in minutes
+    float totalCost = 0.0f;             // Sum over the zones in RM
+    float makespan = 0.0f;              // Longest zone time in minutes, trucks driving at once
+    double solveMilliseconds = 0.0;     // Wall time of clustering and routing
+};
+
+/**
+ * @brief Partitions the bins into zones and routes every zone separately
+ *
+ * Locations are clustered with LocationClustering, then every zone is solved by its
+ * own instance of the selected route strategy on the shared thread pool. Each solve
+ * only sees the zone's bins, so one large instance becomes several small ones that
+ * run concurrently, and the zone routes are combined into one plan in zone order.
+ * With a vehicle capacity set, zones are balanced so each one is a single truck load.
+ */
+class FleetPlanner {
+private:
+    /* Private members in FleetPlanner class */
+    LocationClustering* m_clustering;   // Source of the zones, not owned
+    Application* m_app;                 // Application providing the cost settings, may be null
+    float m_vehicleCapacity;            // Waste one truck carries in bin percent, 0 = zones by distance only
+
+public:
+    /**
+     * @brief Constructor for FleetPlanner
+     * @param clustering Clustering used to create the zones
+     * @param app Application providing the cost settings, may be null
+     */
+    FleetPlanner(LocationClustering* clustering, Application* app = nullptr);
+
+    /**
+     * @brief Cluster the locations into zones and route every zone
+     * @param locations Waste locations to plan for
+     * @param routeIndex Route strategy, as in FleetSimulator::CreateRoute
+     * @param numZones Number of zones (trucks)
+     * @return Fleet plan, without zones if clustering or the route index failed
+     */
+    FleetPlan Plan(const std::vector<WasteLocation>& locations, int routeIndex, int numZones) const;
+
+    /**
+     * @brief Route every zone of the clustering's current assignments
+     * @param locations Waste locations to plan for
+     * @param routeIndex Route strategy, as in FleetSimulator::CreateRoute
+     * @return Fleet plan; locations without a zone are left out
+     */
+    FleetPlan PlanCurrentZones(const std::vector<WasteLocation>& locations, int routeIndex) const;
+
+    /**
+     * @brief Set the truck capacity that caps the total waste of every zone
+     * @param capacity Capacity in bin percent, 0 to build zones by distance only
+     */
+    void SetVehicleCapacity(float capacity) { m_vehicleCapacity = capacity; }
+    float GetVehicleCapacity() const { return m_vehicleCapacity; }
+};
@@ -0,0 +1,117 @@
+// FleetSimulator.cpp
+// Implementation of the multi-day fleet simulation
+#include "pch.h"
+#include "FleetSimulator.h"
+#include "../Core/NonOptimizedRoute.h"
+#include "../Core/OptimizedRoute.h"
+#include "../Core/MSTRoute.h"
+#include "../Core/TSPRoute.h"
+#include "../Core/GreedyRoute.h"
+
+FleetSimulator::FleetSimulator(const WasteLevelPredictor* predictor, unsigned int seed)
+    : m_predictor(predictor),
+    m_seed(seed),
+    m_noiseLevel(0.25f),
+    m_recordDailyCosts(true)
+{
+}
+
+SimulationResult FleetSimulator::Run(Route& route, const std::vector<WasteLocation>& initialLocations, int days) const
+{
+    SimulationResult result;
+    result.routeName = route.GetRouteName();
+    result.days = std::max(0, days);
+    if (m_recordDailyCosts) {
+        result.dailyCost.reserve(result.days);
+    }
+
+    // Work on a copy so the caller's locations are left untouched
+    std::vector<WasteLocation> locations = initialLocations;
+    const size_t numLocations = locations.size();
+
+    // Resolve names once: route ids to vector indices and per-location rates
+    std::vector<int> indexById(WasteLocation::dict_Id_to_Name.size(), -1);
+    std::vector<float> accumulationRates(numLocations, 0.0f);
+    for (size_t i = 0; i < numLocations; i++) {
+        std::string name = locations[i].GetLocationName();
+
+        auto id = WasteLocation::dict_Name_toId.find(name);
+        if (id != WasteLocation::dict_Name_toId.end() && id->second < static_cast<int>(indexById.size())) {
+            indexById[id->second] = static_cast<int>(i);
+        }
+
+        if (m_predictor && name != "Station") {
+            accumulationRates[i] = m_predictor->GetAccumulationRate(name);
+        }
+    }
+
+    std::mt19937 rng(m_seed);
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+    const float threshold = route.GetWasteThreshold();
+
+    for (int day = 0; day < result.days; day++) {
+        float dayCost = 0.0f;
+
+        // Dispatch the truck on this morning's levels
+        if (route.CalculateRoute(locations)) {
+            result.dispatches++;
+            result.totalDistance += route.GetTotalDistance();
+            result.totalTime += route.GetTimeTaken();
+            result.totalFuel += route.GetFuelConsumption();
+            result.totalWage += route.GetWage();
+            result.totalCost += route.GetTotalCost();
+            dayCost = route.GetTotalCost();
+
+            // Empty the bins the route was sent for; bins it only passes through stay as they are
+            for (int id : route.GetFinalRoute()) {
+                if (id <= 0 || id >= static_cast<int>(indexById.size()) || indexById[id] < 0) {
+                    continue;
+                }
+
+                WasteLocation& location = locations[indexById[id]];
+                if (location.GetWasteLevel() > 0.0f && location.GetWasteLevel() >= threshold) {
+                    location.SetWasteLevel(0.0f);
+                    result.collections++;
+                }
+            }
+        }
+
+        if (m_recordDailyCosts) {
+            result.dailyCost.push_back(dayCost);
+        }
+
+        // Waste accumulates until the next morning
+        for (size_t i = 0; i < numLocations; i++) {
+            float rate = accumulationRates[i];
+            if (rate <= 0.0f) {
+                continue;
+            }
+
+            float increase = std::max(0.0f, rate * (1.0f + m_noiseLevel * noise(rng)));
+            locations[i].SetWasteLevel(locations[i].GetWasteLevel() + increase);
+
+            if (locations[i].GetWasteLevel() >= 100.0f) {
+                result.overflowBinDays++;
+            }
+        }
+    }
+
+    return result;
+}
+
+std::unique_ptr<Route> FleetSimulator::CreateRoute(int index, Application* app)
+{
+    std::unique_ptr<Route> route;
+
+    switch (index) {
+    case 0: route = std::make_unique<NonOptimizedRoute>(); break;
+    case 1: route = std::make_unique<OptimizedRoute>(); break;
+    case 2: route = std::make_unique<MSTRoute>(); break;
+    case 3: route = std::make_unique<TSPRoute>(); break;
+    case 4: route = std::make_unique<GreedyRoute>(); break;
+    default: return nullptr;
+    }
+
+    route->SetApplication(app);
+    return route;
+}
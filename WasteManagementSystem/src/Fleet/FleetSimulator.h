@@ -0,0 +1,82 @@
+// FleetSimulator.h
+// This file defines a discrete-time simulation of daily waste collection over many days
+#pragma once
+
+#include "../Core/WasteLocation.h"
+#include "../Core/Route.h"
+#include "../AI/WasteLevelPredictor.h"
+#include <vector>
+#include <string>
+#include <memory>
+
+// Forward declaration
+class Application;
+
+/**
+ * @brief Totals of one strategy over a simulated period
+ */
+struct SimulationResult {
+    std::string routeName;        // Name of the simulated route strategy
+    int days = 0;                 // Number of simulated days
+    int dispatches = 0;           // Days on which a truck was sent out
+    int collections = 0;          // Number of bins emptied
+    int overflowBinDays = 0;      // Bin-days spent completely full
+    float totalDistance = 0.0f;   // Total distance driven in km
+    float totalTime = 0.0f;       // Total driving time in minutes
+    float totalFuel = 0.0f;       // Total fuel cost in RM
+    float totalWage = 0.0f;       // Total driver wage in RM
+    float totalCost = 0.0f;       // Total cost in RM
+    std::vector<float> dailyCost; // Cost of each simulated day in RM
+};
+
+/**
+ * @brief Headless multi-day simulation of a route strategy
+ *
+ * Each simulated day the route is dispatched on the current waste levels, bins the
+ * truck collects are emptied, and every bin then fills up by its predicted daily
+ * accumulation rate plus random noise. Every run with the same seed sees the same
+ * noise, so different strategies are compared on identical demand.
+ */
+class FleetSimulator {
+private:
+    /* Private members in FleetSimulator class */
+    const WasteLevelPredictor* m_predictor;   // Source of the accumulation rates
+    unsigned int m_seed;                      // Seed of the accumulation noise
+    float m_noiseLevel;                       // Noise standard deviation relative to the rate
+    bool m_recordDailyCosts;                  // Whether to fill SimulationResult::dailyCost
+
+public:
+    /**
+     * @brief Constructor for FleetSimulator
+     * @param predictor Predictor providing the daily accumulation rate of each location
+     * @param seed Seed of the accumulation noise
+     */
+    FleetSimulator(const WasteLevelPredictor* predictor, unsigned int seed = 42);
+
+    /**
+     * @brief Simulate a route strategy over a number of days
+     * @param route Route strategy to dispatch every day
+     * @param initialLocations Waste locations with their starting levels
+     * @param days Number of days to simulate
+     * @return Accumulated totals of the simulation
+     */
+    SimulationResult Run(Route& route, const std::vector<WasteLocation>& initialLocations, int days) const;
+
+    /**
+     * @brief Create a route strategy by its index in the application
+     * @param index Non-Optimized (0), Optimized (1), MST (2), TSP (3), Greedy (4)
+     * @param app Application providing the cost settings, may be null
+     * @return New route instance, null if the index is invalid
+     */
+    static std::unique_ptr<Route> CreateRoute(int index, Application* app = nullptr);
+
+    // Number of route strategies CreateRoute knows
+    static const int NumRouteStrategies = 5;
+
+    // Getters and setters
+    unsigned int GetSeed() const { return m_seed; }
+    void SetSeed(unsigned int seed) { m_seed = seed; }
+    float GetNoiseLevel() const { return m_noiseLevel; }
+    void SetNoiseLevel(float noiseLevel) { m_noiseLevel = noiseLevel; }
+    void SetRecordDailyCosts(bool record) { m_recordDailyCosts = record; }
+};
@@ -0,0 +1,177 @@
+// StrategyEvaluator.cpp
+// Implementation of the Monte-Carlo route strategy evaluation
+#include "pch.h"
+#include "StrategyEvaluator.h"
+#include "FleetSimulator.h"
+#include "../Utils/ThreadPool.h"
+
+namespace {
+    // Running mean and variance (Welford), mergeable across chunks
+    struct RunningStats {
+        double count = 0.0;
+        double mean = 0.0;
+        double m2 = 0.0;
+
+        void Add(double value)
+        {
+            count += 1.0;
+            double delta = value - mean;
+            mean += delta / count;
+            m2 += delta * (value - mean);
+        }
+
+        void Merge(const RunningStats& other)
+        {
+            if (other.count == 0.0) {
+                return;
+            }
+
+            double total = count + other.count;
+            double delta = other.mean - mean;
+            mean += delta * other.count / total;
+            m2 += other.m2 + delta * delta * count * other.count / total;
+            count = total;
+        }
+    };
+
+    // Statistics of one strategy within one chunk
+    struct ChunkStats {
+        RunningStats cost;
+        int dispatches = 0;
+        long long collections = 0;
+    };
+}
+
+StrategyEvaluator::StrategyEvaluator(Application* app, unsigned int seed)
+    : m_app(app),
+    m_seed(seed),
+    m_scenariosPerChunk(64)
+{
+}
+
+EvaluationResult StrategyEvaluator::Evaluate(const std::vector<WasteLocation>& locations, int numScenarios) const
+{
+    const int numStrategies = FleetSimulator::NumRouteStrategies;
+    const size_t scenarios = static_cast<size_t>(std::max(0, numScenarios));
+
+    EvaluationResult result;
+    result.strategies.resize(numStrategies);
+    for (int s = 0; s < numStrategies; s++) {
+        result.strategies[s].routeName = FleetSimulator::CreateRoute(s)->GetRouteName();
+    }
+
+    if (scenarios == 0 || locations.empty()) {
+        return result;
+    }
+
+    // Resolve route ids to vector indices once
+    std::vector<int> indexById(WasteLocation::dict_Id_to_Name.size(), -1);
+    for (size_t i = 0; i < locations.size(); i++) {
+        auto id = WasteLocation::dict_Name_toId.find(locations[i].GetLocationName());
+        if (id != WasteLocation::dict_Name_toId.end() && id->second < static_cast<int>(indexById.size())) {
+            indexById[id->second] = static_cast<int>(i);
+        }
+    }
+
+    const size_t numChunks = ThreadPool::GetChunkCount(scenarios, m_scenariosPerChunk);
+    std::vector<std::vector<ChunkStats>> chunkStats(numChunks, std::vector<ChunkStats>(numStrategies));
+
+    ThreadPool::Shared().ParallelFor(scenarios, m_scenariosPerChunk,
+        [&](size_t chunk, size_t begin, size_t end) {
+            // Own RNG stream and route instances per chunk, nothing shared between threads
+            std::seed_seq seeds{ m_seed, static_cast<unsigned int>(chunk) };
+            std::mt19937 rng(seeds);
+            std::uniform_real_distribution<float> dist(0.0f, 100.0f);
+
+            std::vector<std::unique_ptr<Route>> routes;
+            for (int s = 0; s < numStrategies; s++) {
+                routes.push_back(FleetSimulator::CreateRoute(s, m_app));
+            }
+
+            // Copies are reused; levels are set directly because constructing a
+            // WasteLocation touches its shared random generator
+            std::vector<WasteLocation> scenario = locations;
+
+            for (size_t n = begin; n < end; n++) {
+                // Same distribution as WasteLocation::RegenerateWasteLevel
+                for (auto& location : scenario) {
+                    location.SetWasteLevel(std::round(dist(rng)));
+                }
+
+                // Every strategy is solved on the same scenario
+                for (int s = 0; s < numStrategies; s++) {
+                    Route& route = *routes[s];
+                    ChunkStats& stats = chunkStats[chunk][s];
+
+                    if (!route.CalculateRoute(scenario)) {
+                        stats.cost.Add(0.0);
+                        continue;
+                    }
+
+                    stats.cost.Add(route.GetTotalCost());
+                    stats.dispatches++;
+
+                    for (int id : route.GetFinalRoute()) {
+                        if (id > 0 && id < static_cast<int>(indexById.size()) && indexById[id] >= 0 &&
+                            scenario[indexById[id]].GetWasteLevel() >= route.GetWasteThreshold()) {
+                            stats.collections++;
+                        }
+                    }
+                }
+            }
+        });
+
+    // Merge in chunk order so the result does not depend on scheduling
+    for (int s = 0; s < numStrategies; s++) {
+        RunningStats cost;
+        int dispatches = 0;
+        long long collections = 0;
+        for (size_t chunk = 0; chunk < numChunks; chunk++) {
+            cost.Merge(chunkStats[chunk][s].cost);
+            dispatches += chunkStats[chunk][s].dispatches;
+            collections += chunkStats[chunk][s].collections;
+        }
+
+        StrategyStatistics& stats = result.strategies[s];
+        stats.scenarios = static_cast<int>(scenarios);
+        stats.dispatches = dispatches;
+        stats.meanCollections = static_cast<double>(collections) / scenarios;
+        stats.meanCost = cost.mean;
+        stats.variance = scenarios > 1 ? cost.m2 / (scenarios - 1) : 0.0;
+
+        double halfWidth = 1.96 * std::sqrt(stats.variance / scenarios);
+        stats.ciLow = stats.meanCost - halfWidth;
+        stats.ciHigh = stats.meanCost + halfWidth;
+    }
+
+    // Recommend the cheapest strategy among those that actually collect waste
+    for (int s = 0; s < numStrategies; s++) {
+        if (result.strategies[s].dispatches == 0) {
+            continue;
+        }
+
+        if (result.recommendedIndex < 0 ||
+            result.strategies[s].meanCost < result.strategies[result.recommendedIndex].meanCost) {
+            result.runnerUpIndex = result.recommendedIndex;
+            result.recommendedIndex = s;
+        }
+        else if (result.runnerUpIndex < 0 ||
+            result.strategies[s].meanCost < result.strategies[result.runnerUpIndex].meanCost) {
+            result.runnerUpIndex = s;
+        }
+    }
+
+    // Welch-style test of the difference between the two cheapest strategies
+    if (result.recommendedIndex >= 0 && result.runnerUpIndex >= 0) {
+        const StrategyStatistics& best = result.strategies[result.recommendedIndex];
+        const StrategyStatistics& second = result.strategies[result.runnerUpIndex];
+
+        double standardError = std::sqrt(best.variance / scenarios + second.variance / scenarios);
+        result.significant = second.meanCost - best.meanCost > 1.96 * standardError;
+    }
+    else {
+        result.significant = result.recommendedIndex >= 0;
+    }
+
+    return result;
+}
@@ -0,0 +1,69 @@
+// StrategyEvaluator.h
+// This file defines a Monte-Carlo comparison of the route strategies over random waste levels
+#pragma once
+
+#include "../Core/WasteLocation.h"
+#include <vector>
+#include <string>
+
+// Forward declaration
+class Application;
+
+/**
+ * @brief Cost statistics of one route strategy over all sampled scenarios
+ */
+struct StrategyStatistics {
+    std::string routeName;        // Name of the route strategy
+    int scenarios = 0;            // Number of evaluated scenarios
+    int dispatches = 0;           // Scenarios in which a route was needed
+    double meanCollections = 0.0; // Average number of bins collected per scenario
+    double meanCost = 0.0;        // Average total cost in RM (0 when no route is needed)
+    double variance = 0.0;        // Sample variance of the total cost
+    double ciLow = 0.0;           // Lower bound of the 95% confidence interval of the mean cost
+    double ciHigh = 0.0;          // Upper bound of the 95% confidence interval of the mean cost
+};
+
+/**
+ * @brief Outcome of a Monte-Carlo strategy evaluation
+ */
+struct EvaluationResult {
+    std::vector<StrategyStatistics> strategies;   // Statistics in route index order
+    int recommendedIndex = -1;                     // Strategy with the lowest mean cost
+    int runnerUpIndex = -1;                        // Strategy with the second lowest mean cost
+    bool significant = false;                      // Whether the recommendation beats the runner-up at 95%
+};
+
+/**
+ * @brief Compares all route strategies on many random waste level scenarios
+ *
+ * Scenarios are split into fixed-size chunks. Every chunk draws its levels from its own
+ * RNG stream and solves them with its own route instances, and the per-chunk statistics
+ * are merged in chunk order. The results are therefore identical for any number of threads.
+ */
+class StrategyEvaluator {
+private:
+    /* Private members in StrategyEvaluator class */
+    Application* m_app;          // Application providing the cost settings, may be null
+    unsigned int m_seed;         // Base seed of the scenario streams
+    size_t m_scenariosPerChunk;  // Scenarios solved by one task
+
+public:
+    /**
+     * @brief Constructor for StrategyEvaluator
+     * @param app Application providing the cost settings, may be null
+     * @param seed Base seed of the scenario streams
+     */
+    StrategyEvaluator(Application* app = nullptr, unsigned int seed = 42);
+
+    /**
+     * @brief Evaluate every route strategy on random waste levels
+     * @param locations Waste locations to sample levels for
+     * @param numScenarios Number of random scenarios
+     * @return Per-strategy statistics and the recommended strategy
+     */
+    EvaluationResult Evaluate(const std::vector<WasteLocation>& locations, int numScenarios) const;
+
+    // Getters and setters
+    unsigned int GetSeed() const { return m_seed; }
+    void SetSeed(unsigned int seed) { m_seed = seed; }
+};
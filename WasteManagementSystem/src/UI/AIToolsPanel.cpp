@@ -132,7 +132,12 @@ void AIToolsPanel::RenderRouteLearningUI(RouteLearningAgent* agent)
     ImGui::SameLine();
     if (ImGui::Button("Reset Agent", ImVec2(120, 30))) {
         // Reset the agent
-        // In a real implementation, we would call agent->Reset()
+        agent->Reset();
+    }
+
+    // Training runs in the background, so show how far it has got
+    if (agent->IsTraining()) {
+        ImGui::ProgressBar(agent->GetTrainingProgress(), ImVec2(-1, 0), "Training...");
     }
 
     // Learning progress
@@ -281,29 +286,15 @@ void AIToolsPanel::PlotForecast(WasteLevelPredictor* predictor, int days)
 
 void AIToolsPanel::PlotLearningCurve(RouteLearningAgent* agent)
 {
-    // This would display the learning progress over iterations
-    // For this example, we'll use placeholder data
+    // Snapshot of the reward curve, updated live while the agent trains
+    std::vector<float> rewards = agent->GetRewardHistory();
 
     if (ImPlot::BeginPlot("Learning Curve", ImVec2(-1, 200))) {
-        ImPlot::SetupAxes("Iterations", "Average Reward", ImPlotAxisFlags_AutoFit, ImPlotAxisFlags_AutoFit);
+        ImPlot::SetupAxes("Learning Curve Points", "Average Reward", ImPlotAxisFlags_AutoFit, ImPlotAxisFlags_AutoFit);
 
-        // Generate placeholder data
-        static const int numPoints = 100;
-        static float x[numPoints];
-        static float y[numPoints];
-        static bool initialized = false;
-
-        if (!initialized) {
-            for (int i = 0; i < numPoints; i++) {
-                x[i] = i;
-                y[i] = -20.0f + 19.0f * (1.0f - std::exp(-0.05f * i));
-                // Add some noise
-                y[i] += (rand() % 100) / 100.0f - 0.5f;
-            }
-            initialized = true;
+        if (!rewards.empty()) {
+            ImPlot::PlotLine("Reward", rewards.data(), static_cast<int>(rewards.size()));
         }
-
-        ImPlot::PlotLine("Reward", x, y, numPoints);
         ImPlot::EndPlot();
     }
 }
@@ -316,22 +307,22 @@ void AIToolsPanel::RenderQValueMatrix(RouteLearningAgent* agent)
     ImGui::Text("Q-values represent the expected future reward for taking each action from each state.");
     ImGui::Spacing();
 
-    if (ImGui::BeginTable("QValueMatrix", 8, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+    // View of the agent's matrix; nothing is allocated or copied
+    QMatrixView qMatrix = agent->GetQMatrix();
+
+    if (ImGui::BeginTable("QValueMatrix", qMatrix.size + 1, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
         // Header row with destination locations
         ImGui::TableNextRow();
         ImGui::TableNextColumn();
         ImGui::Text("From \\ To");
 
-        for (int i = 0; i < 9; i++) {
+        for (int i = 0; i < qMatrix.size; i++) {
             ImGui::TableNextColumn();
             ImGui::Text("%s", WasteLocation::dict_Id_to_Name[i].c_str());
         }
 
-        // Get Q-value matrix from agent
-        float** qMatrix = agent->GetQMatrix();
-
         // Rows for each source location
-        for (int i = 0; i < 9; i++) {
+        for (int i = 0; i < qMatrix.size; i++) {
             ImGui::TableNextRow();
 
             // First column is the source location
@@ -339,7 +330,7 @@ void AIToolsPanel::RenderQValueMatrix(RouteLearningAgent* agent)
             ImGui::Text("%s", WasteLocation::dict_Id_to_Name[i].c_str());
 
             // Remaining columns are Q-values for each destination
-            for (int j = 0; j < 9; j++) {
+            for (int j = 0; j < qMatrix.size; j++) {
                 ImGui::TableNextColumn();
 
                 if (i == j) {
@@ -347,7 +338,7 @@ void AIToolsPanel::RenderQValueMatrix(RouteLearningAgent* agent)
                 }
                 else {
                     // Color based on Q-value: higher is better (green), lower is worse (red)
-                    float normalizedQ = (qMatrix[i][j] + 20.0f) / 40.0f; // Normalize to [0,1]
+                    float normalizedQ = (qMatrix.At(i, j) + 20.0f) / 40.0f; // Normalize to [0,1]
                     normalizedQ = std::max(0.0f, std::min(1.0f, normalizedQ));
 
                     ImVec4 color(
@@ -357,17 +348,11 @@ void AIToolsPanel::RenderQValueMatrix(RouteLearningAgent* agent)
                         1.0f                // Alpha
                     );
 
-                    ImGui::TextColored(color, "%.2f", qMatrix[i][j]);
+                    ImGui::TextColored(color, "%.2f", qMatrix.At(i, j));
                 }
             }
         }
 
-        // Clean up the matrix
-        for (int i = 0; i < 9; i++) {
-            delete[] qMatrix[i];
-        }
-        delete[] qMatrix;
-
         ImGui::EndTable();
     }
 }
\ No newline at end of file
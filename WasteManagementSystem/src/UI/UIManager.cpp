@@ -18,7 +18,9 @@ UIManager::UIManager(Application* application)
     m_showAIWindow(true),
     m_showSettingsWindow(true),
     m_windowWidth(1280),
-    m_windowHeight(720)
+    m_windowHeight(720),
+    m_reportExportRunning(false),
+    m_reportNoticeUntil(0.0)
 {
     // 创建UI组件实例
     m_mainWindow = std::make_unique<MainWindow>();
@@ -200,9 +202,28 @@ void UIManager::RenderMenuBar()
 
             ImGui::Separator();
 
-            if (ImGui::MenuItem("Export Report")) {
-                // Export route report
-                m_application->ExportRouteReport("WasteManagementReport.txt");
+            if (ImGui::MenuItem("Export Report", nullptr, false,
+                m_application->GetReportExportState() != ReportExportState::Running)) {
+                // Export route report in the background
+                m_application->StartReportExport("WasteManagementReport.txt");
+            }
+
+            if (ImGui::MenuItem("Export Results (Arrow)")) {
+                // Columnar files for dataframe tools
+                m_application->ExportResultsAsArrow("WasteManagementRoutes.arrow", "WasteManagementPredictions.arrow");
+            }
+
+            if (ImGui::MenuItem("Import Bin Inventory")) {
+                // Load the bin inventory CSV next to the executable
+                m_application->ImportBinInventory("BinInventory.csv");
+            }
+
+            if (ImGui::MenuItem("Save Bin Snapshot")) {
+                m_application->SaveBinSnapshot("BinInventory.snapshot");
+            }
+
+            if (ImGui::MenuItem("Load Bin Snapshot")) {
+                m_application->LoadBinSnapshot("BinInventory.snapshot");
             }
 
             ImGui::Separator();
@@ -253,6 +274,10 @@ void UIManager::RenderMenuBar()
                 m_application->OptimizeWithAI();
             }
 
+            if (ImGui::MenuItem("Simulate 4 Weeks (All Routes)")) {
+                m_application->RunFleetSimulation(28);
+            }
+
             ImGui::EndMenu();
         }
 
@@ -348,7 +373,16 @@ void UIManager::RenderDetailsWindow()
             color = ImVec4(1.0f, 0.0f, 0.0f, 1.0f); // Red
         }
 
-        ImGui::TextColored(color, "%.1f%%", wasteLevel);
+        // An edited level is applied like a sensor reading; only the affected routes are updated
+        ImGui::PushID(location.GetLocationName().c_str());
+        ImGui::PushStyleColor(ImGuiCol_Text, color);
+        ImGui::SetNextItemWidth(-1.0f);
+        bool edited = ImGui::SliderFloat("##waste_level", &wasteLevel, 0.0f, 100.0f, "%.1f%%");
+        ImGui::PopStyleColor();
+        ImGui::PopID();
+        if (edited) {
+            m_application->ApplySensorUpdate({ { location.GetLocationName(), wasteLevel } });
+        }
         ImGui::NextColumn();
     }
 
@@ -450,10 +484,13 @@ void UIManager::RenderComparisonWindow()
 
     ImGui::SameLine();
 
-    // Button to export report
-    if (ImGui::Button("Export Full Report")) {
-        m_application->ExportRouteReport("WasteManagementReport.txt");
+    // Button to export report; the file is written in the background
+    bool exporting = m_application->GetReportExportState() == ReportExportState::Running;
+    ImGui::BeginDisabled(exporting);
+    if (ImGui::Button(exporting ? "Exporting Report..." : "Export Full Report")) {
+        m_application->StartReportExport("WasteManagementReport.txt");
     }
+    ImGui::EndDisabled();
 
     ImGui::Separator();
 
@@ -678,7 +715,7 @@ void UIManager::RenderWastePredictionUI()
         WasteLevelPredictor* predictor = m_application->GetWasteLevelPredictor();
 
         if (predictor) {
-            auto forecasts = predictor->GenerateForecasts(daysAhead);
+            auto forecasts = predictor->GetForecasts(daysAhead);
 
             // X-axis: days
             double x[31]; // current day + forecast days
@@ -687,7 +724,7 @@ void UIManager::RenderWastePredictionUI()
             }
 
             // For each location, plot a line
-            for (const auto& pair : forecasts) {
+            for (const auto& pair : *forecasts) {
                 if (pair.first != "Station") {
                     const std::vector<float>& levels = pair.second;
 
@@ -733,25 +770,26 @@ void UIManager::RenderWastePredictionUI()
     WasteLevelPredictor* predictor = m_application->GetWasteLevelPredictor();
 
     if (predictor) {
-        for (const auto& pair : WasteLocation::dict_Name_toId) {
-            if (pair.first != "Station") {
-                ImGui::Text("%s", pair.first.c_str());
-                ImGui::NextColumn();
+        // All locations are evaluated in one pass, most urgent first
+        auto ranking = predictor->RankLocationsByUrgency(60.0f);
 
-                int days = predictor->GetRecommendedCollectionDay(pair.first, 60.0f);
+        for (const auto& urgency : ranking) {
+            ImGui::Text("%s", urgency.name.c_str());
+            ImGui::NextColumn();
 
-                if (days == 0) {
-                    ImGui::TextColored(ImVec4(1, 0, 0, 1), "URGENT: Today");
-                }
-                else if (days > 0) {
-                    ImGui::Text("%d days", days);
-                }
-                else {
-                    ImGui::Text("Unknown");
-                }
+            int days = urgency.daysUntil;
 
-                ImGui::NextColumn();
+            if (days == 0) {
+                ImGui::TextColored(ImVec4(1, 0, 0, 1), "URGENT: Today");
             }
+            else if (days > 0) {
+                ImGui::Text("%d days", days);
+            }
+            else {
+                ImGui::Text("Unknown");
+            }
+
+            ImGui::NextColumn();
         }
     }
 
@@ -770,16 +808,40 @@ void UIManager::RenderRouteLearningUI()
     ImGui::Separator();
 
     // Learning controls
-    static int trainingIterations = 100;
+    static int trainingIterations = 1000;
     ImGui::Text("Training Iterations:");
-    ImGui::SliderInt("##training_iterations", &trainingIterations, 10, 1000);
+    ImGui::SliderInt("##training_iterations", &trainingIterations, 10, 100000, "%d", ImGuiSliderFlags_Logarithmic);
 
+    RouteLearningAgent* agent = m_application->GetRouteLearningAgent();
+    bool training = agent->IsTraining();
+
+    ImGui::BeginDisabled(training);
     if (ImGui::Button("Train Route Agent")) {
-        // Train the agent
+        // Train the agent in the background
+        agent->TrainAsync(m_application->GetWasteLocations(), trainingIterations);
+    }
+
+    ImGui::SameLine();
+
+    if (ImGui::Button("Save Model")) {
+        m_application->SaveRouteLearningModel();
     }
 
     ImGui::SameLine();
 
+    if (ImGui::Button("Load Model")) {
+        m_application->LoadRouteLearningModel();
+    }
+
+    // Linear Q-function over route features instead of the Q-table
+    bool useFeaturePolicy = agent->IsFeaturePolicyEnabled();
+    if (ImGui::Checkbox("Feature-based policy", &useFeaturePolicy)) {
+        agent->SetFeaturePolicyEnabled(useFeaturePolicy);
+    }
+    ImGui::EndDisabled();
+
+    ImGui::SameLine();
+
     if (ImGui::Button("Apply Learned Routes")) {
         // Apply learned routes
         m_application->OptimizeWithAI();
@@ -790,84 +852,52 @@ void UIManager::RenderRouteLearningUI()
     // Learning progress visualization
     ImGui::Text("Learning Progress:");
 
-    // Simulated learning curve
-    static float progress = 100;
-    static float learningData[100];
-
-    for (int i = 0; i < 100; i++) {
-        learningData[i] = 100.0f - 50.0f * (1.0f - expf(-i / 20.0f)) + 10.0f * sinf(i * 0.2f);
-    }
+    // Average episode reward, recorded by the agent while it trains
+    std::vector<float> rewards = agent->GetRewardHistory();
 
     // Plot learning curve
     if (ImPlot::BeginPlot("Learning Curve", ImVec2(-1, 300))) {
         // IMPORTANT: Call setup functions AFTER BeginPlot but BEFORE any Plot functions
-        ImPlot::SetupAxes("Training Iterations", "Route Cost (RM)");
+        ImPlot::SetupAxes("Learning Curve Points", "Average Reward", ImPlotAxisFlags_AutoFit, ImPlotAxisFlags_AutoFit);
 
-        double x[100];
-        for (int i = 0; i < 100; i++) {
-            x[i] = (float)i;
+        if (!rewards.empty()) {
+            ImPlot::PlotLine("Reward", rewards.data(), static_cast<int>(rewards.size()));
         }
 
-        ImPlot::PlotLine("Cost", (const float*)x, (const float*)learningData, 100);
-
         ImPlot::EndPlot();
     }
 
-    ImGui::ProgressBar(progress / 100.0f, ImVec2(-1, 0), "Training Progress");
+    ImGui::ProgressBar(training ? agent->GetTrainingProgress() : (rewards.empty() ? 0.0f : 1.0f),
+        ImVec2(-1, 0), training ? "Training..." : "Training Progress");
 
     ImGui::Separator();
 
     // Q-value visualization
     ImGui::Text("Q-Value Map (Route Segment Values):");
 
-    // Simple Q-value visualization as a heatmap
-    static float qValues[9][9];
-    for (int i = 0; i < 8; i++) {
-        for (int j = 0; j < 8; j++) {
-            if (WasteLocation::map_distance_matrix[i][j] < INF) {
-                qValues[i][j] = 0.5f + 0.5f * sinf(i * 0.5f + j * 0.3f);
-            }
-            else {
-                qValues[i][j] = 0.0f;
-            }
+    // Learned route segment values, read in place from the agent's matrix
+    QMatrixView qMatrix = agent->GetQMatrix();
+
+    if (qMatrix.size > 0 && ImPlot::BeginPlot("##QValueHeatmap", ImVec2(-1, 300), ImPlotFlags_NoLegend)) {
+        // Label the axes with location names, rows are drawn from the top down
+        std::vector<const char*> labels(qMatrix.size);
+        std::vector<double> columnTicks(qMatrix.size);
+        std::vector<double> rowTicks(qMatrix.size);
+        for (int i = 0; i < qMatrix.size; i++) {
+            labels[i] = WasteLocation::dict_Id_to_Name[i].c_str();
+            columnTicks[i] = i + 0.5;
+            rowTicks[i] = qMatrix.size - i - 0.5;
         }
-    }
 
-    // Display Q-values as a table with colors
-    ImGui::BeginTable("Q-Values", 8, ImGuiTableFlags_Borders);
+        ImPlot::SetupAxes("To", "From", ImPlotAxisFlags_NoGridLines, ImPlotAxisFlags_NoGridLines);
+        ImPlot::SetupAxisTicks(ImAxis_X1, columnTicks.data(), qMatrix.size, labels.data());
+        ImPlot::SetupAxisTicks(ImAxis_Y1, rowTicks.data(), qMatrix.size, labels.data());
 
-    // Header row
-    ImGui::TableNextRow();
-    for (int j = 0; j < 8; j++) {
-        ImGui::TableNextColumn();
-        ImGui::Text("%s", WasteLocation::dict_Id_to_Name[j].c_str());
-    }
+        ImPlot::PlotHeatmap("Q", qMatrix.values, qMatrix.size, qMatrix.size, 0, 0, "%.1f",
+            ImPlotPoint(0, 0), ImPlotPoint(qMatrix.size, qMatrix.size));
 
-    // Data rows
-    for (int i = 0; i < 8; i++) {
-        ImGui::TableNextRow();
-
-        for (int j = 0; j < 8; j++) {
-            ImGui::TableNextColumn();
-
-            if (WasteLocation::map_distance_matrix[i][j] < INF) {
-                // Color based on Q-value
-                ImVec4 color(
-                    1.0f - qValues[i][j],
-                    qValues[i][j],
-                    0.0f,
-                    1.0f
-                );
-
-                ImGui::TextColored(color, "%.2f", qValues[i][j]);
-            }
-            else {
-                ImGui::TextDisabled("-");
-            }
-        }
+        ImPlot::EndPlot();
     }
-
-    ImGui::EndTable();
 }
 
 // Render location clustering UI
@@ -886,14 +916,91 @@ void UIManager::RenderLocationClusteringUI()
     ImGui::Text("Number of Clusters:");
     ImGui::SliderInt("##num_clusters", &numClusters, 2, 5);
 
-    if (ImGui::Button("Generate Clusters")) {
-        // Generate clusters
+    // Density-based clustering finds its own number of zones and leaves isolated bins out
+    static bool densityBased = false;
+    static float densityRadius = 120.0f;
+    ImGui::Checkbox("Density-based (DBSCAN)", &densityBased);
+    if (densityBased) {
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(200.0f);
+        ImGui::SliderFloat("Radius", &densityRadius, 20.0f, 300.0f, "%.0f");
+    }
+
+    // Balanced zones hold at most one truck load of waste each
+    static bool balanceByCapacity = false;
+    static float truckCapacity = 200.0f;
+    if (!densityBased) {
+        ImGui::Checkbox("Balance by truck capacity", &balanceByCapacity);
+    }
+    if (!densityBased && balanceByCapacity) {
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(200.0f);
+        ImGui::SliderFloat("Capacity (bin %)", &truckCapacity, 100.0f, 800.0f, "%.0f");
+    }
+
+    LocationClustering* clustering = m_application->GetLocationClustering();
+    const FleetPlan& plan = m_application->GetFleetPlan();
+
+    if (ImGui::Button("Generate Clusters") && clustering) {
+        clustering->SetNumClusters(numClusters);
+        if (densityBased) {
+            clustering->RunDensityClustering(m_application->GetWasteLocations(), densityRadius);
+        }
+        else if (balanceByCapacity) {
+            clustering->RunBalancedClustering(m_application->GetWasteLocations(), truckCapacity);
+        }
+        else {
+            clustering->RunClustering(m_application->GetWasteLocations());
+        }
     }
 
     ImGui::SameLine();
 
     if (ImGui::Button("Apply Clustered Route")) {
-        // Apply clustered route
+        if (densityBased && clustering) {
+            // Route the density clusters as they are; noise bins are not collected
+            clustering->RunDensityClustering(m_application->GetWasteLocations(), densityRadius);
+            m_application->PlanCurrentClusterRoutes();
+        }
+        else {
+            m_application->PlanClusteredRoutes(numClusters, balanceByCapacity ? truckCapacity : 0.0f);
+        }
+    }
+
+    if (!plan.zones.empty()) {
+        ImGui::Text("Fleet plan (%s): %d trucks, %.2f km, RM %.2f, longest route %.1f min, solved in %.2f ms",
+            plan.routeName.c_str(), plan.trucks, plan.totalDistance, plan.totalCost, plan.makespan,
+            plan.solveMilliseconds);
+    }
+
+    // Zones for the imported bin inventory, clustered apart from the map locations
+    const LocationStore& inventory = m_application->GetBinInventory();
+    if (inventory.Size() > 0) {
+        if (ImGui::Button("Cluster Bin Inventory")) {
+            m_application->ClusterBinInventory(numClusters);
+        }
+        if (m_application->IsBinInventoryClustered()) {
+            LocationClustering* inventoryClustering = m_application->GetInventoryClustering();
+            ImGui::SameLine();
+            ImGui::Text("%zu bins in %zu zones after %d iterations", inventory.Size(),
+                inventoryClustering->GetClusterCentroids().size(), inventoryClustering->GetLastIterations());
+        }
+    }
+
+    // Automatic number of clusters
+    static int maxSweepClusters = 10;
+    ImGui::SliderInt("Max Clusters", &maxSweepClusters, 3, 20);
+    ImGui::SameLine();
+
+    if (ImGui::Button("Find Number of Clusters") && clustering) {
+        // Sweeps the points of the last clustering run
+        if (clustering->RunAutoClustering(2, maxSweepClusters)) {
+            numClusters = clustering->GetNumClusters();
+        }
+    }
+
+    if (clustering) {
+        PlotClusterCountSweep(clustering->GetLastSweep());
     }
 
     ImGui::Separator();
@@ -919,9 +1026,18 @@ void UIManager::RenderLocationClusteringUI()
         IM_COL32(0, 255, 0, 200),   // Green
         IM_COL32(0, 0, 255, 200),   // Blue
         IM_COL32(255, 255, 0, 200), // Yellow
-        IM_COL32(255, 0, 255, 200)  // Magenta
+        IM_COL32(255, 0, 255, 200), // Magenta
+        IM_COL32(0, 255, 255, 200), // Cyan
+        IM_COL32(255, 128, 0, 200), // Orange
+        IM_COL32(160, 90, 255, 200) // Purple
     };
 
+    // Balanced clustering may add clusters beyond the slider value
+    int shownClusters = numClusters;
+    if (clustering && !clustering->GetClusterCentroids().empty()) {
+        shownClusters = std::min(static_cast<int>(clustering->GetClusterCentroids().size()), 8);
+    }
+
     // Center and scale the map
     float scaleX = mapSize.x / 500.0f;
     float scaleY = mapSize.y / 500.0f;
@@ -934,8 +1050,8 @@ void UIManager::RenderLocationClusteringUI()
     ImU32 roadColor = IM_COL32(150, 150, 150, 200);
     float roadThickness = 2.0f;
 
-    for (int i = 0; i < 8; i++) {
-        for (int j = 0; j < 8; j++) {
+    for (int i = 0; i < 9; i++) {
+        for (int j = 0; j < 9; j++) {
             if (WasteLocation::map_distance_matrix[i][j] < INF) {
                 // Draw road from location i to j
                 ImVec2 p1(
@@ -953,15 +1069,19 @@ void UIManager::RenderLocationClusteringUI()
         }
     }
 
-    // Simulated cluster assignments (random for demo)
-    int clusterAssignments[] = { 0, 0, 1, 1, 2, 2, 0, 1 };
+    // Cluster of every location ID, -1 when it is not clustered
+    int clusterAssignments[9];
+    for (int i = 0; i < 9; i++) {
+        int cluster = clustering ? clustering->GetClusterForLocation(WasteLocation::dict_Id_to_Name[i]) : -1;
+        clusterAssignments[i] = cluster < shownClusters ? cluster : -1;
+    }
 
     // Draw clusters
-    for (int c = 0; c < numClusters; c++) {
+    for (int c = 0; c < shownClusters; c++) {
         // Find convex hull of cluster points
         std::vector<ImVec2> clusterPoints;
 
-        for (int i = 0; i < 8; i++) {
+        for (int i = 0; i < 9; i++) {
             if (clusterAssignments[i] == c) {
                 ImVec2 pos(
                     offsetX + WasteLocation::location_coordinates[i][0] * scale,
@@ -989,7 +1109,7 @@ void UIManager::RenderLocationClusteringUI()
     }
 
     // Draw locations with cluster colors
-    for (int i = 0; i < 8; i++) {
+    for (int i = 0; i < 9; i++) {
         ImVec2 pos(
             offsetX + WasteLocation::location_coordinates[i][0] * scale,
             offsetY + WasteLocation::location_coordinates[i][1] * scale
@@ -1005,8 +1125,8 @@ void UIManager::RenderLocationClusteringUI()
             radius = 15.0f;
         }
         else {
-            // Use cluster color
-            color = clusterColors[clusterAssignments[i]];
+            // Use cluster color, grey when not clustered yet
+            color = clusterAssignments[i] >= 0 ? clusterColors[clusterAssignments[i] % IM_ARRAYSIZE(clusterColors)] : IM_COL32(150, 150, 150, 200);
             radius = 10.0f;
         }
 
@@ -1043,7 +1163,7 @@ void UIManager::RenderLocationClusteringUI()
     ImGui::TableNextColumn(); ImGui::Text("Total Distance");
 
     // Data rows
-    for (int c = 0; c < numClusters; c++) {
+    for (int c = 0; c < shownClusters; c++) {
         ImGui::TableNextRow();
 
         // Cluster number
@@ -1063,7 +1183,7 @@ void UIManager::RenderLocationClusteringUI()
         std::string locations;
         int count = 0;
 
-        for (int i = 1; i < 8; i++) {
+        for (int i = 1; i < 9; i++) {
             if (clusterAssignments[i] == c) {
                 if (count > 0) {
                     locations += ", ";
@@ -1075,18 +1195,59 @@ void UIManager::RenderLocationClusteringUI()
 
         ImGui::Text("%s", locations.c_str());
 
-        // Average waste level (simulated)
+        // Average waste level
         ImGui::TableNextColumn();
-        ImGui::Text("%.1f%%", 40.0f + 20.0f * c);
+        ImGui::Text("%.1f%%", count > 0 ? clustering->CalculateAverageWasteLevel(c, m_application->GetWasteLocations()) : 0.0f);
 
-        // Total distance (simulated)
+        // Route distance of the zone in the fleet plan
         ImGui::TableNextColumn();
-        ImGui::Text("%.2f km", 10.0f + 5.0f * c);
+        if (c < static_cast<int>(plan.zones.size()) && plan.zones[c].dispatched) {
+            ImGui::Text("%.2f km", plan.zones[c].totalDistance);
+        }
+        else {
+            ImGui::Text("-");
+        }
     }
 
     ImGui::EndTable();
 }
 
+void UIManager::PlotClusterCountSweep(const ClusterCountSweep& sweep)
+{
+    if (sweep.scores.empty()) {
+        ImGui::Text("Run a clustering first, then search for the number of clusters.");
+        return;
+    }
+
+    ImGui::Text("Elbow: %d clusters, best silhouette: %d clusters (%.0f ms)",
+        sweep.elbowClusters, sweep.bestSilhouetteClusters, sweep.milliseconds);
+
+    std::vector<double> counts, inertia, silhouette;
+    for (const auto& score : sweep.scores) {
+        counts.push_back(score.numClusters);
+        inertia.push_back(score.inertia);
+        silhouette.push_back(score.silhouette);
+    }
+    int numScores = static_cast<int>(counts.size());
+
+    if (ImPlot::BeginPlot("Cluster Count Sweep", ImVec2(-1, 250))) {
+        ImPlot::SetupAxes("Clusters", "Inertia", ImPlotAxisFlags_AutoFit, ImPlotAxisFlags_AutoFit);
+        ImPlot::SetupAxis(ImAxis_Y2, "Silhouette", ImPlotAxisFlags_AuxDefault | ImPlotAxisFlags_AutoFit);
+
+        ImPlot::SetAxes(ImAxis_X1, ImAxis_Y1);
+        ImPlot::PlotLine("Inertia", counts.data(), inertia.data(), numScores);
+
+        ImPlot::SetAxes(ImAxis_X1, ImAxis_Y2);
+        ImPlot::PlotLine("Silhouette", counts.data(), silhouette.data(), numScores);
+
+        // Mark the chosen count
+        double elbow = sweep.elbowClusters;
+        ImPlot::PlotInfLines("Elbow", &elbow, 1);
+
+        ImPlot::EndPlot();
+    }
+}
+
 // Render the settings window
 void UIManager::RenderSettingsWindow()
 {
@@ -1190,6 +1351,29 @@ void UIManager::RenderStatusBar()
     // FPS
     ImGui::Text("FPS: %.1f", ImGui::GetIO().Framerate);
 
+    // Report export progress, and its result for a few seconds once it finishes
+    ReportExportState exportState = m_application->GetReportExportState();
+    bool exportRunning = exportState == ReportExportState::Running;
+    if (m_reportExportRunning && !exportRunning) {
+        m_reportNoticeUntil = ImGui::GetTime() + 5.0;
+    }
+    m_reportExportRunning = exportRunning;
+
+    if (exportRunning) {
+        ImGui::SameLine();
+        ImGui::Text("Exporting report...");
+    }
+    else if (ImGui::GetTime() < m_reportNoticeUntil) {
+        const std::string& reportFile = m_application->GetReportExportFilename();
+        ImGui::SameLine();
+        if (exportState == ReportExportState::Succeeded) {
+            ImGui::TextColored(ImVec4(0.4f, 0.9f, 0.4f, 1.0f), "Report saved to %s", reportFile.c_str());
+        }
+        else {
+            ImGui::TextColored(ImVec4(0.9f, 0.4f, 0.4f, 1.0f), "Report export failed: %s", reportFile.c_str());
+        }
+    }
+
     ImGui::End();
 
     ImGui::PopStyleColor();
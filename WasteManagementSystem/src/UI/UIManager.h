@@ -9,6 +9,7 @@
 // Forward declarations
 struct GLFWwindow;
 class Application;
+struct ClusterCountSweep;
 
 // Include the full class definitions for these components
 // This fixes the incomplete type error with std::unique_ptr
@@ -39,6 +40,10 @@ private:
     int m_windowWidth;
     int m_windowHeight;
 
+    // Background report export shown in the status bar
+    bool m_reportExportRunning;     // Export was running last frame
+    double m_reportNoticeUntil;     // ImGui time until which the export result stays visible
+
     // ImGui setup
     void SetupImGuiStyle();
     void SetupImGuiConfig();
@@ -58,6 +63,9 @@ private:
     void RenderRouteLearningUI();
     void RenderLocationClusteringUI();
 
+    // Plot inertia and silhouette of a cluster count sweep
+    void PlotClusterCountSweep(const ClusterCountSweep& sweep);
+
 public:
     UIManager(Application* application);
     ~UIManager();
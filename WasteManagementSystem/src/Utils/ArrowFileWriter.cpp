@@ -0,0 +1,506 @@
+// ArrowFileWriter.cpp
+// Implementation of the Arrow IPC file writer
+#include "pch.h"
+#include "ArrowFileWriter.h"
+#include <cstring>
+
+namespace {
+    // File layout (see the Arrow columnar format specification):
+    //   "ARROW1" and 2 bytes of padding
+    //   schema message, one dictionary batch per dictionary column, record batches
+    //   end-of-stream marker
+    //   footer flatbuffer, its length as int32, "ARROW1"
+    // Every message is 0xFFFFFFFF, the metadata length, a Message flatbuffer padded
+    // to 8 bytes, then the body with every buffer aligned to ArrowBufferAlignment.
+    const char ArrowMagic[6] = { 'A', 'R', 'R', 'O', 'W', '1' };
+    const size_t ArrowBufferAlignment = 64;
+
+    // Values from the Arrow flatbuffer schemas
+    const int16_t MetadataVersionV5 = 4;
+    const uint8_t HeaderSchema = 1;
+    const uint8_t HeaderDictionaryBatch = 2;
+    const uint8_t HeaderRecordBatch = 3;
+    const uint8_t TypeInt = 2;
+    const uint8_t TypeFloatingPoint = 3;
+    const uint8_t TypeUtf8 = 5;
+    const int16_t PrecisionSingle = 1;
+
+    size_t AlignTo(size_t size, size_t alignment)
+    {
+        return (size + alignment - 1) / alignment * alignment;
+    }
+
+    // Minimal flatbuffer builder. Like the reference implementation it builds the
+    // buffer back to front, so children are created before the tables that refer
+    // to them; offsets returned are distances from the end of the buffer.
+    class FlatBuilder {
+    private:
+        std::vector<uint8_t> m_bytes;   // Buffer in reverse byte order until Finish
+        size_t m_minAlign = 1;
+        uint32_t m_tableStart = 0;
+        std::vector<std::pair<int, uint32_t>> m_fields;  // Slot and offset of every field of the open table
+
+        template <typename T>
+        void PushRaw(T value)
+        {
+            uint8_t raw[sizeof(T)];
+            std::memcpy(raw, &value, sizeof(T));
+            for (size_t i = sizeof(T); i-- > 0;) {
+                m_bytes.push_back(raw[i]);
+            }
+        }
+
+    public:
+        uint32_t Size() const { return static_cast<uint32_t>(m_bytes.size()); }
+
+        // Pad so that the buffer is aligned after another additional bytes
+        void Prep(size_t alignment, size_t additional)
+        {
+            m_minAlign = std::max(m_minAlign, alignment);
+            size_t padding = (~(m_bytes.size() + additional) + 1) & (alignment - 1);
+            m_bytes.insert(m_bytes.end(), padding, 0);
+        }
+
+        template <typename T>
+        uint32_t Push(T value)
+        {
+            Prep(sizeof(T), 0);
+            PushRaw(value);
+            return Size();
+        }
+
+        uint32_t PushOffset(uint32_t target)
+        {
+            Prep(sizeof(uint32_t), 0);
+            PushRaw<uint32_t>(Size() + sizeof(uint32_t) - target);
+            return Size();
+        }
+
+        void PushPadding(size_t size)
+        {
+            m_bytes.insert(m_bytes.end(), size, 0);
+        }
+
+        uint32_t CreateString(std::string_view text)
+        {
+            Prep(sizeof(uint32_t), text.size() + 1);
+            m_bytes.push_back(0);
+            for (size_t i = text.size(); i-- > 0;) {
+                m_bytes.push_back(static_cast<uint8_t>(text[i]));
+            }
+            PushRaw<uint32_t>(static_cast<uint32_t>(text.size()));
+            return Size();
+        }
+
+        // Elements are pushed last to first between StartVector and EndVector
+        void StartVector(size_t count, size_t elementSize, size_t alignment)
+        {
+            Prep(sizeof(uint32_t), count * elementSize);
+            Prep(alignment, count * elementSize);
+        }
+
+        uint32_t EndVector(size_t count)
+        {
+            PushRaw<uint32_t>(static_cast<uint32_t>(count));
+            return Size();
+        }
+
+        uint32_t CreateOffsetVector(const std::vector<uint32_t>& offsets)
+        {
+            StartVector(offsets.size(), sizeof(uint32_t), sizeof(uint32_t));
+            for (size_t i = offsets.size(); i-- > 0;) {
+                PushOffset(offsets[i]);
+            }
+            return EndVector(offsets.size());
+        }
+
+        // Struct of two int64 values, as FieldNode and Buffer
+        void PushPair(int64_t first, int64_t second)
+        {
+            PushRaw(second);
+            PushRaw(first);
+        }
+
+        void StartTable()
+        {
+            m_fields.clear();
+            m_tableStart = Size();
+        }
+
+        template <typename T>
+        void AddField(int slot, T value)
+        {
+            m_fields.emplace_back(slot, Push(value));
+        }
+
+        void AddOffsetField(int slot, uint32_t target)
+        {
+            m_fields.emplace_back(slot, PushOffset(target));
+        }
+
+        // Write the table's vtable right in front of it
+        uint32_t EndTable()
+        {
+            uint32_t table = Push<int32_t>(0);
+
+            int numSlots = 0;
+            for (const auto& field : m_fields) {
+                numSlots = std::max(numSlots, field.first + 1);
+            }
+            std::vector<uint16_t> slots(numSlots, 0);
+            for (const auto& field : m_fields) {
+                slots[field.first] = static_cast<uint16_t>(table - field.second);
+            }
+
+            for (int i = numSlots; i-- > 0;) {
+                PushRaw<uint16_t>(slots[i]);
+            }
+            PushRaw<uint16_t>(static_cast<uint16_t>(table - m_tableStart));
+            PushRaw<uint16_t>(static_cast<uint16_t>(sizeof(uint16_t) * (2 + numSlots)));
+            uint32_t vtable = Size();
+
+            // The table starts with the distance back to its vtable
+            int32_t vtableDistance = static_cast<int32_t>(vtable - table);
+            uint8_t raw[sizeof(int32_t)];
+            std::memcpy(raw, &vtableDistance, sizeof(raw));
+            for (size_t i = 0; i < sizeof(raw); i++) {
+                m_bytes[table - 1 - i] = raw[i];
+            }
+
+            m_fields.clear();
+            return table;
+        }
+
+        std::vector<uint8_t> Finish(uint32_t root)
+        {
+            Prep(m_minAlign, sizeof(uint32_t));
+            PushOffset(root);
+            std::reverse(m_bytes.begin(), m_bytes.end());
+            return std::move(m_bytes);
+        }
+    };
+
+    uint32_t CreateIntType(FlatBuilder& builder)
+    {
+        builder.StartTable();
+        builder.AddField<int32_t>(0, 32);       // bitWidth
+        builder.AddField<uint8_t>(1, 1);        // is_signed
+        return builder.EndTable();
+    }
+
+    uint32_t CreateSchema(FlatBuilder& builder, const std::vector<std::pair<std::string, ArrowFileWriter::ColumnType>>& columns)
+    {
+        std::vector<uint32_t> fields;
+        for (size_t i = 0; i < columns.size(); i++) {
+            uint32_t name = builder.CreateString(columns[i].first);
+            uint32_t children = builder.CreateOffsetVector({});
+
+            uint8_t typeType;
+            uint32_t type;
+            uint32_t dictionary = 0;
+            switch (columns[i].second) {
+            case ArrowFileWriter::ColumnType::Int32:
+                typeType = TypeInt;
+                type = CreateIntType(builder);
+                break;
+            case ArrowFileWriter::ColumnType::Float32:
+                typeType = TypeFloatingPoint;
+                builder.StartTable();
+                builder.AddField<int16_t>(0, PrecisionSingle);
+                type = builder.EndTable();
+                break;
+            default: {
+                // Dictionary columns hold UTF-8 values; the dictionary ID is the column index
+                typeType = TypeUtf8;
+                builder.StartTable();
+                type = builder.EndTable();
+
+                uint32_t indexType = CreateIntType(builder);
+                builder.StartTable();
+                builder.AddField<int64_t>(0, static_cast<int64_t>(i));   // id
+                builder.AddOffsetField(1, indexType);                    // indexType
+                dictionary = builder.EndTable();
+                break;
+            }
+            }
+
+            builder.StartTable();
+            builder.AddOffsetField(0, name);
+            builder.AddField<uint8_t>(1, 0);            // nullable
+            builder.AddField<uint8_t>(2, typeType);
+            builder.AddOffsetField(3, type);
+            if (dictionary != 0) {
+                builder.AddOffsetField(4, dictionary);
+            }
+            builder.AddOffsetField(5, children);
+            fields.push_back(builder.EndTable());
+        }
+
+        uint32_t fieldVector = builder.CreateOffsetVector(fields);
+        builder.StartTable();
+        builder.AddField<int16_t>(0, 0);                // endianness: little
+        builder.AddOffsetField(1, fieldVector);
+        return builder.EndTable();
+    }
+
+    // Offsets of buffers laid out one after another in a message body
+    std::vector<size_t> LayoutBody(const std::vector<size_t>& sizes, size_t& bodyLength)
+    {
+        std::vector<size_t> offsets(sizes.size());
+        size_t position = 0;
+        for (size_t i = 0; i < sizes.size(); i++) {
+            offsets[i] = position;
+            position = AlignTo(position + sizes[i], ArrowBufferAlignment);
+        }
+        bodyLength = position;
+        return offsets;
+    }
+
+    // RecordBatch table with one node per column and (offset, size) per buffer
+    uint32_t CreateRecordBatch(FlatBuilder& builder, size_t numRows, size_t numColumns,
+        const std::vector<size_t>& offsets, const std::vector<size_t>& sizes)
+    {
+        builder.StartVector(numColumns, 16, 8);
+        for (size_t i = 0; i < numColumns; i++) {
+            builder.PushPair(static_cast<int64_t>(numRows), 0);     // length, null_count
+        }
+        uint32_t nodes = builder.EndVector(numColumns);
+
+        builder.StartVector(sizes.size(), 16, 8);
+        for (size_t i = sizes.size(); i-- > 0;) {
+            builder.PushPair(static_cast<int64_t>(offsets[i]), static_cast<int64_t>(sizes[i]));
+        }
+        uint32_t buffers = builder.EndVector(sizes.size());
+
+        builder.StartTable();
+        builder.AddField<int64_t>(0, static_cast<int64_t>(numRows));
+        builder.AddOffsetField(1, nodes);
+        builder.AddOffsetField(2, buffers);
+        return builder.EndTable();
+    }
+
+    std::vector<uint8_t> FinishMessage(FlatBuilder& builder, uint8_t headerType, uint32_t header, size_t bodyLength)
+    {
+        builder.StartTable();
+        builder.AddField<int16_t>(0, MetadataVersionV5);
+        builder.AddField<uint8_t>(1, headerType);
+        builder.AddOffsetField(2, header);
+        builder.AddField<int64_t>(3, static_cast<int64_t>(bodyLength));
+        return builder.Finish(builder.EndTable());
+    }
+}
+
+ArrowFileWriter::ArrowFileWriter()
+    : m_position(0),
+    m_failed(false)
+{
+}
+
+ArrowFileWriter::~ArrowFileWriter()
+{
+    if (m_file.is_open()) {
+        Close();
+    }
+}
+
+void ArrowFileWriter::AddColumn(const std::string& name, ColumnType type)
+{
+    m_columns.push_back({ name, type, {} });
+}
+
+void ArrowFileWriter::AddDictionaryColumn(const std::string& name, const std::vector<std::string>& dictionary)
+{
+    m_columns.push_back({ name, ColumnType::Dictionary, dictionary });
+}
+
+void ArrowFileWriter::WriteBytes(const void* data, size_t size)
+{
+    m_file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+    m_position += static_cast<int64_t>(size);
+}
+
+void ArrowFileWriter::WritePadding(size_t size)
+{
+    static const char zeros[ArrowBufferAlignment] = {};
+    while (size > 0) {
+        size_t chunk = std::min(size, sizeof(zeros));
+        WriteBytes(zeros, chunk);
+        size -= chunk;
+    }
+}
+
+ArrowFileWriter::Block ArrowFileWriter::WriteMessage(const std::vector<uint8_t>& metadata,
+    const std::vector<uint8_t>& body)
+{
+    Block block;
+    block.offset = m_position;
+
+    uint32_t continuation = 0xFFFFFFFFu;
+    int32_t paddedLength = static_cast<int32_t>(AlignTo(metadata.size(), 8));
+    WriteBytes(&continuation, sizeof(continuation));
+    WriteBytes(&paddedLength, sizeof(paddedLength));
+    WriteBytes(metadata.data(), metadata.size());
+    WritePadding(paddedLength - metadata.size());
+    WriteBytes(body.data(), body.size());
+
+    block.metadataLength = paddedLength + 8;
+    block.bodyLength = static_cast<int64_t>(body.size());
+    return block;
+}
+
+std::vector<uint8_t> ArrowFileWriter::BuildSchemaMessage() const
+{
+    std::vector<std::pair<std::string, ColumnType>> columns;
+    for (const auto& column : m_columns) {
+        columns.emplace_back(column.name, column.type);
+    }
+
+    FlatBuilder builder;
+    uint32_t schema = CreateSchema(builder, columns);
+    return FinishMessage(builder, HeaderSchema, schema, 0);
+}
+
+std::vector<uint8_t> ArrowFileWriter::BuildFooter() const
+{
+    std::vector<std::pair<std::string, ColumnType>> columns;
+    for (const auto& column : m_columns) {
+        columns.emplace_back(column.name, column.type);
+    }
+
+    FlatBuilder builder;
+    uint32_t schema = CreateSchema(builder, columns);
+
+    // Block structs: offset, metaDataLength, 4 bytes of padding, bodyLength
+    uint32_t blockVectors[2];
+    const std::vector<Block>* blockLists[2] = { &m_dictionaryBlocks, &m_recordBlocks };
+    for (int list = 0; list < 2; list++) {
+        const std::vector<Block>& blocks = *blockLists[list];
+        builder.StartVector(blocks.size(), 24, 8);
+        for (size_t i = blocks.size(); i-- > 0;) {
+            builder.Push<int64_t>(blocks[i].bodyLength);
+            builder.PushPadding(4);
+            builder.Push<int32_t>(blocks[i].metadataLength);
+            builder.Push<int64_t>(blocks[i].offset);
+        }
+        blockVectors[list] = builder.EndVector(blocks.size());
+    }
+
+    builder.StartTable();
+    builder.AddField<int16_t>(0, MetadataVersionV5);
+    builder.AddOffsetField(1, schema);
+    builder.AddOffsetField(2, blockVectors[0]);
+    builder.AddOffsetField(3, blockVectors[1]);
+    return builder.Finish(builder.EndTable());
+}
+
+bool ArrowFileWriter::Open(const std::string& filename)
+{
+    m_file.open(filename, std::ios::binary);
+    if (!m_file.is_open()) {
+        return false;
+    }
+
+    m_position = 0;
+    m_failed = false;
+    m_dictionaryBlocks.clear();
+    m_recordBlocks.clear();
+
+    WriteBytes(ArrowMagic, sizeof(ArrowMagic));
+    WritePadding(2);
+    WriteMessage(BuildSchemaMessage(), {});
+
+    // One dictionary batch per dictionary column: a single UTF-8 column of the values
+    for (size_t i = 0; i < m_columns.size(); i++) {
+        const Column& column = m_columns[i];
+        if (column.type != ColumnType::Dictionary) {
+            continue;
+        }
+
+        std::vector<int32_t> valueOffsets(1, 0);
+        size_t valueBytes = 0;
+        for (const auto& value : column.dictionary) {
+            valueBytes += value.size();
+            valueOffsets.push_back(static_cast<int32_t>(valueBytes));
+        }
+
+        std::vector<size_t> sizes = { 0, valueOffsets.size() * sizeof(int32_t), valueBytes };
+        size_t bodyLength;
+        std::vector<size_t> offsets = LayoutBody(sizes, bodyLength);
+
+        std::vector<uint8_t> body(bodyLength, 0);
+        std::memcpy(body.data() + offsets[1], valueOffsets.data(), sizes[1]);
+        uint8_t* values = body.data() + offsets[2];
+        for (const auto& value : column.dictionary) {
+            std::memcpy(values, value.data(), value.size());
+            values += value.size();
+        }
+
+        FlatBuilder builder;
+        uint32_t data = CreateRecordBatch(builder, column.dictionary.size(), 1, offsets, sizes);
+        builder.StartTable();
+        builder.AddField<int64_t>(0, static_cast<int64_t>(i));   // id
+        builder.AddOffsetField(1, data);
+        uint32_t batch = builder.EndTable();
+
+        m_dictionaryBlocks.push_back(WriteMessage(FinishMessage(builder, HeaderDictionaryBatch, batch, bodyLength), body));
+    }
+
+    return static_cast<bool>(m_file);
+}
+
+bool ArrowFileWriter::WriteBatch(size_t numRows, const std::vector<const void*>& columns)
+{
+    if (!m_file.is_open() || columns.size() != m_columns.size()) {
+        m_failed = true;
+        return false;
+    }
+
+    // A validity buffer (empty, there are no nulls) and a value buffer per column
+    std::vector<size_t> sizes;
+    for (size_t i = 0; i < m_columns.size(); i++) {
+        sizes.push_back(0);
+        sizes.push_back(numRows * 4);
+    }
+    size_t bodyLength;
+    std::vector<size_t> offsets = LayoutBody(sizes, bodyLength);
+
+    FlatBuilder builder;
+    uint32_t batch = CreateRecordBatch(builder, numRows, m_columns.size(), offsets, sizes);
+    std::vector<uint8_t> metadata = FinishMessage(builder, HeaderRecordBatch, batch, bodyLength);
+
+    // The column arrays are written straight from the caller's memory
+    Block block = WriteMessage(metadata, {});
+    int64_t bodyStart = m_position;
+    for (size_t i = 0; i < sizes.size(); i++) {
+        WritePadding(static_cast<size_t>(bodyStart + offsets[i] - m_position));
+        if (sizes[i] > 0) {
+            WriteBytes(columns[i / 2], sizes[i]);
+        }
+    }
+    WritePadding(static_cast<size_t>(bodyStart + bodyLength - m_position));
+
+    block.bodyLength = static_cast<int64_t>(bodyLength);
+    m_recordBlocks.push_back(block);
+    return static_cast<bool>(m_file);
+}
+
+bool ArrowFileWriter::Close()
+{
+    if (!m_file.is_open()) {
+        return false;
+    }
+
+    // End-of-stream marker, then the footer that indexes every message
+    uint32_t endOfStream[2] = { 0xFFFFFFFFu, 0 };
+    WriteBytes(endOfStream, sizeof(endOfStream));
+
+    std::vector<uint8_t> footer = BuildFooter();
+    int32_t footerLength = static_cast<int32_t>(footer.size());
+    WriteBytes(footer.data(), footer.size());
+    WriteBytes(&footerLength, sizeof(footerLength));
+    WriteBytes(ArrowMagic, sizeof(ArrowMagic));
+
+    bool written = static_cast<bool>(m_file) && !m_failed;
+    m_file.close();
+    return written;
+}
@@ -0,0 +1,115 @@
+// ArrowFileWriter.h
+// Writer for tables in the Apache Arrow IPC file format
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+
+/**
+ * @brief Writes a table as an Arrow IPC file (Feather v2)
+ *
+ * Columns are declared first, then rows are written in record batches.
+ * Every column is stored as one contiguous typed buffer per batch, so
+ * readers such as pyarrow or pandas can map the file without parsing it.
+ * String columns are dictionary encoded: the distinct values are written
+ * once and every row stores a 32-bit index into them.
+ *
+ * The flatbuffer metadata is produced by a small built-in builder, so no
+ * Arrow or flatbuffers library is needed.
+ */
+class ArrowFileWriter {
+public:
+    /**
+     * @brief Value types of a column
+     */
+    enum class ColumnType {
+        Int32,          // 32-bit signed integers
+        Float32,        // Single precision floats
+        Dictionary      // UTF-8 strings stored as int32 indices into a dictionary
+    };
+
+private:
+    struct Column {
+        std::string name;
+        ColumnType type;
+        std::vector<std::string> dictionary;    // Values of a dictionary column
+    };
+
+    // Location and size of a message, for the file footer
+    struct Block {
+        int64_t offset;
+        int32_t metadataLength;
+        int64_t bodyLength;
+    };
+
+    /* Private members in ArrowFileWriter class */
+    std::ofstream m_file;
+    std::vector<Column> m_columns;
+    std::vector<Block> m_dictionaryBlocks;
+    std::vector<Block> m_recordBlocks;
+    int64_t m_position;             // Bytes written so far
+    bool m_failed;
+
+    void WriteBytes(const void* data, size_t size);
+    void WritePadding(size_t size);
+
+    // Write one message (metadata and body) and return its block
+    Block WriteMessage(const std::vector<uint8_t>& metadata, const std::vector<uint8_t>& body);
+
+    // Flatbuffers of the schema message and of the file footer; both carry the schema
+    std::vector<uint8_t> BuildSchemaMessage() const;
+    std::vector<uint8_t> BuildFooter() const;
+
+public:
+    /**
+     * @brief Constructor for ArrowFileWriter
+     */
+    ArrowFileWriter();
+
+    /**
+     * @brief Destructor, finishes the file if it is still open
+     */
+    ~ArrowFileWriter();
+
+    ArrowFileWriter(const ArrowFileWriter&) = delete;
+    ArrowFileWriter& operator=(const ArrowFileWriter&) = delete;
+
+    /**
+     * @brief Declare a column; all columns must be added before Open
+     * @param name Column name
+     * @param type Value type
+     */
+    void AddColumn(const std::string& name, ColumnType type);
+
+    /**
+     * @brief Declare a dictionary encoded string column
+     * @param name Column name
+     * @param dictionary Distinct values; rows store indices into this list
+     */
+    void AddDictionaryColumn(const std::string& name, const std::vector<std::string>& dictionary);
+
+    /**
+     * @brief Create the file and write the schema and dictionaries
+     * @param filename Output filename
+     * @return True if successful, false otherwise
+     */
+    bool Open(const std::string& filename);
+
+    /**
+     * @brief Write one record batch
+     * @param numRows Number of rows in the batch
+     * @param columns One array of numRows values per column, in column order:
+     *                int32_t for Int32 and Dictionary columns, float for Float32
+     * @return True if successful, false otherwise
+     */
+    bool WriteBatch(size_t numRows, const std::vector<const void*>& columns);
+
+    /**
+     * @brief Write the footer and close the file
+     * @return True if the whole file was written, false otherwise
+     */
+    bool Close();
+};
@@ -0,0 +1,68 @@
+// BufferedWriter.cpp
+// Implementation of the buffered text file writer
+#include "pch.h"
+#include "BufferedWriter.h"
+
+BufferedWriter::BufferedWriter(size_t bufferSize)
+    : m_buffer(std::max<size_t>(bufferSize, MaxNumberLength)),
+    m_size(0)
+{
+}
+
+BufferedWriter::~BufferedWriter()
+{
+    if (m_file.is_open()) {
+        Close();
+    }
+}
+
+bool BufferedWriter::Open(const std::string& filename)
+{
+    if (m_file.is_open()) {
+        Close();
+    }
+
+    m_size = 0;
+    m_file.open(filename);
+    return m_file.is_open();
+}
+
+bool BufferedWriter::Close()
+{
+    FlushBuffer();
+    bool written = static_cast<bool>(m_file);
+    m_file.close();
+    return written;
+}
+
+void BufferedWriter::FlushBuffer()
+{
+    if (m_size > 0) {
+        m_file.write(m_buffer.data(), static_cast<std::streamsize>(m_size));
+        m_size = 0;
+    }
+}
+
+BufferedWriter& BufferedWriter::Write(std::string_view text)
+{
+    // Text longer than the buffer goes straight to the file
+    if (text.size() > m_buffer.size()) {
+        FlushBuffer();
+        m_file.write(text.data(), static_cast<std::streamsize>(text.size()));
+        return *this;
+    }
+
+    Reserve(text.size());
+    std::copy(text.begin(), text.end(), m_buffer.begin() + m_size);
+    m_size += text.size();
+    return *this;
+}
+
+BufferedWriter& BufferedWriter::operator<<(double value)
+{
+    // General format with 6 significant digits, as std::ostream writes by default
+    Reserve(MaxNumberLength);
+    char* begin = m_buffer.data() + m_size;
+    m_size += std::to_chars(begin, begin + MaxNumberLength, value, std::chars_format::general, 6).ptr - begin;
+    return *this;
+}
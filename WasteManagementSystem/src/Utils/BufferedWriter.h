@@ -0,0 +1,102 @@
+// BufferedWriter.h
+// Buffered text file writer with locale-free number formatting
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fstream>
+#include <charconv>
+
+/**
+ * @brief Writes text to a file through a large in-memory buffer
+ *
+ * Text and numbers are appended to the buffer and written to the file in
+ * large blocks, so nothing is flushed per line. Numbers are formatted with
+ * std::to_chars; floating point values use the same 6 significant digits
+ * as the default stream output, so reports keep their format.
+ */
+class BufferedWriter {
+private:
+    /* Private members in BufferedWriter class */
+    std::ofstream m_file;       // Output file
+    std::vector<char> m_buffer; // Pending output
+    size_t m_size;              // Bytes used in m_buffer
+
+    // Longest text to_chars produces for any number
+    static constexpr size_t MaxNumberLength = 32;
+
+    // Make room for a number of bytes, writing the buffer out if needed
+    void Reserve(size_t bytes)
+    {
+        if (m_size + bytes > m_buffer.size()) {
+            FlushBuffer();
+        }
+    }
+
+    void FlushBuffer();
+
+    template <typename T>
+    BufferedWriter& WriteInteger(T value)
+    {
+        Reserve(MaxNumberLength);
+        char* begin = m_buffer.data() + m_size;
+        m_size += std::to_chars(begin, begin + MaxNumberLength, value).ptr - begin;
+        return *this;
+    }
+
+public:
+    /**
+     * @brief Constructor for BufferedWriter
+     * @param bufferSize Size of the output buffer in bytes
+     */
+    explicit BufferedWriter(size_t bufferSize = 1 << 20);
+
+    /**
+     * @brief Destructor, writes out anything still buffered
+     */
+    ~BufferedWriter();
+
+    BufferedWriter(const BufferedWriter&) = delete;
+    BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+    /**
+     * @brief Open a file for writing, replacing its contents
+     * @param filename Output filename
+     * @return True if successful, false otherwise
+     */
+    bool Open(const std::string& filename);
+
+    /**
+     * @brief Write out the buffer and close the file
+     * @return True if everything was written, false otherwise
+     */
+    bool Close();
+
+    /**
+     * @brief Append text
+     * @param text Text to append
+     */
+    BufferedWriter& Write(std::string_view text);
+
+    BufferedWriter& operator<<(std::string_view text) { return Write(text); }
+    BufferedWriter& operator<<(const char* text) { return Write(std::string_view(text)); }
+    BufferedWriter& operator<<(const std::string& text) { return Write(std::string_view(text)); }
+
+    BufferedWriter& operator<<(char c)
+    {
+        Reserve(1);
+        m_buffer[m_size++] = c;
+        return *this;
+    }
+
+    BufferedWriter& operator<<(int value) { return WriteInteger(value); }
+    BufferedWriter& operator<<(unsigned int value) { return WriteInteger(value); }
+    BufferedWriter& operator<<(long value) { return WriteInteger(value); }
+    BufferedWriter& operator<<(unsigned long value) { return WriteInteger(value); }
+    BufferedWriter& operator<<(long long value) { return WriteInteger(value); }
+    BufferedWriter& operator<<(unsigned long long value) { return WriteInteger(value); }
+
+    BufferedWriter& operator<<(double value);
+    BufferedWriter& operator<<(float value) { return *this << static_cast<double>(value); }
+};
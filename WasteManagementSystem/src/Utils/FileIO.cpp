@@ -2,6 +2,277 @@
 // Implementation of file I/O utilities
 #include "pch.h"
 #include "FileIO.h"
+#include "ThreadPool.h"
+#include "LocationSnapshot.h"
+#include "BufferedWriter.h"
+#include "ArrowFileWriter.h"
+#include <charconv>
+#include <string_view>
+#include <cstring>
+#include <future>
+
+namespace {
+    // Location names indexed by ID, looked up once per export instead of once per stop
+    class LocationNameTable {
+    private:
+        std::vector<std::string_view> m_names;
+
+    public:
+        LocationNameTable()
+        {
+            for (const auto& pair : WasteLocation::dict_Id_to_Name) {
+                if (pair.first >= 0) {
+                    if (static_cast<size_t>(pair.first) >= m_names.size()) {
+                        m_names.resize(pair.first + 1);
+                    }
+                    m_names[pair.first] = pair.second;
+                }
+            }
+        }
+
+        std::string_view operator[](int id) const
+        {
+            return (id >= 0 && static_cast<size_t>(id) < m_names.size()) ? m_names[id] : std::string_view();
+        }
+
+        // Names indexed by location ID, for dictionary encoded columns
+        std::vector<std::string> GetDictionary() const
+        {
+            return std::vector<std::string>(m_names.begin(), m_names.end());
+        }
+    };
+
+    // Rows per record batch of an Arrow export
+    const size_t ArrowRowsPerBatch = 1024 * 1024;
+
+    // Bytes read from an inventory file at a time
+    const size_t InventoryBlockSize = 32 * 1024 * 1024;
+
+    // Bytes of a block parsed by one task
+    const size_t InventoryBytesPerChunk = 1024 * 1024;
+
+    // Fields of an inventory row
+    enum InventoryField {
+        FieldId,
+        FieldName,
+        FieldX,
+        FieldY,
+        FieldWasteLevel,
+        FieldCapacity,
+        NumInventoryFields
+    };
+
+    // How the columns of an inventory file map onto the fields
+    struct InventoryLayout {
+        char delimiter = ',';
+        std::vector<int> columnFields;  // Field of every column, -1 if unused
+    };
+
+    // Rows parsed from one chunk of a block
+    struct InventoryChunk {
+        LocationStore store;
+        size_t skippedRows = 0;
+    };
+
+    std::string_view TrimField(std::string_view field)
+    {
+        while (!field.empty() && (field.front() == ' ' || field.front() == '\t')) {
+            field.remove_prefix(1);
+        }
+        while (!field.empty() && (field.back() == ' ' || field.back() == '\t' || field.back() == '\r')) {
+            field.remove_suffix(1);
+        }
+        return field;
+    }
+
+    // Parse a whole field as a number; from_chars neither allocates nor depends on the locale
+    template <typename T>
+    bool ParseNumber(std::string_view field, T& value)
+    {
+        field = TrimField(field);
+        if (!field.empty() && field.front() == '+') {
+            field.remove_prefix(1);
+        }
+        if (field.empty()) {
+            return false;
+        }
+
+        const char* end = field.data() + field.size();
+        auto result = std::from_chars(field.data(), end, value);
+        return result.ec == std::errc() && result.ptr == end;
+    }
+
+    // Split one line into its fields; quoted fields may contain the delimiter and "" for a quote
+    void SplitInventoryLine(const char* begin, const char* end, const InventoryLayout& layout,
+        std::string_view* fields, bool* escaped)
+    {
+        const char delimiter = layout.delimiter;
+        const size_t numColumns = layout.columnFields.size();
+        const char* p = begin;
+
+        for (size_t column = 0; ; column++) {
+            const char* fieldBegin = p;
+            const char* fieldEnd;
+            bool hasEscapes = false;
+
+            if (p < end && *p == '"') {
+                const char* q = p + 1;
+                while (q < end) {
+                    if (*q == '"') {
+                        if (q + 1 < end && q[1] == '"') {
+                            hasEscapes = true;
+                            q += 2;
+                            continue;
+                        }
+                        break;
+                    }
+                    q++;
+                }
+                fieldBegin = p + 1;
+                fieldEnd = q;
+                p = q < end ? q + 1 : end;
+                while (p < end && *p != delimiter) {
+                    p++;
+                }
+            }
+            else {
+                const void* found = std::memchr(p, delimiter, static_cast<size_t>(end - p));
+                p = found ? static_cast<const char*>(found) : end;
+                fieldEnd = p;
+            }
+
+            int field = column < numColumns ? layout.columnFields[column] : -1;
+            if (field >= 0) {
+                fields[field] = std::string_view(fieldBegin, static_cast<size_t>(fieldEnd - fieldBegin));
+                escaped[field] = hasEscapes;
+            }
+
+            if (p >= end) {
+                return;
+            }
+            p++;
+        }
+    }
+
+    // Parse one line into the store; returns false if the row is malformed
+    bool ParseInventoryRow(const char* begin, const char* end, const InventoryLayout& layout,
+        std::string& scratch, LocationStore& store)
+    {
+        std::string_view fields[NumInventoryFields];
+        bool escaped[NumInventoryFields] = {};
+        SplitInventoryLine(begin, end, layout, fields, escaped);
+
+        int32_t id = 0;
+        float x = 0.0f;
+        float y = 0.0f;
+        float wasteLevel = 0.0f;
+        float capacity = 0.0f;
+
+        if (!ParseNumber(fields[FieldId], id) || !ParseNumber(fields[FieldX], x) || !ParseNumber(fields[FieldY], y)) {
+            return false;
+        }
+
+        // Optional fields only fail the row if they are present but not numbers
+        if (!TrimField(fields[FieldWasteLevel]).empty() && !ParseNumber(fields[FieldWasteLevel], wasteLevel)) {
+            return false;
+        }
+        if (!TrimField(fields[FieldCapacity]).empty() && !ParseNumber(fields[FieldCapacity], capacity)) {
+            return false;
+        }
+
+        std::string_view name = fields[FieldName];
+        if (escaped[FieldName]) {
+            scratch.clear();
+            for (size_t i = 0; i < name.size(); i++) {
+                scratch += name[i];
+                if (name[i] == '"') {
+                    i++;
+                }
+            }
+            name = scratch;
+        }
+
+        store.Add(id, name, x, y, wasteLevel, capacity);
+        return true;
+    }
+
+    // Parse every line of a range; empty lines are skipped
+    void ParseInventoryLines(const char* begin, const char* end, const InventoryLayout& layout, InventoryChunk& chunk)
+    {
+        std::string scratch;
+        const char* line = begin;
+        while (line < end) {
+            const void* found = std::memchr(line, '\n', static_cast<size_t>(end - line));
+            const char* lineEnd = found ? static_cast<const char*>(found) : end;
+
+            const char* contentEnd = lineEnd;
+            if (contentEnd > line && contentEnd[-1] == '\r') {
+                contentEnd--;
+            }
+            if (contentEnd > line && !ParseInventoryRow(line, contentEnd, layout, scratch, chunk.store)) {
+                chunk.skippedRows++;
+            }
+
+            line = lineEnd + 1;
+        }
+    }
+
+    // Detect the delimiter and the column order from the first line; returns true if it is a header
+    bool ReadInventoryLayout(std::string_view firstLine, InventoryLayout& layout)
+    {
+        size_t tabs = std::count(firstLine.begin(), firstLine.end(), '\t');
+        size_t commas = std::count(firstLine.begin(), firstLine.end(), ',');
+        layout.delimiter = (tabs > 0 && tabs >= commas) ? '\t' : ',';
+
+        // Column names, or the values of the first row if there is no header
+        std::vector<std::string> names;
+        size_t start = 0;
+        while (true) {
+            size_t next = firstLine.find(layout.delimiter, start);
+            std::string_view name = TrimField(firstLine.substr(start, next == std::string_view::npos ? std::string_view::npos : next - start));
+            if (name.size() >= 2 && name.front() == '"' && name.back() == '"') {
+                name = name.substr(1, name.size() - 2);
+            }
+            std::string lower(name);
+            std::transform(lower.begin(), lower.end(), lower.begin(),
+                [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            names.push_back(lower);
+
+            if (next == std::string_view::npos) {
+                break;
+            }
+            start = next + 1;
+        }
+
+        // A first column that is a number means there is no header
+        int32_t id;
+        if (ParseNumber(std::string_view(names[0]), id)) {
+            layout.columnFields.clear();
+            for (int field = 0; field < NumInventoryFields; field++) {
+                layout.columnFields.push_back(field);
+            }
+            return false;
+        }
+
+        static const std::unordered_map<std::string, int> fieldNames = {
+            { "id", FieldId }, { "bin_id", FieldId }, { "binid", FieldId },
+            { "name", FieldName }, { "location", FieldName }, { "location_name", FieldName },
+            { "x", FieldX }, { "y", FieldY },
+            { "waste_level", FieldWasteLevel }, { "wastelevel", FieldWasteLevel },
+            { "waste", FieldWasteLevel }, { "fill_level", FieldWasteLevel },
+            { "capacity", FieldCapacity }
+        };
+
+        layout.columnFields.assign(names.size(), -1);
+        for (size_t column = 0; column < names.size(); column++) {
+            auto it = fieldNames.find(names[column]);
+            if (it != fieldNames.end()) {
+                layout.columnFields[column] = it->second;
+            }
+        }
+        return true;
+    }
+}
 
 namespace FileIO {
 
@@ -10,98 +281,115 @@ namespace FileIO {
         const std::vector<WasteLocation>& locations,
         const std::unordered_map<std::string, std::vector<float>>& predictions,
         const std::string& filename)
+    {
+        std::vector<RouteSnapshot> snapshots;
+        snapshots.reserve(routes.size());
+        for (const auto& route : routes) {
+            snapshots.push_back(route->CreateSnapshot());
+        }
+
+        return ExportCompleteReport(snapshots, locations, predictions, filename);
+    }
+
+    bool ExportCompleteReport(
+        const std::vector<RouteSnapshot>& routes,
+        const std::vector<WasteLocation>& locations,
+        const std::unordered_map<std::string, std::vector<float>>& predictions,
+        const std::string& filename)
     {
         // Open file for writing
-        std::ofstream file(filename);
-        if (!file.is_open()) {
+        BufferedWriter file;
+        if (!file.Open(filename)) {
             std::cerr << "Failed to open file: " << filename << std::endl;
             return false;
         }
 
+        LocationNameTable names;
+
         // Get current time
         auto now = std::chrono::system_clock::now();
         auto time = std::chrono::system_clock::to_time_t(now);
 
         // Write main header
-        file << "=====================================================" << std::endl;
-        file << "Waste Management System - Complete Report" << std::endl;
-        file << "=====================================================" << std::endl;
+        file << "=====================================================\n";
+        file << "Waste Management System - Complete Report\n";
+        file << "=====================================================\n";
         file << "Date: " << std::ctime(&time);
-        file << "=====================================================" << std::endl << std::endl;
+        file << "=====================================================\n\n";
 
         // SECTION 1: Waste Locations and Levels
-        file << "SECTION 1: WASTE LOCATIONS AND LEVELS" << std::endl;
-        file << "=====================================================" << std::endl;
-        file << "Location\tWaste Level (%)" << std::endl;
-        file << "-----------------------------------------------------" << std::endl;
+        file << "SECTION 1: WASTE LOCATIONS AND LEVELS\n";
+        file << "=====================================================\n";
+        file << "Location\tWaste Level (%)\n";
+        file << "-----------------------------------------------------\n";
 
         for (const auto& location : locations) {
             file << location.GetLocationName() << "\t\t"
-                << location.GetWasteLevel() << std::endl;
+                << location.GetWasteLevel() << '\n';
         }
-        file << std::endl << std::endl;
+        file << "\n\n";
 
         // SECTION 2: Route Comparison Summary
-        file << "SECTION 2: ROUTE COMPARISON SUMMARY" << std::endl;
-        file << "=====================================================" << std::endl;
-        file << "Route Type\tWaste Threshold\tTotal Distance\tTotal Cost" << std::endl;
-        file << "-----------------------------------------------------" << std::endl;
+        file << "SECTION 2: ROUTE COMPARISON SUMMARY\n";
+        file << "=====================================================\n";
+        file << "Route Type\tWaste Threshold\tTotal Distance\tTotal Cost\n";
+        file << "-----------------------------------------------------\n";
 
         for (const auto& route : routes) {
-            file << route->GetRouteName() << "\t"
-                << route->GetWasteThreshold() << "%\t\t"
-                << route->GetTotalDistance() << " km\t\t"
-                << "RM " << route->GetTotalCost() << std::endl;
+            file << route.routeName << "\t"
+                << route.wasteThreshold << "%\t\t"
+                << route.totalDistance << " km\t\t"
+                << "RM " << route.totalCost << '\n';
         }
-        file << std::endl << std::endl;
+        file << "\n\n";
 
         // SECTION 3: Detailed Route Information
-        file << "SECTION 3: DETAILED ROUTE INFORMATION" << std::endl;
-        file << "=====================================================" << std::endl;
+        file << "SECTION 3: DETAILED ROUTE INFORMATION\n";
+        file << "=====================================================\n";
 
         for (const auto& route : routes) {
-            file << "-----------------------------------------------------" << std::endl;
-            file << "Route Type: " << route->GetRouteName() << std::endl;
-            file << "Waste Threshold: " << route->GetWasteThreshold() << "%" << std::endl;
-            file << "-----------------------------------------------------" << std::endl;
+            file << "-----------------------------------------------------\n";
+            file << "Route Type: " << route.routeName << '\n';
+            file << "Waste Threshold: " << route.wasteThreshold << "%\n";
+            file << "-----------------------------------------------------\n";
 
-            const std::vector<int>& routePath = route->GetFinalRoute();
-            const std::vector<float>& distances = route->GetIndividualDistances();
+            const std::vector<int>& routePath = route.finalRoute;
+            const std::vector<float>& distances = route.individualDistances;
 
             // Write route sequence
             file << "Route Sequence: ";
             for (size_t i = 0; i < routePath.size(); i++) {
-                file << WasteLocation::dict_Id_to_Name[routePath[i]];
-                if (i < routePath.size() - 1) {
+                file << names[routePath[i]];
+                if (i + 1 < routePath.size()) {
                     file << " -> ";
                 }
             }
-            file << std::endl << std::endl;
+            file << "\n\n";
 
             // Write segment distances
-            file << "Segment Distances:" << std::endl;
-            for (size_t i = 0; i < routePath.size() - 1; i++) {
-                file << WasteLocation::dict_Id_to_Name[routePath[i]] << " -> "
-                    << WasteLocation::dict_Id_to_Name[routePath[i + 1]] << ": "
-                    << distances[i] << " km" << std::endl;
+            file << "Segment Distances:\n";
+            for (size_t i = 0; i + 1 < routePath.size(); i++) {
+                file << names[routePath[i]] << " -> "
+                    << names[routePath[i + 1]] << ": "
+                    << distances[i] << " km\n";
             }
-            file << std::endl;
+            file << '\n';
 
             // Write cost summary
-            file << "Cost Summary:" << std::endl;
-            file << "Total Distance: " << route->GetTotalDistance() << " km" << std::endl;
-            file << "Time Taken: " << route->GetTimeTaken() << " min ("
-                << route->GetTimeTaken() / 60.0f << " hours)" << std::endl;
-            file << "Fuel Consumption: RM " << route->GetFuelConsumption() << std::endl;
-            file << "Driver's Wage: RM " << route->GetWage() << std::endl;
-            file << "Total Cost: RM " << route->GetTotalCost() << std::endl;
-            file << std::endl;
+            file << "Cost Summary:\n";
+            file << "Total Distance: " << route.totalDistance << " km\n";
+            file << "Time Taken: " << route.timeTaken << " min ("
+                << route.timeTaken / 60.0f << " hours)\n";
+            file << "Fuel Consumption: RM " << route.fuelConsumption << '\n';
+            file << "Driver's Wage: RM " << route.wage << '\n';
+            file << "Total Cost: RM " << route.totalCost << '\n';
+            file << '\n';
         }
 
         // SECTION 4: Waste Level Predictions (if available)
         if (!predictions.empty()) {
-            file << "SECTION 4: WASTE LEVEL PREDICTIONS" << std::endl;
-            file << "=====================================================" << std::endl;
+            file << "SECTION 4: WASTE LEVEL PREDICTIONS\n";
+            file << "=====================================================\n";
 
             // Find maximum days in predictions
             size_t maxDays = 0;
@@ -114,8 +402,8 @@ namespace FileIO {
             for (size_t i = 1; i < maxDays; i++) {
                 file << "\tDay " << i;
             }
-            file << std::endl;
-            file << "-----------------------------------------------------" << std::endl;
+            file << '\n';
+            file << "-----------------------------------------------------\n";
 
             // Write predictions for each location
             for (const auto& pair : predictions) {
@@ -128,16 +416,19 @@ namespace FileIO {
                         file << "\t";
                     }
                 }
-                file << std::endl;
+                file << '\n';
             }
-            file << std::endl;
+            file << '\n';
         }
 
-        file << "=====================================================" << std::endl;
-        file << "End of Report" << std::endl;
-        file << "=====================================================" << std::endl;
+        file << "=====================================================\n";
+        file << "End of Report\n";
+        file << "=====================================================\n";
 
-        file.close();
+        if (!file.Close()) {
+            std::cerr << "Failed to write file: " << filename << std::endl;
+            return false;
+        }
 
         std::cout << "Complete report saved to: " << filename << std::endl;
 
@@ -147,24 +438,26 @@ namespace FileIO {
     bool SaveRouteToFile(const Route* route, const std::string& filename)
     {
         // Open file for writing
-        std::ofstream file(filename);
-        if (!file.is_open()) {
+        BufferedWriter file;
+        if (!file.Open(filename)) {
             std::cerr << "Failed to open file: " << filename << std::endl;
             return false;
         }
 
+        LocationNameTable names;
+
         // Get current time
         auto now = std::chrono::system_clock::now();
         auto time = std::chrono::system_clock::to_time_t(now);
 
         // Write header
-        file << "=====================================================" << std::endl;
-        file << "Waste Management System - Route Report" << std::endl;
-        file << "=====================================================" << std::endl;
+        file << "=====================================================\n";
+        file << "Waste Management System - Route Report\n";
+        file << "=====================================================\n";
         file << "Date: " << std::ctime(&time);
-        file << "Route Type: " << route->GetRouteName() << std::endl;
-        file << "Waste Threshold: " << route->GetWasteThreshold() << "%" << std::endl;
-        file << "=====================================================" << std::endl;
+        file << "Route Type: " << route->GetRouteName() << '\n';
+        file << "Waste Threshold: " << route->GetWasteThreshold() << "%\n";
+        file << "=====================================================\n";
 
         // Write route data
         const std::vector<int>& routePath = route->GetFinalRoute();
@@ -173,41 +466,44 @@ namespace FileIO {
         // Write route sequence
         file << "Route Sequence: ";
         for (size_t i = 0; i < routePath.size(); i++) {
-            file << WasteLocation::dict_Id_to_Name[routePath[i]];
-            if (i < routePath.size() - 1) {
+            file << names[routePath[i]];
+            if (i + 1 < routePath.size()) {
                 file << " -> ";
             }
         }
-        file << std::endl << std::endl;
+        file << "\n\n";
 
         // Write segment distances
-        file << "Segment Distances:" << std::endl;
-        file << "-----------------------------------------------------" << std::endl;
-        file << "From\tTo\tDistance (km)" << std::endl;
-        file << "-----------------------------------------------------" << std::endl;
-
-        for (size_t i = 0; i < routePath.size() - 1; i++) {
-            file << WasteLocation::dict_Id_to_Name[routePath[i]] << "\t"
-                << WasteLocation::dict_Id_to_Name[routePath[i + 1]] << "\t"
-                << distances[i] << std::endl;
+        file << "Segment Distances:\n";
+        file << "-----------------------------------------------------\n";
+        file << "From\tTo\tDistance (km)\n";
+        file << "-----------------------------------------------------\n";
+
+        for (size_t i = 0; i + 1 < routePath.size(); i++) {
+            file << names[routePath[i]] << "\t"
+                << names[routePath[i + 1]] << "\t"
+                << distances[i] << '\n';
         }
-        file << std::endl;
+        file << '\n';
 
         // Write cost summary
-        file << "Cost Summary:" << std::endl;
-        file << "-----------------------------------------------------" << std::endl;
-        file << "Total Distance: " << route->GetTotalDistance() << " km" << std::endl;
+        file << "Cost Summary:\n";
+        file << "-----------------------------------------------------\n";
+        file << "Total Distance: " << route->GetTotalDistance() << " km\n";
         file << "Time Taken: " << route->GetTimeTaken() << " min ("
-            << route->GetTimeTaken() / 60.0f << " hours)" << std::endl;
-        file << "Fuel Consumption: RM " << route->GetFuelConsumption() << std::endl;
-        file << "Driver's Wage: RM " << route->GetWage() << std::endl;
-        file << "Total Cost: RM " << route->GetTotalCost() << std::endl;
+            << route->GetTimeTaken() / 60.0f << " hours)\n";
+        file << "Fuel Consumption: RM " << route->GetFuelConsumption() << '\n';
+        file << "Driver's Wage: RM " << route->GetWage() << '\n';
+        file << "Total Cost: RM " << route->GetTotalCost() << '\n';
 
-		file << std::endl;
+		file << '\n';
 		// Write waste levels
 
 
-        file.close();
+        if (!file.Close()) {
+            std::cerr << "Failed to write file: " << filename << std::endl;
+            return false;
+        }
 
         std::cout << "Route saved to: " << filename << std::endl;
 
@@ -217,8 +513,8 @@ namespace FileIO {
     bool SaveWasteLocationsToFile(const std::vector<WasteLocation>& locations, const std::string& filename)
     {
         // Open file for writing
-        std::ofstream file(filename);
-        if (!file.is_open()) {
+        BufferedWriter file;
+        if (!file.Open(filename)) {
             std::cerr << "Failed to open file: " << filename << std::endl;
             return false;
         }
@@ -228,22 +524,25 @@ namespace FileIO {
         auto time = std::chrono::system_clock::to_time_t(now);
 
         // Write header
-        file << "=====================================================" << std::endl;
-        file << "Waste Management System - Waste Levels" << std::endl;
-        file << "=====================================================" << std::endl;
+        file << "=====================================================\n";
+        file << "Waste Management System - Waste Levels\n";
+        file << "=====================================================\n";
         file << "Date: " << std::ctime(&time);
-        file << "=====================================================" << std::endl;
+        file << "=====================================================\n";
 
         // Write waste levels
-        file << "Location\tWaste Level (%)" << std::endl;
-        file << "-----------------------------------------------------" << std::endl;
+        file << "Location\tWaste Level (%)\n";
+        file << "-----------------------------------------------------\n";
 
         for (const auto& location : locations) {
             file << location.GetLocationName() << "\t\t"
-                << location.GetWasteLevel() << std::endl;
+                << location.GetWasteLevel() << '\n';
         }
 
-        file.close();
+        if (!file.Close()) {
+            std::cerr << "Failed to write file: " << filename << std::endl;
+            return false;
+        }
 
         std::cout << "Waste locations saved to: " << filename << std::endl;
 
@@ -298,57 +597,59 @@ namespace FileIO {
         const std::string& filename)
     {
         // Open file for writing
-        std::ofstream file(filename);
-        if (!file.is_open()) {
+        BufferedWriter file;
+        if (!file.Open(filename)) {
             std::cerr << "Failed to open file: " << filename << std::endl;
             return false;
         }
 
+        LocationNameTable names;
+
         // Get current time
         auto now = std::chrono::system_clock::now();
         auto time = std::chrono::system_clock::to_time_t(now);
 
         // Write header
-        file << "=====================================================" << std::endl;
-        file << "Waste Management System - Simulation Report" << std::endl;
-        file << "=====================================================" << std::endl;
+        file << "=====================================================\n";
+        file << "Waste Management System - Simulation Report\n";
+        file << "=====================================================\n";
         file << "Date: " << std::ctime(&time);
-        file << "=====================================================" << std::endl;
+        file << "=====================================================\n";
 
         // Write waste levels
-        file << "Waste Levels:" << std::endl;
-        file << "-----------------------------------------------------" << std::endl;
-        file << "Location\tWaste Level (%)" << std::endl;
-        file << "-----------------------------------------------------" << std::endl;
+        file << "Waste Levels:\n";
+        file << "-----------------------------------------------------\n";
+        file << "Location\tWaste Level (%)\n";
+        file << "-----------------------------------------------------\n";
 
         for (const auto& location : locations) {
             file << location.GetLocationName() << "\t\t"
-                << location.GetWasteLevel() << std::endl;
+                << location.GetWasteLevel() << '\n';
         }
 
-        file << std::endl;
+        file << '\n';
 
         // Write route comparison
-        file << "Route Comparison Summary:" << std::endl;
-        file << "-----------------------------------------------------" << std::endl;
-        file << "Route Type\tWaste Threshold\tTotal Distance\tTotal Cost" << std::endl;
-        file << "-----------------------------------------------------" << std::endl;
+        file << "Route Comparison Summary:\n";
+        file << "-----------------------------------------------------\n";
+        file << "Route Type\tWaste Threshold\tTotal Distance\tTotal Cost\n";
+        file << "-----------------------------------------------------\n";
 
         for (const auto& route : routes) {
             file << route->GetRouteName() << "\t"
                 << route->GetWasteThreshold() << "%\t\t"
                 << route->GetTotalDistance() << " km\t\t"
-                << "RM " << route->GetTotalCost() << std::endl;
+                << "RM " << route->GetTotalCost() << '\n';
         }
 
-        file << std::endl;
+        file << '\n';
 
         // Write detailed route information for each route
         for (const auto& route : routes) {
-            file << "=====================================================" << std::endl;
-            file << "Route Type: " << route->GetRouteName() << std::endl;
-            file << "Waste Threshold: " << route->GetWasteThreshold() << "%" << std::endl;
-            file << "=====================================================" << std::endl;
+            file << "=====================================================\n";
+            file << "Route Type: " << route->GetRouteName() << '\n';
+            file << "Waste Threshold: " << route->GetWasteThreshold() << "%\n";
+            file << "=====================================================\n";
 
             const std::vector<int>& routePath = route->GetFinalRoute();
             const std::vector<float>& distances = route->GetIndividualDistances();
@@ -356,38 +657,41 @@ namespace FileIO {
             // Write route sequence
             file << "Route Sequence: ";
             for (size_t i = 0; i < routePath.size(); i++) {
-                file << WasteLocation::dict_Id_to_Name[routePath[i]];
-                if (i < routePath.size() - 1) {
+                file << names[routePath[i]];
+                if (i + 1 < routePath.size()) {
                     file << " -> ";
                 }
             }
-            file << std::endl << std::endl;
+            file << "\n\n";
 
             // Write segment distances
-            file << "Segment Distances:" << std::endl;
-            file << "-----------------------------------------------------" << std::endl;
+            file << "Segment Distances:\n";
+            file << "-----------------------------------------------------\n";
 
-            for (size_t i = 0; i < routePath.size() - 1; i++) {
-                file << WasteLocation::dict_Id_to_Name[routePath[i]] << " -> "
-                    << WasteLocation::dict_Id_to_Name[routePath[i + 1]] << ": "
-                    << distances[i] << " km" << std::endl;
+            for (size_t i = 0; i + 1 < routePath.size(); i++) {
+                file << names[routePath[i]] << " -> "
+                    << names[routePath[i + 1]] << ": "
+                    << distances[i] << " km\n";
             }
-            file << std::endl;
+            file << '\n';
 
             // Write cost summary
-            file << "Cost Summary:" << std::endl;
-            file << "-----------------------------------------------------" << std::endl;
-            file << "Total Distance: " << route->GetTotalDistance() << " km" << std::endl;
+            file << "Cost Summary:\n";
+            file << "-----------------------------------------------------\n";
+            file << "Total Distance: " << route->GetTotalDistance() << " km\n";
             file << "Time Taken: " << route->GetTimeTaken() << " min ("
-                << route->GetTimeTaken() / 60.0f << " hours)" << std::endl;
-            file << "Fuel Consumption: RM " << route->GetFuelConsumption() << std::endl;
-            file << "Driver's Wage: RM " << route->GetWage() << std::endl;
-            file << "Total Cost: RM " << route->GetTotalCost() << std::endl;
+                << route->GetTimeTaken() / 60.0f << " hours)\n";
+            file << "Fuel Consumption: RM " << route->GetFuelConsumption() << '\n';
+            file << "Driver's Wage: RM " << route->GetWage() << '\n';
+            file << "Total Cost: RM " << route->GetTotalCost() << '\n';
 
-            file << std::endl;
+            file << '\n';
         }
 
-        file.close();
+        if (!file.Close()) {
+            std::cerr << "Failed to write file: " << filename << std::endl;
+            return false;
+        }
 
         std::cout << "Simulation report saved to: " << filename << std::endl;
 
@@ -397,23 +701,27 @@ namespace FileIO {
     bool ExportRouteAsCSV(const Route* route, const std::string& filename)
     {
         // Open file for writing
-        std::ofstream file(filename);
-        if (!file.is_open()) {
+        BufferedWriter file;
+        if (!file.Open(filename)) {
             std::cerr << "Failed to open file: " << filename << std::endl;
             return false;
         }
 
+        LocationNameTable names;
+
         // Write header
-        file << "RouteType,WasteThreshold,Location,Order,DistanceFromPrevious" << std::endl;
+        file << "RouteType,WasteThreshold,Location,Order,DistanceFromPrevious\n";
 
         // Write route data
         const std::vector<int>& routePath = route->GetFinalRoute();
         const std::vector<float>& distances = route->GetIndividualDistances();
+        const std::string routeName = route->GetRouteName();
+        const float wasteThreshold = route->GetWasteThreshold();
 
         for (size_t i = 0; i < routePath.size(); i++) {
-            file << route->GetRouteName() << ","
-                << route->GetWasteThreshold() << ","
-                << WasteLocation::dict_Id_to_Name[routePath[i]] << ","
+            file << routeName << ","
+                << wasteThreshold << ","
+                << names[routePath[i]] << ","
                 << i;
 
             if (i > 0) {
@@ -423,10 +731,13 @@ namespace FileIO {
                 file << ",0";
             }
 
-            file << std::endl;
+            file << '\n';
         }
 
-        file.close();
+        if (!file.Close()) {
+            std::cerr << "Failed to write file: " << filename << std::endl;
+            return false;
+        }
 
         std::cout << "Route exported as CSV to: " << filename << std::endl;
 
@@ -436,22 +747,25 @@ namespace FileIO {
     bool ExportWasteLevelsAsCSV(const std::vector<WasteLocation>& locations, const std::string& filename)
     {
         // Open file for writing
-        std::ofstream file(filename);
-        if (!file.is_open()) {
+        BufferedWriter file;
+        if (!file.Open(filename)) {
             std::cerr << "Failed to open file: " << filename << std::endl;
             return false;
         }
 
         // Write header
-        file << "Location,WasteLevel" << std::endl;
+        file << "Location,WasteLevel\n";
 
         // Write waste levels
         for (const auto& location : locations) {
             file << location.GetLocationName() << ","
-                << location.GetWasteLevel() << std::endl;
+                << location.GetWasteLevel() << '\n';
         }
 
-        file.close();
+        if (!file.Close()) {
+            std::cerr << "Failed to write file: " << filename << std::endl;
+            return false;
+        }
 
         std::cout << "Waste levels exported as CSV to: " << filename << std::endl;
 
@@ -462,8 +776,8 @@ namespace FileIO {
         const std::string& filename)
     {
         // Open file for writing
-        std::ofstream file(filename);
-        if (!file.is_open()) {
+        BufferedWriter file;
+        if (!file.Open(filename)) {
             std::cerr << "Failed to open file: " << filename << std::endl;
             return false;
         }
@@ -479,7 +793,7 @@ namespace FileIO {
         for (size_t i = 1; i < maxDays; i++) {
             file << ",Day" << i;
         }
-        file << std::endl;
+        file << '\n';
 
         // Write predictions
         for (const auto& pair : predictions) {
@@ -498,14 +812,388 @@ namespace FileIO {
                 file << ",";
             }
 
-            file << std::endl;
+            file << '\n';
         }
 
-        file.close();
+        if (!file.Close()) {
+            std::cerr << "Failed to write file: " << filename << std::endl;
+            return false;
+        }
 
         std::cout << "Predictions exported as CSV to: " << filename << std::endl;
 
         return true;
     }
 
-} // namespace FileIO
\ No newline at end of file
+    bool LoadLocationStoreFromCSV(const std::string& filename, LocationStore& store)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+
+        // Open file for reading
+        std::ifstream file(filename, std::ios::binary);
+        if (!file.is_open()) {
+            std::cerr << "Failed to open file: " << filename << std::endl;
+            return false;
+        }
+
+        store.Clear();
+
+        InventoryLayout layout;
+        bool hasLayout = false;
+        size_t skippedRows = 0;
+        std::string carry;  // Unfinished last line of the previous block
+
+        file.seekg(0, std::ios::end);
+        size_t fileSize = static_cast<size_t>(file.tellg());
+        file.seekg(0, std::ios::beg);
+
+        ThreadPool& pool = ThreadPool::Shared();
+        size_t blockSize = std::min(InventoryBlockSize, fileSize + 1);
+        std::vector<char> current(blockSize);
+        std::vector<char> next(blockSize);
+        std::vector<InventoryChunk> chunks;
+        size_t bytesParsed = 0;
+
+        auto readBlock = [&file](std::vector<char>& buffer) {
+            file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            return static_cast<size_t>(file.gcount());
+        };
+
+        // Take the layout from the first line, which is dropped if it is a header
+        auto applyLayout = [&]() {
+            if (!ReadInventoryLayout(carry, layout)) {
+                return true;
+            }
+            carry.clear();
+
+            for (int field : { FieldId, FieldX, FieldY }) {
+                if (std::find(layout.columnFields.begin(), layout.columnFields.end(), field) == layout.columnFields.end()) {
+                    std::cerr << "Inventory file needs id, x and y columns: " << filename << std::endl;
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        size_t currentSize = readBlock(current);
+        bool firstBlock = true;
+
+        while (currentSize > 0) {
+            // Read the next block while this one is parsed; the read gets its own thread
+            // so it is not queued behind the parse chunks on the pool
+            size_t nextSize = 0;
+            std::future<void> pendingRead = std::async(std::launch::async, [&]() { nextSize = readBlock(next); });
+
+            const char* begin = current.data();
+            const char* end = begin + currentSize;
+
+            // Skip a UTF-8 byte order mark
+            if (firstBlock && currentSize >= 3 && std::memcmp(begin, "\xEF\xBB\xBF", 3) == 0) {
+                begin += 3;
+            }
+            firstBlock = false;
+
+            // Only whole lines are parsed here; the rest is finished by the next block
+            const char* lastNewline = end;
+            while (lastNewline > begin && lastNewline[-1] != '\n') {
+                lastNewline--;
+            }
+
+            if (lastNewline == begin) {
+                carry.append(begin, end);
+            }
+            else {
+                const void* found = std::memchr(begin, '\n', static_cast<size_t>(lastNewline - begin));
+                const char* firstLineEnd = static_cast<const char*>(found);
+                carry.append(begin, firstLineEnd);
+
+                // The first line of the file decides the layout
+                const char* body = firstLineEnd + 1;
+                if (!hasLayout) {
+                    hasLayout = true;
+                    if (!applyLayout()) {
+                        pendingRead.get();
+                        return false;
+                    }
+                }
+
+                InventoryChunk joined;
+                ParseInventoryLines(carry.data(), carry.data() + carry.size(), layout, joined);
+                store.Append(joined.store);
+                skippedRows += joined.skippedRows;
+                carry.assign(lastNewline, end);
+
+                // Every chunk parses the lines that start inside its byte range
+                size_t bodySize = static_cast<size_t>(lastNewline - body);
+                chunks.resize(std::max(chunks.size(), ThreadPool::GetChunkCount(bodySize, InventoryBytesPerChunk)));
+                pool.ParallelFor(bodySize, InventoryBytesPerChunk, [&](size_t chunk, size_t chunkBegin, size_t chunkEnd) {
+                    const char* first = body + chunkBegin;
+                    const char* limit = body + chunkEnd;
+                    while (first < limit && first > body && first[-1] != '\n') {
+                        first++;
+                    }
+                    if (first >= limit) {
+                        return;
+                    }
+
+                    const char* last = limit;
+                    while (last < lastNewline && last[-1] != '\n') {
+                        last++;
+                    }
+
+                    ParseInventoryLines(first, last, layout, chunks[chunk]);
+                    });
+
+                // Merge in chunk order so the rows keep the file order
+                for (auto& chunk : chunks) {
+                    store.Append(chunk.store);
+                    skippedRows += chunk.skippedRows;
+                    chunk.store.Clear();
+                    chunk.skippedRows = 0;
+                }
+
+                // Size the columns for the whole file from the rows of the first block
+                if (bytesParsed == 0 && store.Size() > 0 && fileSize > currentSize) {
+                    double rowsPerByte = static_cast<double>(store.Size()) / static_cast<double>(currentSize);
+                    double bytesPerName = static_cast<double>(store.GetNameData().size()) / static_cast<double>(currentSize);
+                    store.Reserve(static_cast<size_t>(rowsPerByte * fileSize * 1.05),
+                        static_cast<size_t>(bytesPerName * fileSize * 1.05));
+                }
+            }
+            bytesParsed += currentSize;
+
+            pendingRead.get();
+            std::swap(current, next);
+            currentSize = nextSize;
+        }
+
+        // A last line without a newline
+        if (!carry.empty()) {
+            if (!hasLayout) {
+                hasLayout = true;
+                if (!applyLayout()) {
+                    return false;
+                }
+            }
+
+            InventoryChunk last;
+            ParseInventoryLines(carry.data(), carry.data() + carry.size(), layout, last);
+            store.Append(last.store);
+            skippedRows += last.skippedRows;
+        }
+
+        file.close();
+
+        if (skippedRows > 0) {
+            std::cerr << "Skipped " << skippedRows << " malformed rows in: " << filename << std::endl;
+        }
+
+        double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        std::cout << "Loaded " << store.Size() << " bins from: " << filename
+            << " in " << milliseconds << " ms" << std::endl;
+
+        return true;
+    }
+
+    bool SaveLocationSnapshot(const LocationStore& store, const std::vector<int>& clusterLabels,
+        const std::string& filename)
+    {
+        if (!clusterLabels.empty() && clusterLabels.size() != store.Size()) {
+            std::cerr << "Cannot save " << clusterLabels.size() << " cluster labels for "
+                << store.Size() << " bins" << std::endl;
+            return false;
+        }
+
+        // Open file for writing
+        std::ofstream file(filename, std::ios::binary);
+        if (!file.is_open()) {
+            std::cerr << "Failed to open file: " << filename << std::endl;
+            return false;
+        }
+
+        LocationSnapshotHeader header = {};
+        std::memcpy(header.magic, LocationSnapshotMagic, sizeof(LocationSnapshotMagic));
+        header.version = LocationSnapshotVersion;
+        header.rowCount = store.Size();
+        header.nameBytes = store.GetNameData().size();
+        if (!clusterLabels.empty()) {
+            header.flags |= LocationSnapshotFlagLabels;
+            header.numClusters = static_cast<uint32_t>(*std::max_element(clusterLabels.begin(), clusterLabels.end()) + 1);
+        }
+
+        const void* columns[NumSnapshotColumns] = {
+            store.GetIds().data(),
+            store.GetX().data(),
+            store.GetY().data(),
+            store.GetWasteLevels().data(),
+            store.GetCapacities().data(),
+            clusterLabels.data(),
+            store.GetNameOffsets().data(),
+            store.GetNameData().data()
+        };
+
+        // Every column starts on an alignment boundary
+        uint64_t offset = sizeof(header);
+        for (int column = 0; column < NumSnapshotColumns; column++) {
+            offset = (offset + LocationSnapshotAlignment - 1) / LocationSnapshotAlignment * LocationSnapshotAlignment;
+            header.columnOffsets[column] = offset;
+            offset += GetSnapshotColumnBytes(header, static_cast<SnapshotColumn>(column));
+        }
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        uint64_t written = sizeof(header);
+        const char padding[LocationSnapshotAlignment] = {};
+        for (int column = 0; column < NumSnapshotColumns; column++) {
+            file.write(padding, static_cast<std::streamsize>(header.columnOffsets[column] - written));
+            uint64_t bytes = GetSnapshotColumnBytes(header, static_cast<SnapshotColumn>(column));
+            file.write(static_cast<const char*>(columns[column]), static_cast<std::streamsize>(bytes));
+            written = header.columnOffsets[column] + bytes;
+        }
+
+        if (!file) {
+            std::cerr << "Failed to write snapshot to: " << filename << std::endl;
+            return false;
+        }
+
+        file.close();
+
+        std::cout << "Snapshot of " << store.Size() << " bins saved to: " << filename << std::endl;
+
+        return true;
+    }
+
+    bool ExportRoutesAsArrow(const std::vector<RouteSnapshot>& routes, const std::string& filename)
+    {
+        LocationNameTable names;
+        std::vector<std::string> locationNames = names.GetDictionary();
+
+        // Route names are few, so they get their own dictionary
+        std::vector<std::string> routeNames;
+        std::vector<int32_t> routeIndices;
+        for (const auto& route : routes) {
+            auto it = std::find(routeNames.begin(), routeNames.end(), route.routeName);
+            routeIndices.push_back(static_cast<int32_t>(it - routeNames.begin()));
+            if (it == routeNames.end()) {
+                routeNames.push_back(route.routeName);
+            }
+
+            for (int id : route.finalRoute) {
+                if (id < 0 || static_cast<size_t>(id) >= locationNames.size()) {
+                    std::cerr << "Unknown location ID " << id << " in route: " << route.routeName << std::endl;
+                    return false;
+                }
+            }
+        }
+
+        // Same columns as ExportRouteAsCSV; the location column stores location IDs
+        ArrowFileWriter file;
+        file.AddDictionaryColumn("RouteType", routeNames);
+        file.AddColumn("WasteThreshold", ArrowFileWriter::ColumnType::Float32);
+        file.AddDictionaryColumn("Location", locationNames);
+        file.AddColumn("Order", ArrowFileWriter::ColumnType::Int32);
+        file.AddColumn("DistanceFromPrevious", ArrowFileWriter::ColumnType::Float32);
+
+        if (!file.Open(filename)) {
+            std::cerr << "Failed to open file: " << filename << std::endl;
+            return false;
+        }
+
+        std::vector<int32_t> routeTypes, locations, orders;
+        std::vector<float> thresholds, distances;
+        auto writeBatch = [&]() {
+            file.WriteBatch(orders.size(),
+                { routeTypes.data(), thresholds.data(), locations.data(), orders.data(), distances.data() });
+            routeTypes.clear();
+            thresholds.clear();
+            locations.clear();
+            orders.clear();
+            distances.clear();
+        };
+
+        for (size_t r = 0; r < routes.size(); r++) {
+            const RouteSnapshot& route = routes[r];
+            for (size_t i = 0; i < route.finalRoute.size(); i++) {
+                routeTypes.push_back(routeIndices[r]);
+                thresholds.push_back(route.wasteThreshold);
+                locations.push_back(route.finalRoute[i]);
+                orders.push_back(static_cast<int32_t>(i));
+                distances.push_back(i > 0 ? route.individualDistances[i - 1] : 0.0f);
+
+                if (orders.size() == ArrowRowsPerBatch) {
+                    writeBatch();
+                }
+            }
+        }
+        if (!orders.empty()) {
+            writeBatch();
+        }
+
+        if (!file.Close()) {
+            std::cerr << "Failed to write file: " << filename << std::endl;
+            return false;
+        }
+
+        std::cout << "Routes exported as Arrow to: " << filename << std::endl;
+
+        return true;
+    }
+
+    bool ExportPredictionsAsArrow(const std::unordered_map<std::string, std::vector<float>>& predictions,
+        const std::string& filename)
+    {
+        // Sorted location names form the dictionary, so exports are reproducible
+        std::vector<std::string> locationNames;
+        for (const auto& pair : predictions) {
+            if (pair.first != "Station") {
+                locationNames.push_back(pair.first);
+            }
+        }
+        std::sort(locationNames.begin(), locationNames.end());
+
+        // One row per location and day; day 0 is the current waste level
+        ArrowFileWriter file;
+        file.AddDictionaryColumn("Location", locationNames);
+        file.AddColumn("Day", ArrowFileWriter::ColumnType::Int32);
+        file.AddColumn("WasteLevel", ArrowFileWriter::ColumnType::Float32);
+
+        if (!file.Open(filename)) {
+            std::cerr << "Failed to open file: " << filename << std::endl;
+            return false;
+        }
+
+        std::vector<int32_t> locations, days;
+        std::vector<float> wasteLevels;
+        auto writeBatch = [&]() {
+            file.WriteBatch(days.size(), { locations.data(), days.data(), wasteLevels.data() });
+            locations.clear();
+            days.clear();
+            wasteLevels.clear();
+        };
+
+        for (size_t l = 0; l < locationNames.size(); l++) {
+            const std::vector<float>& levels = predictions.at(locationNames[l]);
+            for (size_t day = 0; day < levels.size(); day++) {
+                locations.push_back(static_cast<int32_t>(l));
+                days.push_back(static_cast<int32_t>(day));
+                wasteLevels.push_back(levels[day]);
+
+                if (days.size() == ArrowRowsPerBatch) {
+                    writeBatch();
+                }
+            }
+        }
+        if (!days.empty()) {
+            writeBatch();
+        }
+
+        if (!file.Close()) {
+            std::cerr << "Failed to write file: " << filename << std::endl;
+            return false;
+        }
+
+        std::cout << "Predictions exported as Arrow to: " << filename << std::endl;
+
+        return true;
+    }
+
+} // namespace FileIO
@@ -4,6 +4,7 @@
 
 #include "../Core/Route.h"
 #include "../Core/WasteLocation.h"
+#include "../Core/LocationStore.h"
 #include <string>
 #include <vector>
 #include <fstream>
@@ -20,6 +21,23 @@ namespace FileIO {
         const std::unordered_map<std::string, std::vector<float>>& predictions,
         const std::string& filename);
 
+    /**
+     * @brief Export the complete report from route snapshots
+     *
+     * Only reads its arguments, so it can run on a worker thread while the
+     * routes themselves are recalculated.
+     * @param routes Snapshots of the routes to compare
+     * @param locations Vector of waste locations
+     * @param predictions Map of location names to predicted waste levels
+     * @param filename Output filename
+     * @return True if successful, false otherwise
+     */
+    bool ExportCompleteReport(
+        const std::vector<RouteSnapshot>& routes,
+        const std::vector<WasteLocation>& locations,
+        const std::unordered_map<std::string, std::vector<float>>& predictions,
+        const std::string& filename);
+
     /**
      * @brief Save route information to a file
      * @param route Route to save
@@ -44,6 +62,34 @@ namespace FileIO {
      */
     bool LoadWasteLocationsFromFile(const std::string& filename, std::vector<WasteLocation>& locations);
 
+    /**
+     * @brief Load a bin inventory from a CSV or TSV file
+     *
+     * The file is read in large blocks, and each block is parsed in parallel
+     * while the next one is being read. The delimiter (comma or tab) is detected
+     * from the first line. If the first line is a header, columns are matched by
+     * name (id, name, x, y, waste_level, capacity), otherwise that order is assumed.
+     * The id, x and y columns are required; a missing name, waste level or
+     * capacity is left empty or 0. Rows that cannot be parsed are skipped and counted.
+     * @param filename Input filename
+     * @param[out] store Store that receives the bins, in file order
+     * @return True if successful, false otherwise
+     */
+    bool LoadLocationStoreFromCSV(const std::string& filename, LocationStore& store);
+
+    /**
+     * @brief Save a bin inventory and its cluster labels as a binary snapshot
+     *
+     * The snapshot is a header followed by one 64-byte aligned array per column,
+     * so LocationSnapshot can use the columns in place from a memory mapping.
+     * @param store Bins to save
+     * @param clusterLabels Cluster per bin, or empty to save no labels
+     * @param filename Output filename
+     * @return True if successful, false otherwise
+     */
+    bool SaveLocationSnapshot(const LocationStore& store, const std::vector<int>& clusterLabels,
+        const std::string& filename);
+
     /**
      * @brief Save simulation report to a file
      * @param routes Vector of routes to compare
@@ -79,4 +125,30 @@ namespace FileIO {
      */
     bool ExportPredictionsAsCSV(const std::unordered_map<std::string, std::vector<float>>& predictions,
         const std::string& filename);
+
+    /**
+     * @brief Export routes as an Arrow IPC file
+     *
+     * Holds the same columns as ExportRouteAsCSV for every route, as typed
+     * columns that dataframe libraries load without parsing. Route and
+     * location names are dictionary encoded.
+     *
+     * @param routes Route snapshots to export
+     * @param filename Output filename
+     * @return True if successful, false otherwise
+     */
+    bool ExportRoutesAsArrow(const std::vector<RouteSnapshot>& routes, const std::string& filename);
+
+    /**
+     * @brief Export AI prediction data as an Arrow IPC file
+     *
+     * Writes one row per location and day (day 0 is the current waste
+     * level) with dictionary encoded location names.
+     *
+     * @param predictions Map of location names to predicted waste levels
+     * @param filename Output filename
+     * @return True if successful, false otherwise
+     */
+    bool ExportPredictionsAsArrow(const std::unordered_map<std::string, std::vector<float>>& predictions,
+        const std::string& filename);
 }
\ No newline at end of file
@@ -0,0 +1,103 @@
+// LocationSnapshot.cpp
+// Implementation of the memory-mapped location snapshot
+#include "pch.h"
+#include "LocationSnapshot.h"
+#include <cstring>
+
+uint64_t GetSnapshotColumnBytes(const LocationSnapshotHeader& header, SnapshotColumn column)
+{
+    switch (column) {
+    case SnapshotIds:
+    case SnapshotX:
+    case SnapshotY:
+    case SnapshotWasteLevels:
+    case SnapshotCapacities:
+        return header.rowCount * 4;
+    case SnapshotLabels:
+        return (header.flags & LocationSnapshotFlagLabels) ? header.rowCount * 4 : 0;
+    case SnapshotNameOffsets:
+        return (header.rowCount + 1) * sizeof(uint64_t);
+    case SnapshotNames:
+        return header.nameBytes;
+    default:
+        return 0;
+    }
+}
+
+LocationSnapshot::LocationSnapshot()
+    : m_header()
+{
+    std::fill(m_columns, m_columns + NumSnapshotColumns, nullptr);
+}
+
+bool LocationSnapshot::Open(const std::string& filename)
+{
+    Close();
+
+    if (!m_file.Open(filename)) {
+        std::cerr << "Failed to open file: " << filename << std::endl;
+        return false;
+    }
+
+    const size_t size = m_file.GetSize();
+    if (size < sizeof(LocationSnapshotHeader) ||
+        std::memcmp(m_file.GetData(), LocationSnapshotMagic, sizeof(LocationSnapshotMagic)) != 0) {
+        std::cerr << "Not a location snapshot: " << filename << std::endl;
+        Close();
+        return false;
+    }
+
+    std::memcpy(&m_header, m_file.GetData(), sizeof(m_header));
+    if (m_header.version != LocationSnapshotVersion) {
+        std::cerr << "Unsupported snapshot version " << m_header.version << " in: " << filename << std::endl;
+        Close();
+        return false;
+    }
+
+    // Every column has to be aligned and lie inside the file
+    bool valid = m_header.rowCount <= size;
+    for (int column = 0; column < NumSnapshotColumns && valid; column++) {
+        uint64_t offset = m_header.columnOffsets[column];
+        uint64_t bytes = GetSnapshotColumnBytes(m_header, static_cast<SnapshotColumn>(column));
+        valid = offset % LocationSnapshotAlignment == 0 && offset >= sizeof(LocationSnapshotHeader) &&
+            offset <= size && bytes <= size - offset;
+        m_columns[column] = m_file.GetData() + offset;
+    }
+
+    // The name offsets must end at the end of the name data
+    if (valid) {
+        uint64_t lastOffset;
+        std::memcpy(&lastOffset, m_columns[SnapshotNameOffsets] + m_header.rowCount * sizeof(uint64_t), sizeof(lastOffset));
+        valid = lastOffset == m_header.nameBytes;
+    }
+
+    // Every cluster has at least one row; the labels are range checked when they are restored
+    if (valid && (m_header.flags & LocationSnapshotFlagLabels) != 0) {
+        valid = m_header.numClusters <= m_header.rowCount;
+    }
+
+    if (!valid) {
+        std::cerr << "Snapshot file is corrupt: " << filename << std::endl;
+        Close();
+        return false;
+    }
+
+    std::cout << "Mapped snapshot of " << m_header.rowCount << " bins from: " << filename << std::endl;
+    return true;
+}
+
+void LocationSnapshot::Close()
+{
+    m_file.Close();
+    m_header = LocationSnapshotHeader();
+    std::fill(m_columns, m_columns + NumSnapshotColumns, nullptr);
+}
+
+std::string_view LocationSnapshot::GetName(size_t index) const
+{
+    const uint64_t* offsets = reinterpret_cast<const uint64_t*>(m_columns[SnapshotNameOffsets]);
+    uint64_t begin = std::min(offsets[index], m_header.nameBytes);
+    uint64_t end = std::min(std::max(offsets[index + 1], begin), m_header.nameBytes);
+    return std::string_view(reinterpret_cast<const char*>(m_columns[SnapshotNames]) + begin,
+        static_cast<size_t>(end - begin));
+}
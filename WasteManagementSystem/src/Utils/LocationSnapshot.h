@@ -0,0 +1,153 @@
+// LocationSnapshot.h
+// Memory-mapped binary snapshot of a bin inventory and its cluster labels
+#pragma once
+
+#include "MappedFile.h"
+#include <string>
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+
+// Snapshot file layout (little-endian):
+//   LocationSnapshotHeader
+//   one array per column, each starting at a multiple of LocationSnapshotAlignment
+// Names are stored as rowCount + 1 offsets into one character array.
+const char LocationSnapshotMagic[4] = { 'W', 'M', 'L', 'S' };
+const uint16_t LocationSnapshotVersion = 1;
+const uint16_t LocationSnapshotFlagLabels = 1;
+const size_t LocationSnapshotAlignment = 64;
+
+/**
+ * @brief Columns of a location snapshot, in file order
+ */
+enum SnapshotColumn {
+    SnapshotIds,            // int32 per row
+    SnapshotX,              // float per row
+    SnapshotY,              // float per row
+    SnapshotWasteLevels,    // float per row
+    SnapshotCapacities,     // float per row
+    SnapshotLabels,         // int32 per row, only with LocationSnapshotFlagLabels
+    SnapshotNameOffsets,    // uint64 per row plus one
+    SnapshotNames,          // nameBytes characters
+    NumSnapshotColumns
+};
+
+struct LocationSnapshotHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t flags;
+    uint64_t rowCount;
+    uint64_t nameBytes;
+    uint32_t numClusters;
+    uint32_t reserved;
+    uint64_t columnOffsets[NumSnapshotColumns];
+    uint64_t padding[4];
+};
+static_assert(sizeof(LocationSnapshotHeader) == 128, "Snapshot header must have a fixed layout");
+
+/**
+ * @brief Size of a column for the row count, name length and flags of a header
+ * @param header Snapshot header
+ * @param column Column
+ * @return Column size in bytes
+ */
+uint64_t GetSnapshotColumnBytes(const LocationSnapshotHeader& header, SnapshotColumn column);
+
+/**
+ * @brief Read-only view of a column array
+ */
+template <typename T>
+class ColumnView {
+private:
+    const T* m_data;
+    size_t m_size;
+
+public:
+    ColumnView() : m_data(nullptr), m_size(0) {}
+    ColumnView(const T* data, size_t size) : m_data(data), m_size(size) {}
+
+    const T* data() const { return m_data; }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    const T& operator[](size_t index) const { return m_data[index]; }
+    const T* begin() const { return m_data; }
+    const T* end() const { return m_data + m_size; }
+};
+
+/**
+ * @brief Bin inventory snapshot read in place from a mapped file
+ *
+ * Opening only checks the header and column bounds; the columns are used
+ * directly from the mapping and paged in when they are first read, so the
+ * time to open does not grow with the number of bins.
+ */
+class LocationSnapshot {
+private:
+    /* Private members in LocationSnapshot class */
+    MappedFile m_file;                  // Mapping of the snapshot file
+    LocationSnapshotHeader m_header;    // Copy of the file header
+    const uint8_t* m_columns[NumSnapshotColumns];  // Start of every column in the mapping
+
+    template <typename T>
+    ColumnView<T> GetColumn(SnapshotColumn column, size_t count) const
+    {
+        return ColumnView<T>(reinterpret_cast<const T*>(m_columns[column]), count);
+    }
+
+public:
+    /**
+     * @brief Constructor for LocationSnapshot
+     */
+    LocationSnapshot();
+
+    /**
+     * @brief Map a snapshot file and check its layout
+     * @param filename Snapshot file
+     * @return True if successful, false otherwise
+     */
+    bool Open(const std::string& filename);
+
+    /**
+     * @brief Unmap the snapshot
+     */
+    void Close();
+
+    /**
+     * @brief Check whether a snapshot is open
+     * @return True if a snapshot is mapped
+     */
+    bool IsOpen() const { return m_file.IsOpen(); }
+
+    /**
+     * @brief Get the number of bins
+     * @return Number of rows, 0 if no snapshot is open
+     */
+    size_t Size() const { return IsOpen() ? static_cast<size_t>(m_header.rowCount) : 0; }
+
+    /**
+     * @brief Check whether the snapshot has cluster labels
+     * @return True if a label column was saved
+     */
+    bool HasLabels() const { return IsOpen() && (m_header.flags & LocationSnapshotFlagLabels) != 0; }
+
+    /**
+     * @brief Get the number of clusters the labels refer to
+     * @return Number of clusters, 0 without labels
+     */
+    int GetNumClusters() const { return HasLabels() ? static_cast<int>(m_header.numClusters) : 0; }
+
+    /**
+     * @brief Get the name of a bin
+     * @param index Row index
+     * @return View of the name in the mapping
+     */
+    std::string_view GetName(size_t index) const;
+
+    // Column views, valid until the snapshot is closed
+    ColumnView<int32_t> GetIds() const { return GetColumn<int32_t>(SnapshotIds, Size()); }
+    ColumnView<float> GetX() const { return GetColumn<float>(SnapshotX, Size()); }
+    ColumnView<float> GetY() const { return GetColumn<float>(SnapshotY, Size()); }
+    ColumnView<float> GetWasteLevels() const { return GetColumn<float>(SnapshotWasteLevels, Size()); }
+    ColumnView<float> GetCapacities() const { return GetColumn<float>(SnapshotCapacities, Size()); }
+    ColumnView<int32_t> GetLabels() const { return GetColumn<int32_t>(SnapshotLabels, HasLabels() ? Size() : 0); }
+};
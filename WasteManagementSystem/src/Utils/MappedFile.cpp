@@ -0,0 +1,128 @@
+// MappedFile.cpp
+// Implementation of the read-only memory-mapped file
+#include "pch.h"
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+    : m_data(nullptr),
+    m_size(0),
+    m_isOpen(false),
+#ifdef _WIN32
+    m_fileHandle(INVALID_HANDLE_VALUE),
+    m_mappingHandle(nullptr)
+#else
+    m_fileDescriptor(-1)
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+bool MappedFile::Open(const std::string& filename)
+{
+    Close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        return false;
+    }
+
+    m_fileHandle = file;
+    m_size = static_cast<size_t>(fileSize.QuadPart);
+
+    // Windows cannot map empty files, so leave the view empty
+    if (m_size > 0) {
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping == nullptr) {
+            Close();
+            return false;
+        }
+        m_mappingHandle = mapping;
+
+        m_data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        if (m_data == nullptr) {
+            Close();
+            return false;
+        }
+    }
+#else
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0) {
+        close(fd);
+        return false;
+    }
+
+    m_fileDescriptor = fd;
+    m_size = static_cast<size_t>(fileStat.st_size);
+
+    // mmap rejects zero-length mappings, so leave the view empty
+    if (m_size > 0) {
+        void* view = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (view == MAP_FAILED) {
+            Close();
+            return false;
+        }
+        m_data = static_cast<const uint8_t*>(view);
+    }
+#endif
+
+    m_isOpen = true;
+    return true;
+}
+
+void MappedFile::Close()
+{
+#ifdef _WIN32
+    if (m_data != nullptr) {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mappingHandle != nullptr) {
+        CloseHandle(m_mappingHandle);
+        m_mappingHandle = nullptr;
+    }
+    if (m_fileHandle != INVALID_HANDLE_VALUE) {
+        CloseHandle(m_fileHandle);
+        m_fileHandle = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (m_data != nullptr) {
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+    }
+    if (m_fileDescriptor >= 0) {
+        close(m_fileDescriptor);
+        m_fileDescriptor = -1;
+    }
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+    m_isOpen = false;
+}
@@ -0,0 +1,72 @@
+// MappedFile.h
+// Read-only memory-mapped view of a file
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Maps a whole file read-only into memory
+ *
+ * The operating system pages the file in on demand, so opening a large file
+ * is cheap and readers can use the data in place without copying it.
+ */
+class MappedFile {
+private:
+    /* Private members in MappedFile class */
+    const uint8_t* m_data;   // Start of the mapped view (nullptr if not open or empty)
+    size_t m_size;           // Size of the file in bytes
+    bool m_isOpen;           // True while a file is mapped
+
+#ifdef _WIN32
+    void* m_fileHandle;      // Windows file handle
+    void* m_mappingHandle;   // Windows file mapping handle
+#else
+    int m_fileDescriptor;    // POSIX file descriptor
+#endif
+
+public:
+    /**
+     * @brief Constructor for MappedFile
+     */
+    MappedFile();
+
+    /**
+     * @brief Destructor, unmaps the file
+     */
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Map a file into memory
+     * @param filename File to map
+     * @return True if successful, false otherwise
+     */
+    bool Open(const std::string& filename);
+
+    /**
+     * @brief Unmap the file
+     */
+    void Close();
+
+    /**
+     * @brief Check whether a file is mapped
+     * @return True if a file is mapped
+     */
+    bool IsOpen() const { return m_isOpen; }
+
+    /**
+     * @brief Get the mapped bytes
+     * @return Pointer to the file contents (nullptr for empty files)
+     */
+    const uint8_t* GetData() const { return m_data; }
+
+    /**
+     * @brief Get the file size
+     * @return Size of the mapped file in bytes
+     */
+    size_t GetSize() const { return m_size; }
+};
@@ -0,0 +1,166 @@
+// ThreadPool.cpp
+// Implementation of the shared worker thread pool
+#include "pch.h"
+#include "ThreadPool.h"
+
+namespace {
+    // State shared between the caller and the helpers of one ParallelFor
+    struct ParallelJob {
+        std::atomic<size_t> nextChunk{ 0 };
+        std::atomic<size_t> doneChunks{ 0 };
+        size_t numChunks = 0;
+        size_t count = 0;
+        size_t grainSize = 1;
+        const std::function<void(size_t, size_t, size_t)>* body = nullptr;
+
+        std::mutex mutex;
+        std::condition_variable finished;
+        std::exception_ptr error;
+    };
+
+    // Claim and run chunks until none are left
+    void RunChunks(ParallelJob& job)
+    {
+        while (true) {
+            size_t chunk = job.nextChunk.fetch_add(1);
+            if (chunk >= job.numChunks) {
+                return;
+            }
+
+            size_t begin = chunk * job.grainSize;
+            size_t end = std::min(job.count, begin + job.grainSize);
+
+            try {
+                (*job.body)(chunk, begin, end);
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(job.mutex);
+                if (!job.error) {
+                    job.error = std::current_exception();
+                }
+            }
+
+            // The last finished chunk wakes up the caller
+            if (job.doneChunks.fetch_add(1) + 1 == job.numChunks) {
+                std::lock_guard<std::mutex> lock(job.mutex);
+                job.finished.notify_all();
+            }
+        }
+    }
+}
+
+ThreadPool::ThreadPool(size_t numThreads)
+    : m_stopping(false)
+{
+    if (numThreads == 0) {
+        size_t hardwareThreads = std::thread::hardware_concurrency();
+        numThreads = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+    }
+
+    for (size_t i = 0; i < numThreads; i++) {
+        m_workers.emplace_back(&ThreadPool::WorkerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_condition.notify_all();
+
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+ThreadPool& ThreadPool::Shared()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+size_t ThreadPool::GetConcurrency() const
+{
+    return m_workers.size() + 1;
+}
+
+void ThreadPool::WorkerLoop()
+{
+    while (true) {
+        std::function<void()> task;
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this] { return m_stopping || !m_tasks.empty(); });
+
+            if (m_tasks.empty()) {
+                return; // Stopping and nothing left to do
+            }
+
+            task = std::move(m_tasks.front());
+            m_tasks.pop();
+        }
+
+        task();
+    }
+}
+
+void ThreadPool::Post(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push(std::move(task));
+    }
+    m_condition.notify_one();
+}
+
+std::future<void> ThreadPool::Enqueue(std::function<void()> task)
+{
+    auto packaged = std::make_shared<std::packaged_task<void()>>(std::move(task));
+    std::future<void> result = packaged->get_future();
+
+    Post([packaged]() { (*packaged)(); });
+
+    return result;
+}
+
+size_t ThreadPool::GetChunkCount(size_t count, size_t grainSize)
+{
+    grainSize = std::max<size_t>(1, grainSize);
+    return (count + grainSize - 1) / grainSize;
+}
+
+void ThreadPool::ParallelFor(size_t count, size_t grainSize,
+    const std::function<void(size_t chunk, size_t begin, size_t end)>& body)
+{
+    if (count == 0) {
+        return;
+    }
+
+    auto job = std::make_shared<ParallelJob>();
+    job->count = count;
+    job->grainSize = std::max<size_t>(1, grainSize);
+    job->numChunks = GetChunkCount(count, job->grainSize);
+    job->body = &body;
+
+    // Helpers that start after every chunk has been claimed return immediately,
+    // so they never touch body after this function has returned
+    size_t helpers = std::min(m_workers.size(), job->numChunks - 1);
+    for (size_t i = 0; i < helpers; i++) {
+        Post([job]() { RunChunks(*job); });
+    }
+
+    // The caller works on chunks too
+    RunChunks(*job);
+
+    {
+        std::unique_lock<std::mutex> lock(job->mutex);
+        job->finished.wait(lock, [&job] { return job->doneChunks.load() == job->numChunks; });
+    }
+
+    if (job->error) {
+        std::rethrow_exception(job->error);
+    }
+}
@@ -0,0 +1,88 @@
+// ThreadPool.h
+// Fixed-size worker thread pool shared by the parallel AI and planning components
+#pragma once
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <atomic>
+
+/**
+ * @brief Pool of worker threads for background tasks and data-parallel loops
+ *
+ * ParallelFor splits an index range into fixed-size chunks. Chunk boundaries only
+ * depend on the range and grain size, never on the number of threads, so callers
+ * can keep one partial result per chunk and merge them in chunk order to get
+ * results that are identical for any thread count. The calling thread processes
+ * chunks as well, so nested ParallelFor calls cannot deadlock.
+ */
+class ThreadPool {
+private:
+    /* Private members in ThreadPool class */
+    std::vector<std::thread> m_workers;             // Worker threads
+    std::queue<std::function<void()>> m_tasks;      // Pending tasks
+    std::mutex m_mutex;                             // Guards the task queue
+    std::condition_variable m_condition;            // Signals new tasks or shutdown
+    bool m_stopping;                                // Set when the pool is destroyed
+
+    // Worker thread main loop
+    void WorkerLoop();
+
+    // Push a task to the queue without creating a future
+    void Post(std::function<void()> task);
+
+public:
+    /**
+     * @brief Constructor for ThreadPool
+     * @param numThreads Number of worker threads (0 = one less than the hardware threads)
+     */
+    explicit ThreadPool(size_t numThreads = 0);
+
+    /**
+     * @brief Destructor, finishes queued tasks and joins all workers
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Get the process-wide shared pool
+     * @return Shared thread pool instance
+     */
+    static ThreadPool& Shared();
+
+    /**
+     * @brief Get the number of threads that take part in a ParallelFor
+     * @return Worker threads plus the calling thread
+     */
+    size_t GetConcurrency() const;
+
+    /**
+     * @brief Run a task asynchronously on a worker thread
+     * @param task Task to run
+     * @return Future that becomes ready when the task has finished
+     */
+    std::future<void> Enqueue(std::function<void()> task);
+
+    /**
+     * @brief Run body over [0, count) in chunks of grainSize, in parallel
+     * @param count Number of indices
+     * @param grainSize Number of indices per chunk
+     * @param body Called as body(chunkIndex, begin, end) once per chunk
+     */
+    void ParallelFor(size_t count, size_t grainSize,
+        const std::function<void(size_t chunk, size_t begin, size_t end)>& body);
+
+    /**
+     * @brief Number of chunks ParallelFor will use for a range
+     * @param count Number of indices
+     * @param grainSize Number of indices per chunk
+     * @return Number of chunks
+     */
+    static size_t GetChunkCount(size_t count, size_t grainSize);
+};